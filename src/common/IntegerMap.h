@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_INTEGER_MAP_H
+#define LOVE_INTEGER_MAP_H
+
+#include "int.h"
+
+#include <vector>
+#include <utility>
+
+namespace love
+{
+
+/**
+ * A map from unsigned integer keys to values, stored in flat arrays with open
+ * addressing (linear probing) rather than in per-node allocations.
+ *
+ * Keys below DIRECT skip hashing entirely and index an array directly, which
+ * suits small dense key ranges that are looked up far more often than the
+ * rest (e.g. ASCII / Latin-1 codepoints).
+ *
+ * Pointers returned by find() and references returned by insert() are only
+ * valid until the next insertion or clear().
+ **/
+template <typename K, typename V, size_t DIRECT = 0>
+class IntegerMap
+{
+public:
+
+	IntegerMap()
+		: directValues(DIRECT)
+		, directUsed(DIRECT, 0)
+		, count(0)
+		, hashedCount(0)
+		, mask(0)
+	{
+	}
+
+	V *find(K key)
+	{
+		if ((uint64) key < DIRECT)
+			return directUsed[(size_t) key] ? &directValues[(size_t) key] : nullptr;
+
+		if (hashedCount == 0)
+			return nullptr;
+
+		for (size_t i = hash(key) & mask; used[i]; i = (i + 1) & mask)
+		{
+			if (keys[i] == key)
+				return &values[i];
+		}
+
+		return nullptr;
+	}
+
+	const V *find(K key) const
+	{
+		return const_cast<IntegerMap *>(this)->find(key);
+	}
+
+	/**
+	 * Sets the value for the given key, replacing any existing one.
+	 **/
+	V &insert(K key, const V &value)
+	{
+		if ((uint64) key < DIRECT)
+		{
+			size_t i = (size_t) key;
+			if (!directUsed[i])
+			{
+				directUsed[i] = 1;
+				count++;
+			}
+			directValues[i] = value;
+			return directValues[i];
+		}
+
+		// Keep the load factor at or below 1/2 so probe sequences stay short.
+		if ((hashedCount + 1) * 2 > keys.size())
+			rehash(keys.empty() ? 16 : keys.size() * 2);
+
+		size_t i = hash(key) & mask;
+		for (; used[i]; i = (i + 1) & mask)
+		{
+			if (keys[i] == key)
+			{
+				values[i] = value;
+				return values[i];
+			}
+		}
+
+		used[i] = 1;
+		keys[i] = key;
+		values[i] = value;
+		count++;
+		hashedCount++;
+
+		return values[i];
+	}
+
+	void clear()
+	{
+		for (size_t i = 0; i < DIRECT; i++)
+		{
+			directUsed[i] = 0;
+			directValues[i] = V();
+		}
+
+		keys.clear();
+		values.clear();
+		used.clear();
+
+		count = 0;
+		hashedCount = 0;
+		mask = 0;
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	/**
+	 * Calls func(key, value) for every entry, in no particular order. The map
+	 * must not be modified from within func.
+	 **/
+	template <typename F>
+	void forEach(F func)
+	{
+		for (size_t i = 0; i < DIRECT; i++)
+		{
+			if (directUsed[i])
+				func((K) i, directValues[i]);
+		}
+
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			if (used[i])
+				func(keys[i], values[i]);
+		}
+	}
+
+	template <typename F>
+	void forEach(F func) const
+	{
+		for (size_t i = 0; i < DIRECT; i++)
+		{
+			if (directUsed[i])
+				func((K) i, (const V &) directValues[i]);
+		}
+
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			if (used[i])
+				func(keys[i], (const V &) values[i]);
+		}
+	}
+
+private:
+
+	static size_t hash(K key)
+	{
+		// Finalizer from MurmurHash3, so sequential keys spread out.
+		uint64 h = (uint64) key;
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return (size_t) h;
+	}
+
+	void rehash(size_t newsize)
+	{
+		std::vector<K> oldkeys(newsize);
+		std::vector<V> oldvalues(newsize);
+		std::vector<uint8> oldused(newsize, 0);
+
+		std::swap(keys, oldkeys);
+		std::swap(values, oldvalues);
+		std::swap(used, oldused);
+
+		mask = newsize - 1;
+
+		for (size_t i = 0; i < oldkeys.size(); i++)
+		{
+			if (!oldused[i])
+				continue;
+
+			size_t j = hash(oldkeys[i]) & mask;
+			while (used[j])
+				j = (j + 1) & mask;
+
+			used[j] = 1;
+			keys[j] = oldkeys[i];
+			values[j] = std::move(oldvalues[i]);
+		}
+	}
+
+	std::vector<V> directValues;
+	std::vector<uint8> directUsed;
+
+	// Power-of-two sized, parallel arrays. Keys are kept apart from values so
+	// probing touches as little memory as possible.
+	std::vector<K> keys;
+	std::vector<V> values;
+	std::vector<uint8> used;
+
+	size_t count;
+	size_t hashedCount;
+	size_t mask;
+
+}; // IntegerMap
+
+} // love
+
+#endif // LOVE_INTEGER_MAP_H
@@ -71,6 +71,17 @@
 #	endif
 #endif
 
+// SSE2 (integer) instructions.
+#if defined(__SSE2__)
+#	define LOVE_SIMD_SSE2
+#elif defined(_MSC_VER)
+#	if defined(_M_AMD64) || defined(_M_X64)
+#		define LOVE_SIMD_SSE2
+#	elif _M_IX86_FP >= 2
+#		define LOVE_SIMD_SSE2
+#	endif
+#endif
+
 // NEON instructions.
 #if defined(__ARM_NEON)
 #	define LOVE_SIMD_NEON
@@ -1206,6 +1206,7 @@ pfn_glMultiDrawArraysIndirectCountARB fp_glMultiDrawArraysIndirectCountARB;
 pfn_glMultiDrawElementsIndirectCountARB fp_glMultiDrawElementsIndirectCountARB;
 pfn_glVertexAttribDivisorARB fp_glVertexAttribDivisorARB;
 pfn_glMaxShaderCompilerThreadsARB fp_glMaxShaderCompilerThreadsARB;
+pfn_glMaxShaderCompilerThreadsKHR fp_glMaxShaderCompilerThreadsKHR;
 pfn_glGetGraphicsResetStatusARB fp_glGetGraphicsResetStatusARB;
 pfn_glGetnTexImageARB fp_glGetnTexImageARB;
 pfn_glReadnPixelsARB fp_glReadnPixelsARB;
@@ -3759,6 +3760,11 @@ static void load_GL_KHR_debug(LOADER load) {
 }
 
 GLboolean GLAD_KHR_no_error = GL_FALSE;
+GLboolean GLAD_KHR_parallel_shader_compile = GL_FALSE;
+static void load_GL_KHR_parallel_shader_compile(LOADER load) {
+	if(!GLAD_KHR_parallel_shader_compile) return;
+	fp_glMaxShaderCompilerThreadsKHR = (pfn_glMaxShaderCompilerThreadsKHR)load("glMaxShaderCompilerThreadsKHR");
+}
 GLboolean GLAD_KHR_robust_buffer_access_behavior = GL_FALSE;
 GLboolean GLAD_KHR_robustness = GL_FALSE;
 static void load_GL_KHR_robustness(LOADER load) {
@@ -6748,6 +6754,7 @@ static void find_extensions(void) {
 	GLAD_KHR_context_flush_control = has_ext("GL_KHR_context_flush_control");
 	GLAD_KHR_debug = has_ext("GL_KHR_debug");
 	GLAD_KHR_no_error = has_ext("GL_KHR_no_error");
+	GLAD_KHR_parallel_shader_compile = has_ext("GL_KHR_parallel_shader_compile");
 	GLAD_KHR_robust_buffer_access_behavior = has_ext("GL_KHR_robust_buffer_access_behavior");
 	GLAD_KHR_robustness = has_ext("GL_KHR_robustness");
 	GLAD_KHR_texture_compression_astc_hdr = has_ext("GL_KHR_texture_compression_astc_hdr");
@@ -7299,6 +7306,7 @@ bool gladLoadGLLoader(LOADER load) {
 	find_extensions();
 	load_GL_KHR_blend_equation_advanced(load);
 	load_GL_KHR_debug(load);
+	load_GL_KHR_parallel_shader_compile(load);
 	load_GL_KHR_robustness(load);
 	load_GL_ARB_base_instance(load);
 	load_GL_ARB_bindless_texture(load);
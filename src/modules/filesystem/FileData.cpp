@@ -58,7 +58,7 @@ FileData::FileData(uint64 size, const std::string &filename)
 
 FileData::FileData(const FileData &c)
 	: data(nullptr)
-	, size(c.size)
+	, size(c.getSize())
 	, filename(c.filename)
 	, extension(c.extension)
 	, name(c.name)
@@ -71,7 +71,8 @@ FileData::FileData(const FileData &c)
 	{
 		throw love::Exception("Out of memory.");
 	}
-	memcpy(data, c.data, size);
+	// Through getData(), so copies of subclasses (e.g. mapped files) work too.
+	memcpy(data, c.getData(), (size_t) size);
 }
 
 FileData::~FileData()
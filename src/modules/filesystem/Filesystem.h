@@ -211,6 +211,14 @@ class Filesystem : public Module
 	 **/
 	virtual FileData *read(const char *filename, int64 size = File::ALL) const = 0;
 
+	/**
+	 * Gets the whole contents of a file, memory-mapped when the file is a
+	 * plain file on disk, and read into memory otherwise (e.g. when it's
+	 * inside a zip archive).
+	 * @param filename The name of the file to map.
+	 **/
+	virtual FileData *mapFile(const char *filename) const = 0;
+
 	/**
 	 * Write data to a file.
 	 * @param filename The name of the file to write to.
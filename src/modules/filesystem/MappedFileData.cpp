@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "MappedFileData.h"
+#include "common/config.h"
+
+#ifdef LOVE_WINDOWS
+#include <windows.h>
+#include "common/utf8.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace love
+{
+namespace filesystem
+{
+
+MappedFileData::MappedFileData(const std::string &path, const std::string &filename)
+	: FileData(0, filename)
+	, mapping(nullptr)
+	, mappedSize(0)
+{
+#ifdef LOVE_WINDOWS
+	std::wstring wpath = to_widestr(path);
+
+	HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw love::Exception("Could not open file %s.", path.c_str());
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || (uint64) size.QuadPart > (uint64) SIZE_MAX)
+	{
+		CloseHandle(file);
+		throw love::Exception("Could not map file %s: invalid file size.", path.c_str());
+	}
+
+	// The mapping object and view keep the file open once the handle is closed.
+	HANDLE filemapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(file);
+
+	if (filemapping == nullptr)
+		throw love::Exception("Could not map file %s.", path.c_str());
+
+	mapping = MapViewOfFile(filemapping, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(filemapping);
+
+	if (mapping == nullptr)
+		throw love::Exception("Could not map file %s.", path.c_str());
+
+	mappedSize = (size_t) size.QuadPart;
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw love::Exception("Could not open file %s.", path.c_str());
+
+	struct stat buf;
+	if (fstat(fd, &buf) != 0 || buf.st_size <= 0 || (uint64) buf.st_size > (uint64) SIZE_MAX)
+	{
+		close(fd);
+		throw love::Exception("Could not map file %s: invalid file size.", path.c_str());
+	}
+
+	mappedSize = (size_t) buf.st_size;
+
+	// The mapping keeps its own reference to the file.
+	void *m = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (m == MAP_FAILED)
+		throw love::Exception("Could not map file %s.", path.c_str());
+
+	mapping = m;
+#endif
+}
+
+MappedFileData::~MappedFileData()
+{
+#ifdef LOVE_WINDOWS
+	UnmapViewOfFile(mapping);
+#else
+	munmap(mapping, mappedSize);
+#endif
+}
+
+void *MappedFileData::getData() const
+{
+	return mapping;
+}
+
+size_t MappedFileData::getSize() const
+{
+	return mappedSize;
+}
+
+} // filesystem
+} // love
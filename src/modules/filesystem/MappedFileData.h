@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_FILESYSTEM_MAPPED_FILE_DATA_H
+#define LOVE_FILESYSTEM_MAPPED_FILE_DATA_H
+
+// LOVE
+#include "FileData.h"
+
+namespace love
+{
+namespace filesystem
+{
+
+/**
+ * FileData backed by a memory mapping of a file on disk instead of a heap copy
+ * of its contents, so the OS only reads in the pages that get touched. The
+ * mapping is copy-on-write: writes through getData() never reach the file.
+ **/
+class MappedFileData : public FileData
+{
+public:
+
+	/**
+	 * @param path The native path of the file to map.
+	 * @param filename The name reported by getFilename() (usually the path
+	 *        within the game's virtual filesystem).
+	 **/
+	MappedFileData(const std::string &path, const std::string &filename);
+	virtual ~MappedFileData();
+
+	// Implements Data.
+	void *getData() const override;
+	size_t getSize() const override;
+
+private:
+
+	void *mapping;
+	size_t mappedSize;
+
+}; // MappedFileData
+
+} // filesystem
+} // love
+
+#endif // LOVE_FILESYSTEM_MAPPED_FILE_DATA_H
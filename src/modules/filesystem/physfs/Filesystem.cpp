@@ -21,6 +21,7 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cstring>
 
 #include "common/utf8.h"
 #include "common/b64.h"
@@ -28,6 +29,7 @@
 #include "Filesystem.h"
 #include "File.h"
 #include "PhysfsIo.h"
+#include "filesystem/MappedFileData.h"
 
 // PhysFS
 #include "libraries/physfs/physfs.h"
@@ -679,6 +681,45 @@ FileData *Filesystem::read(const char *filename, int64 size) const
 	return file.read(size);
 }
 
+FileData *Filesystem::mapFile(const char *filename) const
+{
+	if (!PHYSFS_isInit())
+		throw love::Exception("PhysFS is not initialized.");
+
+	const char *realdir = PHYSFS_getRealDir(filename);
+
+	// Files inside archives (including a .love or fused game) have no path of
+	// their own on disk, so they can only be read.
+	if (realdir != nullptr && isRealDirectory(realdir))
+	{
+		std::string path = filename;
+		while (!path.empty() && path[0] == '/')
+			path = path.substr(1);
+
+		// The search path entry may be mounted somewhere other than the root.
+		const char *mountpoint = PHYSFS_getMountPoint(realdir);
+		if (mountpoint != nullptr && strcmp(mountpoint, "/") != 0)
+		{
+			size_t len = strlen(mountpoint);
+			if (path.compare(0, len, mountpoint) == 0)
+				path = path.substr(len);
+		}
+
+		std::string fullpath = std::string(realdir) + LOVE_PATH_SEPARATOR + path;
+
+		try
+		{
+			return new MappedFileData(fullpath, filename);
+		}
+		catch (love::Exception &)
+		{
+			// Fall back to reading it (e.g. empty files can't be mapped.)
+		}
+	}
+
+	return read(filename);
+}
+
 void Filesystem::write(const char *filename, const void *data, int64 size) const
 {
 	File file(filename);
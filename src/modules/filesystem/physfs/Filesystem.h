@@ -83,6 +83,7 @@ class Filesystem final : public love::filesystem::Filesystem
 	bool remove(const char *file) override;
 
 	FileData *read(const char *filename, int64 size = File::ALL) const override;
+	FileData *mapFile(const char *filename) const override;
 	void write(const char *filename, const void *data, int64 size) const override;
 	void append(const char *filename, const void *data, int64 size) const override;
 
@@ -518,6 +518,25 @@ int w_read(lua_State *L)
 	return 2;
 }
 
+int w_mapFile(lua_State *L)
+{
+	const char *filename = luaL_checkstring(L, 1);
+
+	FileData *data = nullptr;
+	try
+	{
+		data = instance()->mapFile(filename);
+	}
+	catch (love::Exception &e)
+	{
+		return luax_ioError(L, "%s", e.what());
+	}
+
+	luax_pushtype(L, data);
+	data->release();
+	return 1;
+}
+
 static int w_write_or_append(lua_State *L, File::Mode mode)
 {
 	const char *filename = luaL_checkstring(L, 1);
@@ -973,6 +992,7 @@ static const luaL_Reg functions[] =
 	{ "createDirectory", w_createDirectory },
 	{ "remove", w_remove },
 	{ "read", w_read },
+	{ "mapFile", w_mapFile },
 	{ "write", w_write },
 	{ "append", w_append },
 	{ "getDirectoryItems", w_getDirectoryItems },
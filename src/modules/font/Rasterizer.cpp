@@ -107,5 +107,25 @@ float Rasterizer::getDPIScale() const
 	return dpiScale;
 }
 
+bool Rasterizer::isSDF() const
+{
+	return false;
+}
+
+bool Rasterizer::hasShaping() const
+{
+	return false;
+}
+
+void Rasterizer::shape(const uint32 * /*codepoints*/, int /*count*/, std::vector<ShapedGlyph> & /*glyphs*/) const
+{
+	throw love::Exception("Text shaping is not supported by this Rasterizer.");
+}
+
+GlyphData *Rasterizer::getGlyphDataForIndex(uint32 /*glyphindex*/) const
+{
+	throw love::Exception("Glyph indices are not supported by this Rasterizer.");
+}
+
 } // font
 } // love
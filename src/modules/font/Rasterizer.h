@@ -26,6 +26,9 @@
 #include "common/int.h"
 #include "GlyphData.h"
 
+// C++
+#include <vector>
+
 namespace love
 {
 namespace font
@@ -42,6 +45,23 @@ struct FontMetrics
 	int height;
 };
 
+/**
+ * A glyph produced by shaping a run of text. Positions are in pixels, at the
+ * Rasterizer's DPI scale.
+ **/
+struct ShapedGlyph
+{
+	// Font-specific glyph index, rather than a codepoint.
+	uint32 glyphIndex;
+
+	// Index of the first codepoint (in the shaped run) the glyph came from.
+	int cluster;
+
+	float advanceX;
+	float offsetX;
+	float offsetY;
+};
+
 /**
  * Holds data for a font object.
  **/
@@ -120,6 +140,29 @@ class Rasterizer : public Object
 
 	virtual DataType getDataType() const = 0;
 
+	/**
+	 * Gets whether glyphs are signed distance fields rather than coverage.
+	 * The distance is stored in the alpha channel, with 0.5 at the outline.
+	 **/
+	virtual bool isSDF() const;
+
+	/**
+	 * Gets whether shape() can be used. Shaping applies ligatures, contextual
+	 * forms, mark positioning and kerning from the font's layout tables.
+	 **/
+	virtual bool hasShaping() const;
+
+	/**
+	 * Shapes a run of codepoints which contains no line breaks. The glyphs
+	 * are appended to the given vector in visual (left to right) order.
+	 **/
+	virtual void shape(const uint32 *codepoints, int count, std::vector<ShapedGlyph> &glyphs) const;
+
+	/**
+	 * Gets a glyph by its font-specific index, as returned by shape().
+	 **/
+	virtual GlyphData *getGlyphDataForIndex(uint32 glyphindex) const;
+
 	float getDPIScale() const;
 
 protected:
@@ -56,19 +56,19 @@ Rasterizer *Font::newRasterizer(love::filesystem::FileData *data)
 	throw love::Exception("Invalid font file: %s", data->getFilename().c_str());
 }
 
-Rasterizer *Font::newTrueTypeRasterizer(love::Data *data, int size, TrueTypeRasterizer::Hinting hinting)
+Rasterizer *Font::newTrueTypeRasterizer(love::Data *data, int size, TrueTypeRasterizer::Hinting hinting, bool sdf)
 {
 	float dpiscale = 1.0f;
 	auto window = Module::getInstance<window::Window>(Module::M_WINDOW);
 	if (window != nullptr)
 		dpiscale = window->getDPIScale();
 
-	return newTrueTypeRasterizer(data, size, dpiscale, hinting);
+	return newTrueTypeRasterizer(data, size, dpiscale, hinting, sdf);
 }
 
-Rasterizer *Font::newTrueTypeRasterizer(love::Data *data, int size, float dpiscale, TrueTypeRasterizer::Hinting hinting)
+Rasterizer *Font::newTrueTypeRasterizer(love::Data *data, int size, float dpiscale, TrueTypeRasterizer::Hinting hinting, bool sdf)
 {
-	return new TrueTypeRasterizer(library, data, size, dpiscale, hinting);
+	return new TrueTypeRasterizer(library, data, size, dpiscale, hinting, sdf);
 }
 
 const char *Font::getName() const
@@ -22,9 +22,18 @@
 #include "TrueTypeRasterizer.h"
 #include "common/Exception.h"
 
+#ifdef LOVE_ENABLE_HARFBUZZ
+// HarfBuzz
+#include <hb-ft.h>
+#endif
+
 // C
 #include <math.h>
 
+// C++
+#include <algorithm>
+#include <vector>
+
 namespace love
 {
 namespace font
@@ -32,9 +41,243 @@ namespace font
 namespace freetype
 {
 
-TrueTypeRasterizer::TrueTypeRasterizer(FT_Library library, love::Data *data, int size, float dpiscale, Hinting hinting)
+#ifdef LOVE_ENABLE_HARFBUZZ
+
+// A run of codepoints with a single script and direction, which is what
+// HarfBuzz expects to shape at once.
+struct ScriptRun
+{
+	int start;
+	int end;
+	hb_script_t script;
+	hb_direction_t direction;
+	int level;
+};
+
+static hb_direction_t getScriptDirection(hb_script_t script)
+{
+	hb_direction_t dir = hb_script_get_horizontal_direction(script);
+	return dir == HB_DIRECTION_RTL ? HB_DIRECTION_RTL : HB_DIRECTION_LTR;
+}
+
+static bool isSharedScript(hb_script_t script)
+{
+	return script == HB_SCRIPT_COMMON || script == HB_SCRIPT_INHERITED || script == HB_SCRIPT_UNKNOWN;
+}
+
+/**
+ * Splits a line into runs of one script and direction each, in logical order.
+ * Directions follow a subset of the Unicode Bidirectional Algorithm (UAX #9)
+ * without explicit embeddings: a script's characters are strong, and shared
+ * characters (spaces, punctuation, digits) take the direction of the strong
+ * text around them, or the paragraph's direction between opposite ones.
+ * Numbers in right-to-left text are still written left to right.
+ * Returns the paragraph's embedding level.
+ **/
+static int itemize(const uint32 *codepoints, int count, std::vector<ScriptRun> &runs)
+{
+	hb_unicode_funcs_t *ufuncs = hb_unicode_funcs_get_default();
+
+	std::vector<hb_script_t> scripts(count);
+	std::vector<bool> numbers(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		scripts[i] = hb_unicode_script(ufuncs, codepoints[i]);
+
+		// Combining marks belong to whatever they're attached to.
+		if (scripts[i] == HB_SCRIPT_INHERITED && i > 0)
+			scripts[i] = scripts[i - 1];
+
+		numbers[i] = hb_unicode_general_category(ufuncs, codepoints[i]) == HB_UNICODE_GENERAL_CATEGORY_DECIMAL_NUMBER;
+	}
+
+	// Separators between digits are part of the number (W4).
+	for (int i = 1; i + 1 < count; i++)
+	{
+		uint32 c = codepoints[i];
+		if ((c == '.' || c == ',' || c == ':' || c == '/') && numbers[i - 1] && numbers[i + 1])
+			numbers[i] = true;
+	}
+
+	// The paragraph direction comes from its first strong character (P2, P3).
+	hb_direction_t paragraphdir = HB_DIRECTION_LTR;
+	for (int i = 0; i < count; i++)
+	{
+		if (!isSharedScript(scripts[i]))
+		{
+			paragraphdir = getScriptDirection(scripts[i]);
+			break;
+		}
+	}
+
+	// Resolve each sequence of shared characters to a neighbouring script
+	// (N1, N2).
+	int i = 0;
+	while (i < count)
+	{
+		if (!isSharedScript(scripts[i]))
+		{
+			i++;
+			continue;
+		}
+
+		int end = i;
+		while (end < count && isSharedScript(scripts[end]))
+			end++;
+
+		hb_script_t prev = i > 0 ? scripts[i - 1] : HB_SCRIPT_INVALID;
+		hb_script_t next = end < count ? scripts[end] : HB_SCRIPT_INVALID;
+
+		hb_direction_t prevdir = prev != HB_SCRIPT_INVALID ? getScriptDirection(prev) : paragraphdir;
+		hb_direction_t nextdir = next != HB_SCRIPT_INVALID ? getScriptDirection(next) : paragraphdir;
+
+		hb_script_t script = HB_SCRIPT_COMMON;
+
+		if (prev != HB_SCRIPT_INVALID && (prevdir == nextdir || prevdir == paragraphdir))
+			script = prev;
+		else if (next != HB_SCRIPT_INVALID && (prevdir == nextdir || nextdir == paragraphdir))
+			script = next;
+
+		for (int j = i; j < end; j++)
+			scripts[j] = script;
+
+		i = end;
+	}
+
+	int paragraphlevel = paragraphdir == HB_DIRECTION_RTL ? 1 : 0;
+
+	for (int start = 0; start < count;)
+	{
+		hb_script_t script = scripts[start];
+		hb_direction_t dir = script == HB_SCRIPT_COMMON ? paragraphdir : getScriptDirection(script);
+		bool rtl = dir == HB_DIRECTION_RTL;
+
+		int end = start + 1;
+		while (end < count && scripts[end] == script && (!rtl || numbers[end] == numbers[start]))
+			end++;
+
+		ScriptRun run;
+		run.start = start;
+		run.end = end;
+		run.script = script;
+		run.direction = dir;
+		run.level = dir == paragraphdir ? paragraphlevel : paragraphlevel + 1;
+
+		// A number goes up to the next even level (W7, I1, I2).
+		if (rtl && numbers[start])
+		{
+			run.direction = HB_DIRECTION_LTR;
+			run.level += run.level % 2 == 1 ? 1 : 2;
+		}
+
+		runs.push_back(run);
+
+		start = end;
+	}
+
+	return paragraphlevel;
+}
+
+// Puts runs from logical into visual order (UAX #9 rule L2): from the highest
+// level down to the lowest odd one, every sequence of runs at that level or
+// higher is reversed.
+static void reorderRuns(std::vector<ScriptRun> &runs, int paragraphlevel)
+{
+	int maxlevel = paragraphlevel;
+	for (const ScriptRun &run : runs)
+		maxlevel = std::max(maxlevel, run.level);
+
+	int minoddlevel = paragraphlevel % 2 == 1 ? paragraphlevel : paragraphlevel + 1;
+
+	for (int level = maxlevel; level >= minoddlevel; level--)
+	{
+		size_t i = 0;
+		while (i < runs.size())
+		{
+			if (runs[i].level < level)
+			{
+				i++;
+				continue;
+			}
+
+			size_t end = i;
+			while (end < runs.size() && runs[end].level >= level)
+				end++;
+
+			std::reverse(runs.begin() + i, runs.begin() + end);
+			i = end;
+		}
+	}
+}
+
+#endif // LOVE_ENABLE_HARFBUZZ
+
+// Squared Euclidean distance transform of a 1D sampled function, from
+// "Distance Transforms of Sampled Functions" (Felzenszwalb & Huttenlocher).
+static void distanceTransform1D(const float *f, float *d, int *v, float *z, int n)
+{
+	const float inf = 1e20f;
+
+	int k = 0;
+	v[0] = 0;
+	z[0] = -inf;
+	z[1] = inf;
+
+	for (int q = 1; q < n; q++)
+	{
+		float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		while (s <= z[k])
+		{
+			k--;
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		}
+
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = inf;
+	}
+
+	k = 0;
+	for (int q = 0; q < n; q++)
+	{
+		while (z[k + 1] < q)
+			k++;
+		d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+	}
+}
+
+static void distanceTransform2D(std::vector<float> &grid, int w, int h)
+{
+	int n = std::max(w, h);
+	std::vector<float> f(n), d(n), z(n + 1);
+	std::vector<int> v(n);
+
+	for (int x = 0; x < w; x++)
+	{
+		for (int y = 0; y < h; y++)
+			f[y] = grid[y * w + x];
+		distanceTransform1D(f.data(), d.data(), v.data(), z.data(), h);
+		for (int y = 0; y < h; y++)
+			grid[y * w + x] = d[y];
+	}
+
+	for (int y = 0; y < h; y++)
+	{
+		distanceTransform1D(&grid[y * w], d.data(), v.data(), z.data(), w);
+		std::copy(d.begin(), d.begin() + w, grid.begin() + y * w);
+	}
+}
+
+TrueTypeRasterizer::TrueTypeRasterizer(FT_Library library, love::Data *data, int size, float dpiscale, Hinting hinting, bool sdf)
 	: data(data)
+#ifdef LOVE_ENABLE_HARFBUZZ
+	, hbFont(nullptr)
+#endif
 	, hinting(hinting)
+	, sdf(sdf)
+	, sdfSpread(0)
 {
 	this->dpiScale = dpiscale;
 	size = floorf(size * dpiscale + 0.5f);
@@ -42,6 +285,10 @@ TrueTypeRasterizer::TrueTypeRasterizer(FT_Library library, love::Data *data, int
 	if (size <= 0)
 		throw love::Exception("Invalid TrueType font size: %d", size);
 
+	// Wide enough for outlines and glows when the text is drawn scaled up.
+	if (sdf)
+		sdfSpread = std::max(2, (int) ceilf(size / 8.0f));
+
 	FT_Error err = FT_Err_Ok;
 	err = FT_New_Memory_Face(library,
 	                         (const FT_Byte *)data->getData(), /* first byte in memory */
@@ -63,10 +310,20 @@ TrueTypeRasterizer::TrueTypeRasterizer(FT_Library library, love::Data *data, int
 	metrics.ascent  = (int) (s.ascender >> 6);
 	metrics.descent = (int) (s.descender >> 6);
 	metrics.height  = (int) (s.height >> 6);
+
+#ifdef LOVE_ENABLE_HARFBUZZ
+	// Takes its own reference to the face. Advances have to come from the same
+	// (hinted) outlines as the rasterized glyphs.
+	hbFont = hb_ft_font_create_referenced(face);
+	hb_ft_font_set_load_flags(hbFont, FT_LOAD_DEFAULT | hintingToLoadOption(hinting));
+#endif
 }
 
 TrueTypeRasterizer::~TrueTypeRasterizer()
 {
+#ifdef LOVE_ENABLE_HARFBUZZ
+	hb_font_destroy(hbFont);
+#endif
 	FT_Done_Face(face);
 }
 
@@ -76,6 +333,16 @@ int TrueTypeRasterizer::getLineHeight() const
 }
 
 GlyphData *TrueTypeRasterizer::getGlyphData(uint32 glyph) const
+{
+	return loadGlyphData(glyph, false);
+}
+
+GlyphData *TrueTypeRasterizer::getGlyphDataForIndex(uint32 glyphindex) const
+{
+	return loadGlyphData(glyphindex, true);
+}
+
+GlyphData *TrueTypeRasterizer::loadGlyphData(uint32 glyph, bool isindex) const
 {
 	love::font::GlyphMetrics glyphMetrics = {};
 	FT_Glyph ftglyph;
@@ -83,8 +350,16 @@ GlyphData *TrueTypeRasterizer::getGlyphData(uint32 glyph) const
 	FT_Error err = FT_Err_Ok;
 	FT_UInt loadoption = hintingToLoadOption(hinting);
 
+	love::thread::Lock lock(mutex);
+
+	FT_UInt glyphindex = isindex ? (FT_UInt) glyph : FT_Get_Char_Index(face, glyph);
+
+	// Glyphs loaded by index don't correspond to a single codepoint.
+	if (isindex)
+		glyph = 0;
+
 	// Initialize
-	err = FT_Load_Glyph(face, FT_Get_Char_Index(face, glyph), FT_LOAD_DEFAULT | loadoption);
+	err = FT_Load_Glyph(face, glyphindex, FT_LOAD_DEFAULT | loadoption);
 
 	if (err != FT_Err_Ok)
 		throw love::Exception("TrueType Font glyph error: FT_Load_Glyph failed (0x%x)", err);
@@ -157,6 +432,91 @@ GlyphData *TrueTypeRasterizer::getGlyphData(uint32 glyph) const
 	// Having copied the data over, we can destroy the glyph.
 	FT_Done_Glyph(ftglyph);
 
+	if (sdf && glyphMetrics.width > 0 && glyphMetrics.height > 0)
+	{
+		GlyphData *sdfdata = nullptr;
+
+		try
+		{
+			sdfdata = createSDFGlyphData(glyphData);
+		}
+		catch (love::Exception &)
+		{
+			glyphData->release();
+			throw;
+		}
+
+		glyphData->release();
+		return sdfdata;
+	}
+
+	return glyphData;
+}
+
+GlyphData *TrueTypeRasterizer::createSDFGlyphData(const GlyphData *coverage) const
+{
+	int w = coverage->getWidth();
+	int h = coverage->getHeight();
+	int spread = sdfSpread;
+
+	love::font::GlyphMetrics gm = {};
+	gm.width = w + spread * 2;
+	gm.height = h + spread * 2;
+	gm.bearingX = coverage->getBearingX() - spread;
+	gm.bearingY = coverage->getBearingY() + spread;
+	gm.advance = coverage->getAdvance();
+
+	int pw = gm.width;
+	int ph = gm.height;
+
+	const uint8 *src = (const uint8 *) coverage->getData();
+	const float inf = 1e20f;
+
+	// Squared distances to the nearest pixel inside and outside the outline.
+	std::vector<float> toinside((size_t) pw * ph, inf);
+	std::vector<float> tooutside((size_t) pw * ph, 0.0f);
+	std::vector<uint8> alpha((size_t) pw * ph, 0);
+
+	for (int y = 0; y < h; y++)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			size_t i = (y + spread) * pw + (x + spread);
+			uint8 a = src[2 * (y * w + x) + 1];
+			alpha[i] = a;
+
+			if (a >= 128)
+			{
+				toinside[i] = 0.0f;
+				tooutside[i] = inf;
+			}
+		}
+	}
+
+	distanceTransform2D(toinside, pw, ph);
+	distanceTransform2D(tooutside, pw, ph);
+
+	GlyphData *glyphData = new GlyphData(coverage->getGlyph(), gm, PIXELFORMAT_LA8);
+	uint8 *dest = (uint8 *) glyphData->getData();
+
+	for (size_t i = 0; i < alpha.size(); i++)
+	{
+		// Positive outside the outline. Pixel centers straddling the edge are
+		// a full pixel apart, so the edge itself is half a pixel from each.
+		float dist = sqrtf(toinside[i]) - sqrtf(tooutside[i]);
+		dist += dist > 0.0f ? -0.5f : 0.5f;
+
+		// Antialiased pixels give a more precise position for the edge.
+		if (alpha[i] > 0 && alpha[i] < 255)
+			dist = 0.5f - alpha[i] / 255.0f;
+
+		float value = 0.5f - dist / (2.0f * spread);
+		value = std::min(std::max(value, 0.0f), 1.0f);
+
+		dest[2 * i + 0] = 255;
+		dest[2 * i + 1] = (uint8) (value * 255.0f + 0.5f);
+	}
+
 	return glyphData;
 }
 
@@ -167,12 +527,14 @@ int TrueTypeRasterizer::getGlyphCount() const
 
 bool TrueTypeRasterizer::hasGlyph(uint32 glyph) const
 {
+	love::thread::Lock lock(mutex);
 	return FT_Get_Char_Index(face, glyph) != 0;
 }
 
 float TrueTypeRasterizer::getKerning(uint32 leftglyph, uint32 rightglyph) const
 {
 	FT_Vector kerning = {};
+	love::thread::Lock lock(mutex);
 	FT_Get_Kerning(face,
 	               FT_Get_Char_Index(face, leftglyph),
 	               FT_Get_Char_Index(face, rightglyph),
@@ -186,6 +548,79 @@ Rasterizer::DataType TrueTypeRasterizer::getDataType() const
 	return DATA_TRUETYPE;
 }
 
+bool TrueTypeRasterizer::isSDF() const
+{
+	return sdf;
+}
+
+bool TrueTypeRasterizer::hasShaping() const
+{
+#ifdef LOVE_ENABLE_HARFBUZZ
+	return true;
+#else
+	return false;
+#endif
+}
+
+void TrueTypeRasterizer::shape(const uint32 *codepoints, int count, std::vector<ShapedGlyph> &glyphs) const
+{
+#ifdef LOVE_ENABLE_HARFBUZZ
+	if (count <= 0)
+		return;
+
+	// Mixed-script and mixed-direction text has to be shaped one run at a
+	// time, with the runs laid out in visual order.
+	std::vector<ScriptRun> runs;
+	int paragraphlevel = itemize(codepoints, count, runs);
+	reorderRuns(runs, paragraphlevel);
+
+	hb_buffer_t *buffer = hb_buffer_create();
+
+	for (const ScriptRun &run : runs)
+	{
+		hb_buffer_clear_contents(buffer);
+
+		// The rest of the line is passed as context for contextual forms at
+		// the run's edges. Clusters are indices into the whole line.
+		hb_buffer_add_utf32(buffer, codepoints, count, run.start, run.end - run.start);
+
+		hb_buffer_set_script(buffer, run.script);
+		hb_buffer_set_direction(buffer, run.direction);
+
+		// Only the language is left to guess.
+		hb_buffer_guess_segment_properties(buffer);
+
+		{
+			love::thread::Lock lock(mutex);
+			hb_shape(hbFont, buffer, nullptr, 0);
+		}
+
+		unsigned int glyphcount = 0;
+		const hb_glyph_info_t *infos = hb_buffer_get_glyph_infos(buffer, &glyphcount);
+		const hb_glyph_position_t *positions = hb_buffer_get_glyph_positions(buffer, &glyphcount);
+
+		glyphs.reserve(glyphs.size() + glyphcount);
+
+		// Glyphs of right-to-left runs are already in visual order. Positions
+		// are in 26.6 fixed point, with y pointing up.
+		for (unsigned int i = 0; i < glyphcount; i++)
+		{
+			ShapedGlyph g;
+			g.glyphIndex = infos[i].codepoint;
+			g.cluster = (int) infos[i].cluster;
+			g.advanceX = positions[i].x_advance / 64.0f;
+			g.offsetX = positions[i].x_offset / 64.0f;
+			g.offsetY = -positions[i].y_offset / 64.0f;
+			glyphs.push_back(g);
+		}
+	}
+
+	hb_buffer_destroy(buffer);
+#else
+	love::font::Rasterizer::shape(codepoints, count, glyphs);
+#endif
+}
+
 bool TrueTypeRasterizer::accepts(FT_Library library, love::Data *data)
 {
 	const FT_Byte *fbase = (const FT_Byte *) data->getData();
@@ -24,12 +24,18 @@
 // LOVE
 #include "filesystem/FileData.h"
 #include "font/TrueTypeRasterizer.h"
+#include "thread/threads.h"
 
 // FreeType2
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_GLYPH_H
 
+#ifdef LOVE_ENABLE_HARFBUZZ
+// HarfBuzz
+#include <hb.h>
+#endif
+
 namespace love
 {
 namespace font
@@ -44,7 +50,7 @@ class TrueTypeRasterizer : public love::font::TrueTypeRasterizer
 {
 public:
 
-	TrueTypeRasterizer(FT_Library library, love::Data *data, int size, float dpiscale, Hinting hinting);
+	TrueTypeRasterizer(FT_Library library, love::Data *data, int size, float dpiscale, Hinting hinting, bool sdf = false);
 	virtual ~TrueTypeRasterizer();
 
 	// Implement Rasterizer
@@ -54,6 +60,10 @@ class TrueTypeRasterizer : public love::font::TrueTypeRasterizer
 	bool hasGlyph(uint32 glyph) const override;
 	float getKerning(uint32 leftglyph, uint32 rightglyph) const override;
 	DataType getDataType() const override;
+	bool isSDF() const override;
+	bool hasShaping() const override;
+	void shape(const uint32 *codepoints, int count, std::vector<ShapedGlyph> &glyphs) const override;
+	GlyphData *getGlyphDataForIndex(uint32 glyphindex) const override;
 
 	static bool accepts(FT_Library library, love::Data *data);
 
@@ -61,14 +71,34 @@ class TrueTypeRasterizer : public love::font::TrueTypeRasterizer
 
 	static FT_UInt hintingToLoadOption(Hinting hinting);
 
+	// Loads a glyph by codepoint, or by glyph index if isindex is true.
+	GlyphData *loadGlyphData(uint32 glyph, bool isindex) const;
+
+	GlyphData *createSDFGlyphData(const GlyphData *coverage) const;
+
 	// TrueType face
 	FT_Face face;
 
+	// FreeType faces can't be used from multiple threads at once, and glyphs
+	// may be rasterized on worker threads.
+	love::thread::MutexRef mutex;
+
 	// Font data
 	StrongRef<love::Data> data;
 
+#ifdef LOVE_ENABLE_HARFBUZZ
+	// Shapes text using the face's size and load flags. Guarded by mutex too,
+	// since it loads glyphs from the face.
+	hb_font_t *hbFont;
+#endif
+
 	Hinting hinting;
 
+	bool sdf;
+
+	// Distance in pixels covered by the SDF on either side of the outline.
+	int sdfSpread;
+
 }; // TrueTypeRasterizer
 
 } // freetype
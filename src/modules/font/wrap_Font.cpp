@@ -78,12 +78,14 @@ int w_newTrueTypeRasterizer(lua_State *L)
 		if (hintstr && !TrueTypeRasterizer::getConstant(hintstr, hinting))
 			return luax_enumerror(L, "TrueType font hinting mode", TrueTypeRasterizer::getConstants(hinting), hintstr);
 
+		bool sdf = luax_optboolean(L, 4, false);
+
 		if (lua_isnoneornil(L, 3))
-			luax_catchexcept(L, [&](){ t = instance()->newTrueTypeRasterizer(size, hinting); });
+			luax_catchexcept(L, [&](){ t = instance()->newTrueTypeRasterizer(size, hinting, sdf); });
 		else
 		{
 			float dpiscale = (float) luaL_checknumber(L, 3);
-			luax_catchexcept(L, [&](){ t = instance()->newTrueTypeRasterizer(size, dpiscale, hinting); });
+			luax_catchexcept(L, [&](){ t = instance()->newTrueTypeRasterizer(size, dpiscale, hinting, sdf); });
 		}
 	}
 	else
@@ -104,10 +106,12 @@ int w_newTrueTypeRasterizer(lua_State *L)
 		if (hintstr && !TrueTypeRasterizer::getConstant(hintstr, hinting))
 			return luax_enumerror(L, "TrueType font hinting mode", TrueTypeRasterizer::getConstants(hinting), hintstr);
 
+		bool sdf = luax_optboolean(L, 5, false);
+
 		if (lua_isnoneornil(L, 4))
 		{
 			luax_catchexcept(L,
-				[&]() { t = instance()->newTrueTypeRasterizer(d, size, hinting); },
+				[&]() { t = instance()->newTrueTypeRasterizer(d, size, hinting, sdf); },
 				[&](bool) { d->release(); }
 			);
 		}
@@ -115,7 +119,7 @@ int w_newTrueTypeRasterizer(lua_State *L)
 		{
 			float dpiscale = (float) luaL_checknumber(L, 4);
 			luax_catchexcept(L,
-				[&]() { t = instance()->newTrueTypeRasterizer(d, size, dpiscale, hinting); },
+				[&]() { t = instance()->newTrueTypeRasterizer(d, size, dpiscale, hinting, sdf); },
 				[&](bool) { d->release(); }
 			);
 		}
@@ -23,6 +23,7 @@
 #include "image/Image.h"
 #include "image/ImageData.h"
 #include "Texture.h"
+#include "Readback.h"
 #include "common/Optional.h"
 #include "common/StringMap.h"
 
@@ -81,6 +82,12 @@ class Canvas : public Texture
 	int getRequestedMSAA() const;
 
 	virtual love::image::ImageData *newImageData(love::image::Image *module, int slice, int mipmap, const Rect &rect);
+
+	/**
+	 * Like newImageData, but doesn't wait for the GPU to finish rendering to
+	 * the Canvas. The returned Readback provides the ImageData once it does.
+	 **/
+	virtual Readback *newImageDataAsync(love::image::Image *module, int slice, int mipmap, const Rect &rect) = 0;
 	virtual void generateMipmaps() = 0;
 
 	virtual int getMSAA() const = 0;
@@ -25,9 +25,12 @@
 
 #include "common/math.h"
 #include "common/Matrix.h"
+#include "thread/WorkerPool.h"
+#include "libraries/xxHash/xxhash.h"
 #include "Graphics.h"
 
 #include <math.h>
+#include <cmath>
 #include <sstream>
 #include <algorithm> // for max
 #include <limits>
@@ -42,6 +45,84 @@ static inline uint16 normToUint16(double n)
 	return (uint16) (n * LOVE_UINT16_MAX);
 }
 
+// Glyphs produced by text shaping are keyed by their font-specific index and
+// the Rasterizer they came from. The top bit keeps them apart from codepoints.
+static const uint32 GLYPH_INDEX_FLAG = 0x80000000;
+
+static inline uint32 getGlyphIndexKey(size_t rasterizer, uint32 glyphindex)
+{
+	return GLYPH_INDEX_FLAG | ((uint32) rasterizer << 16) | (glyphindex & 0xFFFF);
+}
+
+// Glyph indices have to fit in the 16 bits getGlyphIndexKey keeps of them.
+// OpenType fonts can't have more glyphs than that anyway.
+static void checkShapingGlyphCount(const love::font::Rasterizer *r)
+{
+	if (r->hasShaping() && r->getGlyphCount() > 0x10000)
+		throw love::Exception("Fonts with more than 65536 glyphs can't be used for text shaping.");
+}
+
+static inline size_t getGlyphIndexRasterizer(uint32 glyph)
+{
+	return (glyph & ~GLYPH_INDEX_FLAG) >> 16;
+}
+
+static love::font::GlyphData *getGlyphData(love::font::Rasterizer *r, uint32 glyph)
+{
+	if (glyph & GLYPH_INDEX_FLAG)
+		return r->getGlyphDataForIndex(glyph & 0xFFFF);
+	else
+		return r->getGlyphData(glyph);
+}
+
+static Color32 getTextColor(Colorf c, const Colorf &linearconstantcolor)
+{
+	c.r = std::min(std::max(c.r, 0.0f), 1.0f);
+	c.g = std::min(std::max(c.g, 0.0f), 1.0f);
+	c.b = std::min(std::max(c.b, 0.0f), 1.0f);
+	c.a = std::min(std::max(c.a, 0.0f), 1.0f);
+
+	gammaCorrectColor(c);
+	c *= linearconstantcolor;
+	unGammaCorrectColor(c);
+
+	return toColor32(c);
+}
+
+static void sortDrawCommands(std::vector<Font::DrawCommand> &commands)
+{
+	const auto drawsort = [](const Font::DrawCommand &a, const Font::DrawCommand &b) -> bool
+	{
+		// Texture binds are expensive, so we should sort by that first.
+		if (a.texture != b.texture)
+			return a.texture < b.texture;
+		else
+			return a.startvertex < b.startvertex;
+	};
+
+	std::sort(commands.begin(), commands.end(), drawsort);
+}
+
+Font::GlyphRasterizeTask::GlyphRasterizeTask(love::font::Rasterizer *r, const std::vector<uint32> &glyphs)
+	: rasterizer(r)
+	, glyphs(glyphs)
+{
+}
+
+void Font::GlyphRasterizeTask::run()
+{
+	glyphData.reserve(glyphs.size());
+	for (uint32 g : glyphs)
+		glyphData.emplace_back(getGlyphData(rasterizer, g), Acquire::NORETAIN);
+}
+
+void Font::GlyphRasterizeTask::getPendingGlyphs(std::vector<PendingGlyph> &pending) const
+{
+	float dpiscale = rasterizer->getDPIScale();
+	for (size_t i = 0; i < glyphData.size(); i++)
+		pending.push_back({glyphs[i], glyphData[i], dpiscale});
+}
+
 love::Type Font::type("Font", &Object::type);
 int Font::fontCount = 0;
 
@@ -53,6 +134,16 @@ Font::Font(love::font::Rasterizer *r, const Texture::Filter &f)
 	, lineHeight(1)
 	, textureWidth(128)
 	, textureHeight(128)
+	, dirtyRowStart(0)
+	, dirtyRowEnd(0)
+	, atlasBudget(0)
+	, usedArea(0)
+	, useCounter(0)
+	, glyphUseDepth(0)
+	, evictionCount(0)
+	, compactionCount(0)
+	, layoutCacheVertexCount(0)
+	, shaping(r->hasShaping())
 	, filter(f)
 	, dpiScale(r->getDPIScale())
 	, useSpacesAsTab(false)
@@ -76,6 +167,8 @@ Font::Font(love::font::Rasterizer *r, const Texture::Filter &f)
 		textureHeight = nextsize.height;
 	}
 
+	checkShapingGlyphCount(r);
+
 	love::font::GlyphData *gd = r->getGlyphData(32); // Space character.
 	pixelFormat = gd->getFormat();
 	gd->release();
@@ -124,6 +217,7 @@ bool Font::loadVolatile()
 	textureCacheID++;
 	glyphs.clear();
 	images.clear();
+	usedArea = 0;
 	createTexture();
 	return true;
 }
@@ -141,12 +235,34 @@ void Font::createTexture()
 	// If we have an existing texture already, we'll try replacing it with a
 	// larger-sized one rather than creating a second one. Having a single
 	// texture reduces texture switches and draw calls when rendering.
-	if ((nextsize.width > size.width || nextsize.height > size.height) && !images.empty())
+	bool grow = nextsize.width > size.width || nextsize.height > size.height;
+
+	// Evict old glyphs rather than going over the memory budget, if possible.
+	if (atlasBudget > 0 && !images.empty())
+	{
+		size_t bpp = getPixelFormatSize(pixelFormat);
+		size_t texturesize = (size_t) size.width * size.height * bpp;
+		size_t newsize = images.size() * texturesize + texturesize;
+
+		if (grow)
+			newsize = newsize - texturesize * 2 + (size_t) nextsize.width * nextsize.height * bpp;
+
+		if (newsize > atlasBudget && rebuildAtlas(true))
+			return;
+	}
+
+	if (grow && !images.empty())
 	{
 		recreatetexture = true;
 		size = nextsize;
 		images.pop_back();
 	}
+	else
+	{
+		// The current texture won't get any more glyphs, so this is the last
+		// chance to upload the ones still pending for it.
+		uploadGlyphs();
+	}
 
 	Image::Settings settings;
 	image = gfx->newImage(TEXTURE_2D, pixelFormat, size.width, size.height, 1, settings);
@@ -159,16 +275,17 @@ void Font::createTexture()
 		// Initialize the texture with transparent white for Luminance-Alpha
 		// formats (since we keep luminance constant and vary alpha in those
 		// glyphs), and transparent black otherwise.
-		std::vector<uint8> emptydata(pixelcount * bpp, 0);
+		atlasPixels.assign(pixelcount * bpp, 0);
 
 		if (pixelFormat == PIXELFORMAT_LA8)
 		{
 			for (size_t i = 0; i < pixelcount; i++)
-				emptydata[i * 2 + 0] = 255;
+				atlasPixels[i * 2 + 0] = 255;
 		}
 
-		Rect rect = {0, 0, size.width, size.height};
-		image->replacePixels(emptydata.data(), emptydata.size(), 0, 0, rect, false);
+		// The whole texture is uploaded along with its first glyphs.
+		dirtyRowStart = 0;
+		dirtyRowEnd = size.height;
 	}
 
 	images.emplace_back(image, Acquire::NORETAIN);
@@ -183,22 +300,177 @@ void Font::createTexture()
 	{
 		textureCacheID++;
 
-		std::vector<uint32> glyphstoadd;
+		std::vector<GlyphUse> glyphstoadd;
 
-		for (const auto &glyphpair : glyphs)
-			glyphstoadd.push_back(glyphpair.first);
+		glyphs.forEach([&](uint32 glyph, const Glyph &g)
+		{
+			glyphstoadd.push_back({glyph, g.lastUsed});
+		});
 
 		glyphs.clear();
-		
-		for (uint32 g : glyphstoadd)
-			addGlyph(g);
+		usedArea = 0;
+
+		readdGlyphs(glyphstoadd);
 	}
 }
 
+bool Font::rebuildAtlas(bool requireeviction)
+{
+	if (images.empty())
+		return false;
+
+	std::vector<GlyphUse> order;
+	order.reserve(glyphs.size());
+
+	glyphs.forEach([&](uint32 glyph, const Glyph &g)
+	{
+		order.push_back({glyph, g.lastUsed});
+	});
+
+	// Most recently used first.
+	std::sort(order.begin(), order.end(), [](const GlyphUse &a, const GlyphUse &b) -> bool
+	{
+		if (a.lastUsed != b.lastUsed)
+			return a.lastUsed > b.lastUsed;
+		return a.glyph < b.glyph;
+	});
+
+	// Only fill half of what the budget allows, so the atlas doesn't run out
+	// of space again right away.
+	int64 keeparea = std::numeric_limits<int64>::max();
+
+	if (atlasBudget > 0)
+	{
+		size_t texturesize = (size_t) textureWidth * textureHeight * getPixelFormatSize(pixelFormat);
+		size_t maxtextures = std::max<size_t>(atlasBudget / texturesize, 1);
+		keeparea = (int64) (maxtextures * textureWidth * textureHeight / 2);
+	}
+
+	std::vector<GlyphUse> keep;
+	keep.reserve(order.size());
+	int64 area = 0;
+
+	for (const GlyphUse &use : order)
+	{
+		int glypharea = glyphs.find(use.glyph)->area;
+
+		// Glyphs needed by the text currently being laid out are always kept.
+		if (use.lastUsed != useCounter && area + glypharea > keeparea)
+			continue;
+
+		area += glypharea;
+		keep.push_back(use);
+	}
+
+	int evicted = (int) (order.size() - keep.size());
+
+	if (evicted == 0 && (requireeviction || images.size() <= 1))
+		return false;
+
+	auto gfx = Module::getInstance<graphics::Graphics>(Module::M_GRAPHICS);
+	gfx->flushStreamDraws();
+
+	evictionCount += evicted;
+	compactionCount++;
+	textureCacheID++;
+
+	glyphs.clear();
+	images.clear();
+	usedArea = 0;
+
+	createTexture();
+
+	// Re-packing from scratch (tallest first) also fills the new textures more
+	// densely than glyphs which were added as they were needed.
+	readdGlyphs(keep);
+
+	return true;
+}
+
+void Font::readdGlyphs(const std::vector<GlyphUse> &uses)
+{
+	std::vector<uint32> glyphlist;
+	glyphlist.reserve(uses.size());
+
+	for (const GlyphUse &use : uses)
+		glyphlist.push_back(use.glyph);
+
+	rasterizeGlyphs(glyphlist);
+
+	for (const GlyphUse &use : uses)
+	{
+		Glyph *g = glyphs.find(use.glyph);
+		if (g != nullptr)
+			g->lastUsed = use.lastUsed;
+	}
+}
+
+void Font::beginGlyphUse()
+{
+	if (glyphUseDepth++ == 0)
+		useCounter++;
+}
+
+void Font::endGlyphUse()
+{
+	if (glyphUseDepth > 0)
+		glyphUseDepth--;
+}
+
+void Font::compactAtlas()
+{
+	rebuildAtlas(false);
+}
+
+void Font::setAtlasBudget(size_t bytes)
+{
+	atlasBudget = bytes;
+}
+
+size_t Font::getAtlasBudget() const
+{
+	return atlasBudget;
+}
+
+Font::AtlasStats Font::getAtlasStats() const
+{
+	AtlasStats stats = {};
+
+	int64 texturepixels = (int64) textureWidth * textureHeight;
+
+	stats.textures = (int) images.size();
+	stats.glyphs = (int) glyphs.size();
+	stats.textureMemory = (int64) images.size() * texturepixels * getPixelFormatSize(pixelFormat);
+	stats.occupancy = images.empty() ? 0.0f : (float) ((double) usedArea / (double) (texturepixels * images.size()));
+	stats.evictions = evictionCount;
+	stats.compactions = compactionCount;
+
+	return stats;
+}
+
 void Font::unloadVolatile()
 {
+	clearLayoutCache();
 	glyphs.clear();
 	images.clear();
+	usedArea = 0;
+	atlasPixels.clear();
+	atlasPixels.shrink_to_fit();
+	dirtyRowStart = dirtyRowEnd = 0;
+}
+
+void Font::uploadGlyphs()
+{
+	if (dirtyRowEnd <= dirtyRowStart || images.empty())
+		return;
+
+	// Whole rows are contiguous in the CPU copy, so no repacking is needed.
+	size_t rowsize = getPixelFormatSize(pixelFormat) * textureWidth;
+	Rect rect = {0, dirtyRowStart, textureWidth, dirtyRowEnd - dirtyRowStart};
+
+	images.back()->replacePixels(&atlasPixels[rowsize * dirtyRowStart], rowsize * rect.h, 0, 0, rect, false);
+
+	dirtyRowStart = dirtyRowEnd = 0;
 }
 
 love::font::GlyphData *Font::getRasterizerGlyphData(uint32 glyph, float &dpiscale)
@@ -220,6 +492,13 @@ love::font::GlyphData *Font::getRasterizerGlyphData(uint32 glyph, float &dpiscal
 		return new love::font::GlyphData(glyph, gm, fmt);
 	}
 
+	if (glyph & GLYPH_INDEX_FLAG)
+	{
+		love::font::Rasterizer *r = rasterizers[getGlyphIndexRasterizer(glyph)];
+		dpiscale = r->getDPIScale();
+		return getGlyphData(r, glyph);
+	}
+
 	for (const StrongRef<love::font::Rasterizer> &r : rasterizers)
 	{
 		if (r->hasGlyph(glyph))
@@ -233,11 +512,245 @@ love::font::GlyphData *Font::getRasterizerGlyphData(uint32 glyph, float &dpiscal
 	return rasterizers[0]->getGlyphData(glyph);
 }
 
+void Font::getMissingGlyphs(const Codepoints &codepoints, std::vector<uint32> &missing)
+{
+	for (uint32 g : codepoints)
+	{
+		if (g == '\n' || g == '\r')
+			continue;
+
+		Glyph *glyph = glyphs.find(g);
+		if (glyph != nullptr)
+		{
+			glyph->lastUsed = useCounter;
+			continue;
+		}
+
+		if (std::find(missing.begin(), missing.end(), g) == missing.end())
+			missing.push_back(g);
+	}
+}
+
+void Font::groupGlyphsByRasterizer(const std::vector<uint32> &glyphlist, std::vector<std::vector<uint32>> &groups, std::vector<uint32> &tabs) const
+{
+	groups.resize(rasterizers.size());
+
+	for (uint32 g : glyphlist)
+	{
+		if (g == 9 && useSpacesAsTab)
+		{
+			tabs.push_back(g);
+			continue;
+		}
+
+		if (g & GLYPH_INDEX_FLAG)
+		{
+			groups[getGlyphIndexRasterizer(g)].push_back(g);
+			continue;
+		}
+
+		size_t index = 0;
+		for (size_t i = 0; i < rasterizers.size(); i++)
+		{
+			if (rasterizers[i]->hasGlyph(g))
+			{
+				index = i;
+				break;
+			}
+		}
+
+		groups[index].push_back(g);
+	}
+}
+
+void Font::addGlyphs(const Codepoints &codepoints)
+{
+	// Glyphs rasterized by preloadAsync are cheaper to use than re-rasterizing.
+	if (!preloadTasks.empty())
+		commitPreloadedGlyphs();
+
+	// Glyphs touched from here on belong to the text being laid out.
+	if (glyphUseDepth == 0)
+		useCounter++;
+
+	std::vector<uint32> missing;
+	getMissingGlyphs(codepoints, missing);
+
+	rasterizeGlyphs(missing);
+}
+
+void Font::rasterizeGlyphs(const std::vector<uint32> &glyphlist)
+{
+	if (glyphlist.empty())
+		return;
+
+	// Each Rasterizer has its own face, so separate groups can be rasterized
+	// concurrently.
+	std::vector<std::vector<uint32>> groups;
+	std::vector<uint32> tabs;
+	groupGlyphsByRasterizer(glyphlist, groups, tabs);
+
+	std::vector<PendingGlyph> pending;
+	pending.reserve(glyphlist.size());
+
+	std::vector<StrongRef<GlyphRasterizeTask>> tasks;
+	bool firstgroup = true;
+
+	for (size_t i = 0; i < groups.size(); i++)
+	{
+		if (groups[i].empty())
+			continue;
+
+		// The first group is rasterized on this thread while the rest run.
+		if (firstgroup)
+		{
+			firstgroup = false;
+			continue;
+		}
+
+		StrongRef<GlyphRasterizeTask> task(new GlyphRasterizeTask(rasterizers[i], groups[i]), Acquire::NORETAIN);
+		love::thread::WorkerPool::getInstance().submit(task);
+		tasks.push_back(task);
+	}
+
+	for (size_t i = 0; i < groups.size(); i++)
+	{
+		if (groups[i].empty())
+			continue;
+
+		for (uint32 g : groups[i])
+		{
+			StrongRef<love::font::GlyphData> gd(rasterizers[i]->getGlyphData(g), Acquire::NORETAIN);
+			pending.push_back({g, gd, rasterizers[i]->getDPIScale()});
+		}
+		break;
+	}
+
+	for (uint32 g : tabs)
+	{
+		float dpiscale = getDPIScale();
+		StrongRef<love::font::GlyphData> gd(getRasterizerGlyphData(g, dpiscale), Acquire::NORETAIN);
+		pending.push_back({g, gd, dpiscale});
+	}
+
+	std::string error;
+
+	for (const StrongRef<GlyphRasterizeTask> &task : tasks)
+	{
+		task->wait();
+
+		if (task->hasError())
+			error = task->getError();
+		else
+			task->getPendingGlyphs(pending);
+	}
+
+	if (!error.empty())
+		throw love::Exception("%s", error.c_str());
+
+	placeGlyphs(pending);
+}
+
+void Font::placeGlyphs(std::vector<PendingGlyph> &pending)
+{
+	// Packing the tallest glyphs first wastes less space in each row.
+	const auto heightsort = [](const PendingGlyph &a, const PendingGlyph &b) -> bool
+	{
+		if (a.data->getHeight() != b.data->getHeight())
+			return a.data->getHeight() > b.data->getHeight();
+		return a.glyph < b.glyph;
+	};
+
+	std::sort(pending.begin(), pending.end(), heightsort);
+
+	for (const PendingGlyph &p : pending)
+	{
+		// Adding a glyph may re-create the texture, which re-adds all glyphs
+		// rasterized so far.
+		if (glyphs.find(p.glyph) == nullptr)
+			placeGlyph(p.glyph, p.data, p.dpiScale);
+	}
+}
+
+void Font::preload(const Codepoints &codepoints)
+{
+	addGlyphs(codepoints);
+	uploadGlyphs();
+}
+
+void Font::preloadAsync(const Codepoints &codepoints)
+{
+	std::vector<uint32> missing;
+	getMissingGlyphs(codepoints, missing);
+
+	// Skip glyphs which an earlier call is already rasterizing.
+	for (const StrongRef<GlyphRasterizeTask> &task : preloadTasks)
+	{
+		for (uint32 g : task->getGlyphs())
+			missing.erase(std::remove(missing.begin(), missing.end(), g), missing.end());
+	}
+
+	if (missing.empty())
+		return;
+
+	std::vector<std::vector<uint32>> groups;
+	std::vector<uint32> tabs;
+	groupGlyphsByRasterizer(missing, groups, tabs);
+
+	for (size_t i = 0; i < groups.size(); i++)
+	{
+		if (groups[i].empty())
+			continue;
+
+		StrongRef<GlyphRasterizeTask> task(new GlyphRasterizeTask(rasterizers[i], groups[i]), Acquire::NORETAIN);
+		love::thread::WorkerPool::getInstance().submit(task);
+		preloadTasks.push_back(task);
+	}
+
+	// Tabs made of spaces don't need any rasterization.
+	for (uint32 g : tabs)
+		addGlyph(g);
+}
+
+bool Font::isPreloaded()
+{
+	commitPreloadedGlyphs();
+	return preloadTasks.empty();
+}
+
+void Font::commitPreloadedGlyphs()
+{
+	std::vector<PendingGlyph> pending;
+
+	for (auto it = preloadTasks.begin(); it != preloadTasks.end();)
+	{
+		if (!(*it)->isFinished())
+		{
+			++it;
+			continue;
+		}
+
+		// Glyphs which failed to rasterize are left to be added on demand,
+		// where the error can be reported by whatever needed them.
+		if (!(*it)->hasError())
+			(*it)->getPendingGlyphs(pending);
+
+		it = preloadTasks.erase(it);
+	}
+
+	placeGlyphs(pending);
+}
+
 const Font::Glyph &Font::addGlyph(uint32 glyph)
 {
 	float glyphdpiscale = getDPIScale();
 	StrongRef<love::font::GlyphData> gd(getRasterizerGlyphData(glyph, glyphdpiscale), Acquire::NORETAIN);
 
+	return placeGlyph(glyph, gd, glyphdpiscale);
+}
+
+const Font::Glyph &Font::placeGlyph(uint32 glyph, love::font::GlyphData *gd, float glyphdpiscale)
+{
 	int w = gd->getWidth();
 	int h = gd->getHeight();
 
@@ -258,7 +771,7 @@ const Font::Glyph &Font::addGlyph(uint32 glyph)
 
 			// Makes sure the above code for checking if the glyph can fit at
 			// the current position in the texture is run again for this glyph.
-			return addGlyph(glyph);
+			return placeGlyph(glyph, gd, glyphdpiscale);
 		}
 	}
 
@@ -266,6 +779,8 @@ const Font::Glyph &Font::addGlyph(uint32 glyph)
 
 	g.texture = 0;
 	g.spacing = floorf(gd->getAdvance() / glyphdpiscale + 0.5f);
+	g.lastUsed = useCounter;
+	g.area = 0;
 
 	memset(g.vertices, 0, sizeof(GlyphVertex) * 4);
 
@@ -275,8 +790,32 @@ const Font::Glyph &Font::addGlyph(uint32 glyph)
 		Image *image = images.back();
 		g.texture = image;
 
-		Rect rect = {textureX, textureY, gd->getWidth(), gd->getHeight()};
-		image->replacePixels(gd->getData(), gd->getSize(), 0, 0, rect, false);
+		// Glyphs too large for the texture are clipped rather than written
+		// out of bounds.
+		size_t bpp = getPixelFormatSize(pixelFormat);
+		int copyw = std::min(w, textureWidth - textureX);
+		int copyh = std::min(h, textureHeight - textureY);
+
+		if (copyw > 0 && copyh > 0)
+		{
+			const uint8 *src = (const uint8 *) gd->getData();
+			for (int y = 0; y < copyh; y++)
+			{
+				uint8 *dst = &atlasPixels[((textureY + y) * textureWidth + textureX) * bpp];
+				memcpy(dst, src + y * w * bpp, copyw * bpp);
+			}
+
+			if (dirtyRowEnd <= dirtyRowStart)
+			{
+				dirtyRowStart = textureY;
+				dirtyRowEnd = textureY + copyh;
+			}
+			else
+			{
+				dirtyRowStart = std::min(dirtyRowStart, textureY);
+				dirtyRowEnd = std::max(dirtyRowEnd, textureY + copyh);
+			}
+		}
 
 		double tX     = (double) textureX,     tY      = (double) textureY;
 		double tWidth = (double) textureWidth, tHeight = (double) textureHeight;
@@ -309,29 +848,47 @@ const Font::Glyph &Font::addGlyph(uint32 glyph)
 
 		textureX += w + TEXTURE_PADDING;
 		rowHeight = std::max(rowHeight, h + TEXTURE_PADDING);
+
+		g.area = (w + TEXTURE_PADDING) * (h + TEXTURE_PADDING);
+		usedArea += g.area;
 	}
 
-	glyphs[glyph] = g;
-	return glyphs[glyph];
+	return glyphs.insert(glyph, g);
 }
 
 const Font::Glyph &Font::findGlyph(uint32 glyph)
 {
-	const auto it = glyphs.find(glyph);
+	Glyph *g = glyphs.find(glyph);
 
-	if (it != glyphs.end())
-		return it->second;
+	if (g != nullptr)
+	{
+		g->lastUsed = useCounter;
+		return *g;
+	}
 
 	return addGlyph(glyph);
 }
 
 float Font::getKerning(uint32 leftglyph, uint32 rightglyph)
 {
+	int16 *latin1k = nullptr;
 	uint64 packedglyphs = ((uint64) leftglyph << 32) | (uint64) rightglyph;
 
-	const auto it = kerning.find(packedglyphs);
-	if (it != kerning.end())
-		return it->second;
+	if (leftglyph < 256 && rightglyph < 256)
+	{
+		if (latin1Kerning.empty())
+			latin1Kerning.resize(256 * 256, (int16) KERNING_UNKNOWN);
+
+		latin1k = &latin1Kerning[(leftglyph << 8) | rightglyph];
+		if (*latin1k != KERNING_UNKNOWN)
+			return (float) *latin1k;
+	}
+	else
+	{
+		const float *cached = kerning.find(packedglyphs);
+		if (cached != nullptr)
+			return *cached;
+	}
 
 	float k = floorf(rasterizers[0]->getKerning(leftglyph, rightglyph) / dpiScale + 0.5f);
 
@@ -344,7 +901,15 @@ float Font::getKerning(uint32 leftglyph, uint32 rightglyph)
 		}
 	}
 
-	kerning[packedglyphs] = k;
+	if (latin1k != nullptr)
+	{
+		// Kerning is a whole number of pixels, far smaller than int16's range.
+		k = std::min(std::max(k, -32767.0f), 32767.0f);
+		*latin1k = (int16) k;
+	}
+	else
+		kerning.insert(packedglyphs, k);
+
 	return k;
 }
 
@@ -423,6 +988,9 @@ float Font::getHeight() const
 
 std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &codepoints, const Colorf &constantcolor, std::vector<GlyphVertex> &vertices, float extra_spacing, Vector2 offset, TextInfo *info)
 {
+	if (shaping)
+		return generateVerticesShaped(codepoints, constantcolor, vertices, extra_spacing, offset, info);
+
 	// Spacing counter and newline handling.
 	float dx = offset.x;
 	float dy = offset.y;
@@ -443,6 +1011,9 @@ std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &c
 
 	uint32 prevglyph = 0;
 
+	// Rasterize and pack all of the string's missing glyphs up-front.
+	addGlyphs(codepoints.cps);
+
 	Colorf linearconstantcolor = gammaCorrectColor(constantcolor);
 
 	Color32 curcolor = toColor32(constantcolor);
@@ -454,20 +1025,7 @@ std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &c
 		uint32 g = codepoints.cps[i];
 
 		if (curcolori + 1 < ncolors && codepoints.colors[curcolori + 1].index == i)
-		{
-			Colorf c = codepoints.colors[++curcolori].color;
-
-			c.r = std::min(std::max(c.r, 0.0f), 1.0f);
-			c.g = std::min(std::max(c.g, 0.0f), 1.0f);
-			c.b = std::min(std::max(c.b, 0.0f), 1.0f);
-			c.a = std::min(std::max(c.a, 0.0f), 1.0f);
-
-			gammaCorrectColor(c);
-			c *= linearconstantcolor;
-			unGammaCorrectColor(c);
-
-			curcolor = toColor32(c);
-		}
+			curcolor = getTextColor(codepoints.colors[++curcolori].color, linearconstantcolor);
 
 		if (g == '\n')
 		{
@@ -542,16 +1100,267 @@ std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &c
 		prevglyph = g;
 	}
 
-	const auto drawsort = [](const DrawCommand &a, const DrawCommand &b) -> bool
+	sortDrawCommands(commands);
+
+	if (dx > maxwidth)
+		maxwidth = (int) dx;
+
+	if (info != nullptr)
 	{
-		// Texture binds are expensive, so we should sort by that first.
-		if (a.texture != b.texture)
-			return a.texture < b.texture;
-		else
-			return a.startvertex < b.startvertex;
+		info->width = maxwidth - offset.x;
+		info->height = (int) dy + (dx > 0.0f ? floorf(getHeight() * getLineHeight() + 0.5f) : 0) - offset.y;
+	}
+
+	return commands;
+}
+
+const Font::ShapedRun &Font::shapeLine(const uint32 *codepoints, int count)
+{
+	uint64 hash = XXH64(codepoints, sizeof(uint32) * count, 0);
+
+	auto it = shapedRuns.find(hash);
+	if (it != shapedRuns.end())
+	{
+		const ShapedRun &cached = it->second;
+		if (cached.codepoints.size() == (size_t) count && std::equal(codepoints, codepoints + count, cached.codepoints.begin()))
+			return cached;
+	}
+	else if (shapedRuns.size() >= MAX_SHAPED_RUNS)
+	{
+		// Text which is drawn every frame is shaped again right away, so a
+		// simple reset is enough to keep memory use bounded.
+		shapedRuns.clear();
+	}
+
+	ShapedRun &run = shapedRuns[hash];
+	run.codepoints.assign(codepoints, codepoints + count);
+	run.glyphs.clear();
+	run.advances.assign(count, std::numeric_limits<float>::quiet_NaN());
+
+	// Index of the Rasterizer which should shape a codepoint, or -1 if it's
+	// laid out on its own.
+	const auto getShapingRasterizer = [this](uint32 c) -> int
+	{
+		if (c == '\r' || (c == 9 && useSpacesAsTab))
+			return -1;
+
+		int index = 0;
+		for (size_t i = 0; i < rasterizers.size(); i++)
+		{
+			if (rasterizers[i]->hasGlyph(c))
+			{
+				index = (int) i;
+				break;
+			}
+		}
+
+		return rasterizers[index]->hasShaping() ? index : -1;
 	};
 
-	std::sort(commands.begin(), commands.end(), drawsort);
+	std::vector<love::font::ShapedGlyph> shaped;
+
+	int start = 0;
+	while (start < count)
+	{
+		int index = getShapingRasterizer(codepoints[start]);
+
+		if (index < 0)
+		{
+			run.glyphs.push_back({codepoints[start], start, false, 0.0f, 0.0f, 0.0f});
+			start++;
+			continue;
+		}
+
+		// Shape the longest run of codepoints which use the same Rasterizer.
+		int end = start + 1;
+		while (end < count && getShapingRasterizer(codepoints[end]) == index)
+			end++;
+
+		love::font::Rasterizer *r = rasterizers[index];
+		float invdpiscale = 1.0f / r->getDPIScale();
+
+		shaped.clear();
+		r->shape(codepoints + start, end - start, shaped);
+
+		std::fill(run.advances.begin() + start, run.advances.begin() + end, 0.0f);
+
+		for (const love::font::ShapedGlyph &sg : shaped)
+		{
+			PositionedGlyph g;
+			g.glyph = getGlyphIndexKey(index, sg.glyphIndex);
+			g.cluster = start + std::min(std::max(sg.cluster, 0), end - start - 1);
+			g.positioned = true;
+			g.advance = sg.advanceX * invdpiscale;
+			g.offsetX = sg.offsetX * invdpiscale;
+			g.offsetY = sg.offsetY * invdpiscale;
+
+			run.glyphs.push_back(g);
+			run.advances[g.cluster] += g.advance;
+		}
+
+		start = end;
+	}
+
+	return run;
+}
+
+std::vector<Font::DrawCommand> Font::generateVerticesShaped(const ColoredCodepoints &codepoints, const Colorf &constantcolor, std::vector<GlyphVertex> &vertices, float extra_spacing, Vector2 offset, TextInfo *info)
+{
+	const std::vector<uint32> &cps = codepoints.cps;
+	int count = (int) cps.size();
+
+	// Shape each line, in visual order. Newlines are kept as unpositioned
+	// entries so they can be handled in the loop below.
+	std::vector<PositionedGlyph> glyphlist;
+	glyphlist.reserve(count);
+
+	int linestart = 0;
+	while (linestart < count)
+	{
+		int lineend = linestart;
+		while (lineend < count && cps[lineend] != '\n')
+			lineend++;
+
+		if (lineend > linestart)
+		{
+			const ShapedRun &run = shapeLine(&cps[linestart], lineend - linestart);
+			for (PositionedGlyph g : run.glyphs)
+			{
+				g.cluster += linestart;
+				glyphlist.push_back(g);
+			}
+		}
+
+		if (lineend < count)
+			glyphlist.push_back({'\n', lineend, false, 0.0f, 0.0f, 0.0f});
+
+		linestart = lineend + 1;
+	}
+
+	// Glyphs get the color of the first codepoint they came from.
+	Colorf linearconstantcolor = gammaCorrectColor(constantcolor);
+	std::vector<Color32> colors(count, toColor32(constantcolor));
+
+	for (size_t i = 0; i < codepoints.colors.size(); i++)
+	{
+		int first = std::min(std::max(codepoints.colors[i].index, 0), count);
+		int last = i + 1 < codepoints.colors.size() ? codepoints.colors[i + 1].index : count;
+		last = std::min(std::max(last, first), count);
+
+		Color32 c = getTextColor(codepoints.colors[i].color, linearconstantcolor);
+		std::fill(colors.begin() + first, colors.begin() + last, c);
+	}
+
+	float dx = offset.x;
+	float dy = offset.y;
+
+	float heightoffset = 0.0f;
+
+	if (rasterizers[0]->getDataType() == font::Rasterizer::DATA_TRUETYPE)
+		heightoffset = getBaseline();
+
+	int maxwidth = 0;
+
+	std::vector<DrawCommand> commands;
+
+	size_t vertstartsize = vertices.size();
+	vertices.reserve(vertstartsize + glyphlist.size() * 4);
+
+	uint32 prevglyph = 0;
+
+	// Rasterize and pack all of the glyphs the lines use up-front.
+	{
+		Codepoints glyphkeys;
+		glyphkeys.reserve(glyphlist.size());
+
+		for (const PositionedGlyph &g : glyphlist)
+			glyphkeys.push_back(g.glyph);
+
+		addGlyphs(glyphkeys);
+	}
+
+	for (int i = 0; i < (int) glyphlist.size(); i++)
+	{
+		const PositionedGlyph &pg = glyphlist[i];
+
+		if (!pg.positioned && pg.glyph == '\n')
+		{
+			if (dx > maxwidth)
+				maxwidth = (int) dx;
+
+			dy += floorf(getHeight() * getLineHeight() + 0.5f);
+			dx = offset.x;
+			prevglyph = 0;
+			continue;
+		}
+
+		if (!pg.positioned && pg.glyph == '\r')
+			continue;
+
+		uint32 cacheid = textureCacheID;
+
+		const Glyph &glyph = findGlyph(pg.glyph);
+
+		// If findGlyph invalidates the texture cache, re-start the loop.
+		if (cacheid != textureCacheID)
+		{
+			i = -1;
+			maxwidth = 0;
+			dx = offset.x;
+			dy = offset.y;
+			commands.clear();
+			vertices.resize(vertstartsize);
+			prevglyph = 0;
+			continue;
+		}
+
+		float x = dx;
+		float y = dy + heightoffset;
+
+		if (pg.positioned)
+		{
+			// Shaped offsets are fractional, glyphs still snap to pixels.
+			x = floorf(x + pg.offsetX + 0.5f);
+			y = floorf(y + pg.offsetY + 0.5f);
+		}
+		else
+		{
+			dx += getKerning(prevglyph, pg.glyph);
+			x = dx;
+		}
+
+		if (glyph.texture != nullptr)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				vertices.push_back(glyph.vertices[j]);
+				vertices.back().x += x;
+				vertices.back().y += y;
+				vertices.back().color = colors[pg.cluster];
+			}
+
+			if (commands.empty() || commands.back().texture != glyph.texture)
+			{
+				DrawCommand cmd;
+				cmd.startvertex = (int) vertices.size() - 4;
+				cmd.vertexcount = 0;
+				cmd.texture = glyph.texture;
+				commands.push_back(cmd);
+			}
+
+			commands.back().vertexcount += 4;
+		}
+
+		dx += pg.positioned ? pg.advance : glyph.spacing;
+
+		if (cps[pg.cluster] == ' ' && extra_spacing != 0.0f)
+			dx = floorf(dx + extra_spacing);
+
+		// Pair kerning doesn't apply next to shaped glyphs.
+		prevglyph = pg.positioned ? 0 : pg.glyph;
+	}
+
+	sortDrawCommands(commands);
 
 	if (dx > maxwidth)
 		maxwidth = (int) dx;
@@ -660,6 +1469,8 @@ void Font::printv(graphics::Graphics *gfx, const Matrix4 &t, const std::vector<D
 	if (vertices.empty() || drawcommands.empty())
 		return;
 
+	uploadGlyphs();
+
 	Matrix4 m(gfx->getTransform(), t);
 
 	for (const DrawCommand &cmd : drawcommands)
@@ -670,6 +1481,9 @@ void Font::printv(graphics::Graphics *gfx, const Matrix4 &t, const std::vector<D
 		streamcmd.vertexCount = cmd.vertexcount;
 		streamcmd.texture = cmd.texture;
 
+		if (isSDF())
+			streamcmd.standardShaderType = Shader::STANDARD_SDF;
+
 		Graphics::StreamVertexData data = gfx->requestStreamDraw(streamcmd);
 		GlyphVertex *vertexdata = (GlyphVertex *) data.stream[0];
 
@@ -680,24 +1494,124 @@ void Font::printv(graphics::Graphics *gfx, const Matrix4 &t, const std::vector<D
 
 void Font::print(graphics::Graphics *gfx, const std::vector<ColoredString> &text, const Matrix4 &m, const Colorf &constantcolor)
 {
-	ColoredCodepoints codepoints;
-	getCodepointsFromString(text, codepoints);
+	// ALIGN_MAX_ENUM marks unformatted text in the layout cache.
+	const Layout &layout = getLayout(text, 0.0f, ALIGN_MAX_ENUM, constantcolor);
+	printv(gfx, m, layout.commands, layout.vertices);
+}
+
+void Font::printf(graphics::Graphics *gfx, const std::vector<ColoredString> &text, float wrap, AlignMode align, const Matrix4 &m, const Colorf &constantcolor)
+{
+	const Layout &layout = getLayout(text, std::max(wrap, 0.0f), align, constantcolor);
+	printv(gfx, m, layout.commands, layout.vertices);
+}
+
+const Font::Layout &Font::getLayout(const std::vector<ColoredString> &text, float wrap, AlignMode align, const Colorf &constantcolor)
+{
+	uint64 hash = 0;
+	for (const ColoredString &cstr : text)
+	{
+		hash = XXH64(cstr.str.data(), cstr.str.size(), hash);
+		hash = XXH64(&cstr.color, sizeof(Colorf), hash);
+	}
+
+	hash = XXH64(&wrap, sizeof(float), hash);
+	hash = XXH64(&align, sizeof(AlignMode), hash);
+	hash = XXH64(&constantcolor, sizeof(Colorf), hash);
+
+	auto indexit = layoutCacheIndex.find(hash);
+
+	if (indexit != layoutCacheIndex.end())
+	{
+		auto it = indexit->second;
+		Layout &layout = *it;
+
+		bool match = layout.wrap == wrap && layout.align == align
+			&& layout.constantColor == constantcolor && layout.text.size() == text.size();
+
+		for (size_t i = 0; match && i < text.size(); i++)
+			match = layout.text[i].str == text[i].str && layout.text[i].color == text[i].color;
+
+		if (match)
+		{
+			layoutCache.splice(layoutCache.begin(), layoutCache, it);
+
+			// The glyphs' texture coordinates may have changed.
+			if (layout.textureCacheID != textureCacheID)
+			{
+				layoutCacheVertexCount -= layout.vertices.size();
+				generateLayout(layout);
+				layoutCacheVertexCount += layout.vertices.size();
+			}
+			else if (atlasBudget > 0)
+			{
+				// Keep the glyphs from looking unused to atlas eviction.
+				for (uint32 g : layout.glyphs)
+				{
+					Glyph *glyph = glyphs.find(g);
+					if (glyph != nullptr)
+						glyph->lastUsed = useCounter;
+				}
+			}
+
+			return layout;
+		}
+
+		// A hash collision, the older layout is replaced.
+		layoutCacheVertexCount -= layout.vertices.size();
+		layoutCache.erase(it);
+		layoutCacheIndex.erase(indexit);
+	}
+
+	layoutCache.emplace_front();
+	Layout &layout = layoutCache.front();
+
+	layout.hash = hash;
+	layout.text = text;
+	layout.wrap = wrap;
+	layout.align = align;
+	layout.constantColor = constantcolor;
+
+	generateLayout(layout);
 
-	std::vector<GlyphVertex> vertices;
-	std::vector<DrawCommand> drawcommands = generateVertices(codepoints, constantcolor, vertices);
+	layoutCacheIndex[hash] = layoutCache.begin();
+	layoutCacheVertexCount += layout.vertices.size();
 
-	printv(gfx, m, drawcommands, vertices);
+	// The newest layout is kept even if it's over the limit on its own.
+	while (layoutCache.size() > 1 && (layoutCache.size() > MAX_CACHED_LAYOUTS || layoutCacheVertexCount > MAX_CACHED_LAYOUT_VERTICES))
+	{
+		const Layout &oldest = layoutCache.back();
+		layoutCacheVertexCount -= oldest.vertices.size();
+		layoutCacheIndex.erase(oldest.hash);
+		layoutCache.pop_back();
+	}
+
+	return layout;
 }
 
-void Font::printf(graphics::Graphics *gfx, const std::vector<ColoredString> &text, float wrap, AlignMode align, const Matrix4 &m, const Colorf &constantcolor)
+void Font::generateLayout(Layout &layout)
 {
 	ColoredCodepoints codepoints;
-	getCodepointsFromString(text, codepoints);
+	getCodepointsFromString(layout.text, codepoints);
 
-	std::vector<GlyphVertex> vertices;
-	std::vector<DrawCommand> drawcommands = generateVerticesFormatted(codepoints, constantcolor, wrap, align, vertices);
+	layout.vertices.clear();
 
-	printv(gfx, m, drawcommands, vertices);
+	if (layout.align == ALIGN_MAX_ENUM)
+		layout.commands = generateVertices(codepoints, layout.constantColor, layout.vertices);
+	else
+		layout.commands = generateVerticesFormatted(codepoints, layout.constantColor, layout.wrap, layout.align, layout.vertices);
+
+	layout.textureCacheID = textureCacheID;
+
+	layout.glyphs = codepoints.cps;
+	std::sort(layout.glyphs.begin(), layout.glyphs.end());
+	layout.glyphs.erase(std::unique(layout.glyphs.begin(), layout.glyphs.end()), layout.glyphs.end());
+}
+
+void Font::clearLayoutCache()
+{
+	layoutCache.clear();
+	layoutCacheIndex.clear();
+	layoutCacheVertexCount = 0;
 }
 
 int Font::getWidth(const std::string &str)
@@ -712,6 +1626,36 @@ int Font::getWidth(const std::string &str)
 	{
 		int width = 0;
 		uint32 prevglyph = 0;
+
+		if (shaping)
+		{
+			Codepoints codepoints;
+			getCodepointsFromString(line, codepoints);
+
+			if (codepoints.empty())
+				continue;
+
+			float shapedwidth = 0.0f;
+			const ShapedRun &run = shapeLine(codepoints.data(), (int) codepoints.size());
+
+			for (const PositionedGlyph &g : run.glyphs)
+			{
+				if (g.positioned)
+				{
+					shapedwidth += g.advance;
+					prevglyph = 0;
+				}
+				else if (g.glyph != '\r')
+				{
+					shapedwidth += findGlyph(g.glyph).spacing + getKerning(prevglyph, g.glyph);
+					prevglyph = g.glyph;
+				}
+			}
+
+			max_width = std::max(max_width, (int) shapedwidth);
+			continue;
+		}
+
 		try
 		{
 			utf8::iterator<std::string::const_iterator> i(line.begin(), line.begin(), line.end());
@@ -750,6 +1694,36 @@ int Font::getWidth(uint32 glyph)
 
 void Font::getWrap(const ColoredCodepoints &codepoints, float wraplimit, std::vector<ColoredCodepoints> &lines, std::vector<int> *linewidths)
 {
+	// Widths of shaped text come from the shaped glyphs, attributed to the
+	// codepoints they came from. NaN marks codepoints laid out on their own.
+	std::vector<float> advances;
+
+	if (shaping)
+	{
+		const std::vector<uint32> &cps = codepoints.cps;
+		int count = (int) cps.size();
+
+		advances.resize(count, std::numeric_limits<float>::quiet_NaN());
+
+		int linestart = 0;
+		while (linestart < count)
+		{
+			int lineend = linestart;
+			while (lineend < count && cps[lineend] != '\n')
+				lineend++;
+
+			if (lineend > linestart)
+			{
+				const ShapedRun &run = shapeLine(&cps[linestart], lineend - linestart);
+				std::copy(run.advances.begin(), run.advances.end(), advances.begin() + linestart);
+			}
+
+			linestart = lineend + 1;
+		}
+	}
+	else
+		addGlyphs(codepoints.cps);
+
 	// Per-line info.
 	float width = 0.0f;
 	float widthbeforelastspace = 0.0f;
@@ -812,8 +1786,16 @@ void Font::getWrap(const ColoredCodepoints &codepoints, float wraplimit, std::ve
 			continue;
 		}
 
-		const Glyph &g = findGlyph(c);
-		float charwidth = g.spacing + getKerning(prevglyph, c);
+		float charwidth = 0.0f;
+
+		if (!advances.empty() && !std::isnan(advances[i]))
+			charwidth = advances[i];
+		else
+		{
+			const Glyph &g = findGlyph(c);
+			charwidth = g.spacing + getKerning(prevglyph, c);
+		}
+
 		float newwidth = width + charwidth;
 
 		// Wrap the line if it exceeds the wrap limit. Don't wrap yet if we're
@@ -932,6 +1914,7 @@ void Font::getWrap(const std::vector<ColoredString> &text, float wraplimit, std:
 void Font::setLineHeight(float height)
 {
 	lineHeight = height;
+	clearLayoutCache();
 }
 
 float Font::getLineHeight() const
@@ -1016,13 +1999,39 @@ void Font::setFallbacks(const std::vector<Font *> &fallbacks)
 	{
 		if (f->rasterizers[0]->getDataType() != this->rasterizers[0]->getDataType())
 			throw love::Exception("Font fallbacks must be of the same font type.");
+
+		if (f->rasterizers[0]->isSDF() != this->rasterizers[0]->isSDF())
+			throw love::Exception("Font fallbacks must all be signed distance field fonts, or none of them.");
+
+		checkShapingGlyphCount(f->rasterizers[0]);
 	}
 
+	bool wasshaping = shaping;
+
 	rasterizers.resize(1);
 
 	// NOTE: this won't invalidate already-rasterized glyphs.
 	for (const Font *f : fallbacks)
 		rasterizers.push_back(f->rasterizers[0]);
+
+	shaping = false;
+	for (const auto &r : rasterizers)
+		shaping = shaping || r->hasShaping();
+
+	shapedRuns.clear();
+
+	// ...except for shaped glyphs, which are keyed by Rasterizer index.
+	if (wasshaping && glyphs.size() > 0)
+	{
+		auto gfx = Module::getInstance<graphics::Graphics>(Module::M_GRAPHICS);
+		gfx->flushStreamDraws();
+		loadVolatile();
+	}
+
+	// Preloaded glyphs may have come from a different Rasterizer.
+	preloadTasks.clear();
+
+	clearLayoutCache();
 }
 
 float Font::getDPIScale() const
@@ -1030,6 +2039,16 @@ float Font::getDPIScale() const
 	return dpiScale;
 }
 
+bool Font::isSDF() const
+{
+	return rasterizers[0]->isSDF();
+}
+
+bool Font::hasShaping() const
+{
+	return shaping;
+}
+
 uint32 Font::getTextureCacheID() const
 {
 	return textureCacheID;
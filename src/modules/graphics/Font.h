@@ -22,6 +22,7 @@
 
 // STD
 #include <unordered_map>
+#include <list>
 #include <string>
 #include <vector>
 #include <stddef.h>
@@ -31,8 +32,10 @@
 #include "common/Object.h"
 #include "common/Matrix.h"
 #include "common/Vector.h"
+#include "common/IntegerMap.h"
 
 #include "font/Rasterizer.h"
+#include "thread/WorkerPool.h"
 #include "Image.h"
 #include "vertex.h"
 #include "Volatile.h"
@@ -88,6 +91,16 @@ class Font : public Object, public Volatile
 		int height;
 	};
 
+	struct AtlasStats
+	{
+		int textures;
+		int glyphs;
+		int64 textureMemory;
+		float occupancy;
+		int evictions;
+		int compactions;
+	};
+
 	// Used to determine when to change textures in the generated vertex array.
 	struct DrawCommand
 	{
@@ -115,6 +128,50 @@ class Font : public Object, public Volatile
 	void print(graphics::Graphics *gfx, const std::vector<ColoredString> &text, const Matrix4 &m, const Colorf &constantColor);
 	void printf(graphics::Graphics *gfx, const std::vector<ColoredString> &text, float wrap, AlignMode align, const Matrix4 &m, const Colorf &constantColor);
 
+	/**
+	 * Uploads glyphs which were added to the texture atlas since the last call.
+	 * Must be called before drawing vertices returned by generateVertices.
+	 **/
+	void uploadGlyphs();
+
+	/**
+	 * Adds the given glyphs to the texture atlas ahead of time, so drawing or
+	 * measuring text which uses them later won't need to rasterize them.
+	 **/
+	void preload(const Codepoints &codepoints);
+
+	/**
+	 * Rasterizes the given glyphs on worker threads. They're added to the
+	 * texture atlas on the main thread once finished, the next time the Font
+	 * needs new glyphs or isPreloaded is called.
+	 **/
+	void preloadAsync(const Codepoints &codepoints);
+	bool isPreloaded();
+
+	/**
+	 * Limits the texture memory used by the glyph atlas. When it would grow
+	 * past the budget, the least recently used glyphs are evicted and the rest
+	 * are packed into a fresh atlas instead. 0 means no limit.
+	 **/
+	void setAtlasBudget(size_t bytes);
+	size_t getAtlasBudget() const;
+
+	/**
+	 * Re-packs the glyphs into as few textures as possible, evicting the least
+	 * recently used ones if the atlas is over its budget.
+	 **/
+	void compactAtlas();
+
+	/**
+	 * Glyphs laid out between beginGlyphUse and endGlyphUse all count as used
+	 * by the same text, so evicting glyphs for a later layout never drops the
+	 * glyphs of an earlier one. Calls can be nested.
+	 **/
+	void beginGlyphUse();
+	void endGlyphUse();
+
+	AtlasStats getAtlasStats() const;
+
 	/**
 	 * Returns the height of the font.
 	 **/
@@ -174,6 +231,19 @@ class Font : public Object, public Volatile
 
 	float getDPIScale() const;
 
+	/**
+	 * Whether the glyphs are signed distance fields. They're drawn with a
+	 * default shader which keeps edges sharp at any scale.
+	 **/
+	bool isSDF() const;
+
+	/**
+	 * Whether text is shaped (ligatures, contextual forms, mark positioning)
+	 * rather than laid out one codepoint at a time. Requires a Rasterizer
+	 * built with HarfBuzz support.
+	 **/
+	bool hasShaping() const;
+
 	uint32 getTextureCacheID() const;
 
 	// Implements Volatile.
@@ -192,23 +262,111 @@ class Font : public Object, public Volatile
 	{
 		Texture *texture;
 		int spacing;
+		uint32 lastUsed;
+		int area;
 		GlyphVertex vertices[4];
 	};
 
+	struct GlyphUse
+	{
+		uint32 glyph;
+		uint32 lastUsed;
+	};
+
+	// Vertices generated by print or printf, reused while the same text is
+	// drawn with the same parameters.
+	struct Layout
+	{
+		uint64 hash;
+		std::vector<ColoredString> text;
+		float wrap;
+		AlignMode align;
+		Colorf constantColor;
+		uint32 textureCacheID;
+		std::vector<uint32> glyphs;
+		std::vector<DrawCommand> commands;
+		std::vector<GlyphVertex> vertices;
+	};
+
+	// A glyph from shaping, or a codepoint which is laid out on its own
+	// (with pair kerning) because its Rasterizer can't shape text.
+	struct PositionedGlyph
+	{
+		uint32 glyph;
+		int cluster;
+		bool positioned;
+		float advance;
+		float offsetX;
+		float offsetY;
+	};
+
+	// The glyphs of one line of text, and the advance attributed to each of
+	// its codepoints (NaN for codepoints which weren't shaped).
+	struct ShapedRun
+	{
+		std::vector<uint32> codepoints;
+		std::vector<PositionedGlyph> glyphs;
+		std::vector<float> advances;
+	};
+
 	struct TextureSize
 	{
 		int width;
 		int height;
 	};
 
+	// A rasterized glyph which hasn't been added to the texture atlas yet.
+	struct PendingGlyph
+	{
+		uint32 glyph;
+		StrongRef<love::font::GlyphData> data;
+		float dpiScale;
+	};
+
+	class GlyphRasterizeTask : public love::thread::Task
+	{
+	public:
+
+		GlyphRasterizeTask(love::font::Rasterizer *r, const std::vector<uint32> &glyphs);
+		virtual ~GlyphRasterizeTask() {}
+
+		void run() override;
+
+		const std::vector<uint32> &getGlyphs() const { return glyphs; }
+		void getPendingGlyphs(std::vector<PendingGlyph> &pending) const;
+
+	private:
+
+		StrongRef<love::font::Rasterizer> rasterizer;
+		std::vector<uint32> glyphs;
+		std::vector<StrongRef<love::font::GlyphData>> glyphData;
+
+	}; // GlyphRasterizeTask
+
 	void createTexture();
+	bool rebuildAtlas(bool requireeviction);
+	void readdGlyphs(const std::vector<GlyphUse> &uses);
 
 	TextureSize getNextTextureSize() const;
 	love::font::GlyphData *getRasterizerGlyphData(uint32 glyph, float &dpiscale);
+	void getMissingGlyphs(const Codepoints &codepoints, std::vector<uint32> &missing);
+	void groupGlyphsByRasterizer(const std::vector<uint32> &glyphlist, std::vector<std::vector<uint32>> &groups, std::vector<uint32> &tabs) const;
+	void addGlyphs(const Codepoints &codepoints);
+	void rasterizeGlyphs(const std::vector<uint32> &glyphlist);
+	void placeGlyphs(std::vector<PendingGlyph> &pending);
+	void commitPreloadedGlyphs();
 	const Glyph &addGlyph(uint32 glyph);
+	const Glyph &placeGlyph(uint32 glyph, love::font::GlyphData *gd, float dpiscale);
 	const Glyph &findGlyph(uint32 glyph);
+	const ShapedRun &shapeLine(const uint32 *codepoints, int count);
+	std::vector<DrawCommand> generateVerticesShaped(const ColoredCodepoints &codepoints, const Colorf &constantColor, std::vector<GlyphVertex> &vertices,
+	                                                float extra_spacing, Vector2 offset, TextInfo *info);
 	void printv(Graphics *gfx, const Matrix4 &t, const std::vector<DrawCommand> &drawcommands, const std::vector<GlyphVertex> &vertices);
 
+	const Layout &getLayout(const std::vector<ColoredString> &text, float wrap, AlignMode align, const Colorf &constantcolor);
+	void generateLayout(Layout &layout);
+	void clearLayoutCache();
+
 	std::vector<StrongRef<love::font::Rasterizer>> rasterizers;
 
 	int height;
@@ -219,11 +377,53 @@ class Font : public Object, public Volatile
 
 	std::vector<StrongRef<love::graphics::Image>> images;
 
-	// maps glyphs to glyph texture information
-	std::unordered_map<uint32, Glyph> glyphs;
+	// CPU-side copy of the newest texture's pixels. New glyphs are written here
+	// and the rows they touch are uploaded together by uploadGlyphs(), instead
+	// of updating the texture once per glyph.
+	std::vector<uint8> atlasPixels;
+	int dirtyRowStart;
+	int dirtyRowEnd;
+
+	size_t atlasBudget;
+
+	// Texture area covered by glyphs (including padding), for getAtlasStats.
+	int64 usedArea;
+
+	// Incremented whenever text is laid out. Glyphs remember the value from
+	// their last use, so the least recently used ones can be evicted.
+	uint32 useCounter;
+
+	// Nesting depth of beginGlyphUse/endGlyphUse.
+	int glyphUseDepth;
+
+	int evictionCount;
+	int compactionCount;
+
+	// Rasterization started by preloadAsync which hasn't been committed yet.
+	std::vector<StrongRef<GlyphRasterizeTask>> preloadTasks;
+
+	// Most recently used layouts are at the front.
+	std::list<Layout> layoutCache;
+	std::unordered_map<uint64, std::list<Layout>::iterator> layoutCacheIndex;
+	size_t layoutCacheVertexCount;
+
+	// Shaped lines, keyed by a hash of their codepoints.
+	std::unordered_map<uint64, ShapedRun> shapedRuns;
+
+	// Whether any of the Rasterizers can shape text.
+	bool shaping;
+
+	// maps glyphs to glyph texture information. Latin-1 codepoints are
+	// indexed directly.
+	IntegerMap<uint32, Glyph, 256> glyphs;
 
 	// map of left/right glyph pairs to horizontal kerning.
-	std::unordered_map<uint64, float> kerning;
+	IntegerMap<uint64, float> kerning;
+
+	// Kerning of Latin-1 glyph pairs, indexed by (left << 8) | right. Allocated
+	// on first use; KERNING_UNKNOWN marks pairs which haven't been queried.
+	std::vector<int16> latin1Kerning;
+	static const int16 KERNING_UNKNOWN = -32768;
 
 	PixelFormat pixelFormat;
 
@@ -247,6 +447,11 @@ class Font : public Object, public Volatile
 	// This will be used if the Rasterizer doesn't have a tab character itself.
 	static const int SPACES_PER_TAB = 4;
 
+	static const size_t MAX_CACHED_LAYOUTS = 256;
+	static const size_t MAX_CACHED_LAYOUT_VERTICES = 64 * 1024;
+
+	static const size_t MAX_SHAPED_RUNS = 512;
+
 	static StringMap<AlignMode, ALIGN_MAX_ENUM>::Entry alignModeEntries[];
 	static StringMap<AlignMode, ALIGN_MAX_ENUM> alignModes;
 	
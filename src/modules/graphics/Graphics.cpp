@@ -32,10 +32,12 @@
 #include "Video.h"
 #include "Text.h"
 #include "common/deprecation.h"
+#include "common/version.h"
 
 // C++
 #include <algorithm>
 #include <stdlib.h>
+#include <string.h>
 
 namespace love
 {
@@ -119,9 +121,11 @@ Graphics::Graphics()
 	, canvasSwitchCount(0)
 	, drawCalls(0)
 	, drawCallsBatched(0)
+	, textureUploadBudget(8 * 1024 * 1024)
 	, quadIndexBuffer(nullptr)
 	, capabilities()
 	, cachedShaderStages()
+	, shaderValidationDeferred(false)
 {
 	transformStack.reserve(16);
 	transformStack.push_back(Matrix4());
@@ -214,7 +218,7 @@ love::graphics::ParticleSystem *Graphics::newParticleSystem(Texture *texture, in
 	return new ParticleSystem(texture, size);
 }
 
-ShaderStage *Graphics::newShaderStage(ShaderStage::StageType stage, const std::string &optsource)
+ShaderStage *Graphics::newShaderStage(ShaderStage::StageType stage, const std::string &optsource, bool deferValidation)
 {
 	if (stage == ShaderStage::STAGE_MAX_ENUM)
 		throw love::Exception("Invalid shader stage.");
@@ -241,7 +245,7 @@ ShaderStage *Graphics::newShaderStage(ShaderStage::StageType stage, const std::s
 
 	if (s == nullptr)
 	{
-		s = newShaderStageInternal(stage, cachekey, source, getRenderer() == RENDERER_OPENGLES);
+		s = newShaderStageInternal(stage, cachekey, source, getRenderer() == RENDERER_OPENGLES, deferValidation);
 		if (!cachekey.empty())
 			cachedShaderStages[stage][cachekey] = s;
 	}
@@ -257,7 +261,44 @@ Shader *Graphics::newShader(const std::string &vertex, const std::string &pixel)
 	StrongRef<ShaderStage> vertexstage(newShaderStage(ShaderStage::STAGE_VERTEX, vertex), Acquire::NORETAIN);
 	StrongRef<ShaderStage> pixelstage(newShaderStage(ShaderStage::STAGE_PIXEL, pixel), Acquire::NORETAIN);
 
-	return newShaderInternal(vertexstage.get(), pixelstage.get());
+	return newShaderInternal(vertexstage.get(), pixelstage.get(), false);
+}
+
+Shader *Graphics::newShaderAsync(const std::string &vertex, const std::string &pixel, Shader *fallback)
+{
+	if (vertex.empty() && pixel.empty())
+		throw love::Exception("Error creating shader: no source code!");
+
+	StrongRef<ShaderStage> vertexstage(newShaderStage(ShaderStage::STAGE_VERTEX, vertex, true), Acquire::NORETAIN);
+	StrongRef<ShaderStage> pixelstage(newShaderStage(ShaderStage::STAGE_PIXEL, pixel, true), Acquire::NORETAIN);
+
+	Shader *shader = newShaderInternal(vertexstage.get(), pixelstage.get(), true);
+	shader->setFallback(fallback);
+	return shader;
+}
+
+UniformBuffer *Graphics::newUniformBuffer(Shader *shader, const std::string &blockname, vertex::Usage usage)
+{
+	if (!capabilities.features[FEATURE_UNIFORM_BUFFERS])
+		throw love::Exception("Uniform buffers are not supported on this system.");
+
+	shader->waitUntilReady();
+
+	const Shader::UniformBlockInfo *block = shader->getUniformBlockInfo(blockname);
+	if (block == nullptr)
+		throw love::Exception("Shader uniform block '%s' does not exist.\nA common error is to define but not use the block.", blockname.c_str());
+
+	return new UniformBuffer(this, *block, usage);
+}
+
+VirtualTexture *Graphics::newVirtualTexture(Data *encoded, const VirtualTexture::Settings &settings)
+{
+	return new VirtualTexture(this, encoded, settings);
+}
+
+VirtualTexture *Graphics::newVirtualTexture(const std::string &pattern, int width, int height, const VirtualTexture::Settings &settings)
+{
+	return new VirtualTexture(this, pattern, width, height, settings);
 }
 
 Mesh *Graphics::newMesh(const std::vector<Vertex> &vertices, PrimitiveType drawmode, vertex::Usage usage)
@@ -312,6 +353,75 @@ bool Graphics::validateShader(bool gles, const std::string &vertex, const std::s
 	return Shader::validate(vertexstage.get(), pixelstage.get(), err);
 }
 
+void Graphics::setShaderValidationDeferred(bool deferred)
+{
+	shaderValidationDeferred = deferred;
+}
+
+bool Graphics::isShaderValidationDeferred() const
+{
+	return shaderValidationDeferred;
+}
+
+void Graphics::setTextureUploadBudget(size_t bytes)
+{
+	textureUploadBudget = bytes;
+}
+
+size_t Graphics::getTextureUploadBudget() const
+{
+	return textureUploadBudget;
+}
+
+bool Graphics::isShaderValidationCached(const std::string &key) const
+{
+	return shaderValidationCache.find(key) != shaderValidationCache.end();
+}
+
+void Graphics::addShaderValidationCacheEntry(const std::string &key)
+{
+	if (!key.empty())
+		shaderValidationCache.insert(key);
+}
+
+static const char shaderValidationCacheHeader[] = "love shader validation cache " LOVE_VERSION_STRING "\n";
+
+std::string Graphics::getShaderValidationCacheData() const
+{
+	std::string data = shaderValidationCacheHeader;
+
+	for (const std::string &key : shaderValidationCache)
+		data += key + "\n";
+
+	return data;
+}
+
+bool Graphics::loadShaderValidationCacheData(const char *data, size_t size)
+{
+	// Entries from other versions may have been validated against different
+	// glslang rules or default shader code, so they're not trusted.
+	size_t headerlen = strlen(shaderValidationCacheHeader);
+	if (size < headerlen || memcmp(data, shaderValidationCacheHeader, headerlen) != 0)
+		return false;
+
+	const char *end = data + size;
+	const char *line = data + headerlen;
+
+	while (line < end)
+	{
+		const char *lineend = (const char *) memchr(line, '\n', end - line);
+		if (lineend == nullptr)
+			lineend = end;
+
+		if (lineend > line)
+			shaderValidationCache.insert(std::string(line, lineend - line));
+
+		line = lineend + 1;
+	}
+
+	return true;
+}
+
 int Graphics::getWidth() const
 {
 	return width;
@@ -1588,7 +1698,7 @@ Graphics::Stats Graphics::getStats() const
 {
 	Stats stats;
 
-	getAPIStats(stats.shaderSwitches);
+	getAPIStats(stats.shaderSwitches, stats.uniformUpdates, stats.uniformUpdatesSkipped);
 
 	stats.drawCalls = drawCalls;
 	if (streamBufferState.vertexCount > 0)
@@ -1941,6 +2051,7 @@ StringMap<Graphics::Feature, Graphics::FEATURE_MAX_ENUM>::Entry Graphics::featur
 	{ "shaderderivatives",  FEATURE_SHADER_DERIVATIVES   },
 	{ "glsl3",              FEATURE_GLSL3                },
 	{ "instancing",         FEATURE_INSTANCING           },
+	{ "uniformbuffers",     FEATURE_UNIFORM_BUFFERS      },
 };
 
 StringMap<Graphics::Feature, Graphics::FEATURE_MAX_ENUM> Graphics::features(Graphics::featureEntries, sizeof(Graphics::featureEntries));
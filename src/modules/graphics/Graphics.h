@@ -36,9 +36,11 @@
 #include "Font.h"
 #include "ShaderStage.h"
 #include "Shader.h"
+#include "UniformBuffer.h"
 #include "Quad.h"
 #include "Mesh.h"
 #include "Image.h"
+#include "VirtualTexture.h"
 #include "Deprecations.h"
 #include "depthstencil.h"
 #include "math/Transform.h"
@@ -50,6 +52,7 @@
 // C++
 #include <string>
 #include <vector>
+#include <unordered_set>
 
 namespace love
 {
@@ -164,6 +167,7 @@ class Graphics : public Module
 		FEATURE_SHADER_DERIVATIVES,
 		FEATURE_GLSL3,
 		FEATURE_INSTANCING,
+		FEATURE_UNIFORM_BUFFERS,
 		FEATURE_MAX_ENUM
 	};
 
@@ -221,6 +225,8 @@ class Graphics : public Module
 		int drawCallsBatched;
 		int canvasSwitches;
 		int shaderSwitches;
+		int uniformUpdates;
+		int uniformUpdatesSkipped;
 		int canvases;
 		int images;
 		int fonts;
@@ -484,11 +490,31 @@ class Graphics : public Module
 
 	virtual Canvas *newCanvas(const Canvas::Settings &settings) = 0;
 
-	ShaderStage *newShaderStage(ShaderStage::StageType stage, const std::string &source);
+	ShaderStage *newShaderStage(ShaderStage::StageType stage, const std::string &source, bool deferValidation = false);
 	Shader *newShader(const std::string &vertex, const std::string &pixel);
 
+	/**
+	 * Starts compiling a Shader without waiting for the results. Use
+	 * Shader::isReady to find out when it can be used.
+	 **/
+	Shader *newShaderAsync(const std::string &vertex, const std::string &pixel, Shader *fallback);
+
 	virtual Buffer *newBuffer(size_t size, const void *data, BufferType type, vertex::Usage usage, uint32 mapflags) = 0;
 
+	/**
+	 * Creates a buffer with the layout of the given uniform block in a Shader.
+	 * Since blocks use the std140 layout, it can be used with any Shader which
+	 * declares an identical block.
+	 **/
+	UniformBuffer *newUniformBuffer(Shader *shader, const std::string &blockname, vertex::Usage usage);
+
+	/**
+	 * Creates a virtual texture whose pages are decoded from regions of a
+	 * single encoded image, or loaded from one file per page.
+	 **/
+	VirtualTexture *newVirtualTexture(Data *encoded, const VirtualTexture::Settings &settings);
+	VirtualTexture *newVirtualTexture(const std::string &pattern, int width, int height, const VirtualTexture::Settings &settings);
+
 	Mesh *newMesh(const std::vector<Vertex> &vertices, PrimitiveType drawmode, vertex::Usage usage);
 	Mesh *newMesh(int vertexcount, PrimitiveType drawmode, vertex::Usage usage);
 	Mesh *newMesh(const std::vector<Mesh::AttribFormat> &vertexformat, int vertexcount, PrimitiveType drawmode, vertex::Usage usage);
@@ -498,6 +524,37 @@ class Graphics : public Module
 
 	bool validateShader(bool gles, const std::string &vertex, const std::string &pixel, std::string &err);
 
+	/**
+	 * When enabled, glslang validation of new shader stages runs on a
+	 * background thread while the driver compiles them.
+	 **/
+	void setShaderValidationDeferred(bool deferred);
+	bool isShaderValidationDeferred() const;
+
+	/**
+	 * Queues pixel data to be copied into an Image without stalling. Queued
+	 * uploads are staged and sent to the GPU at the end of each frame, and
+	 * large ones are split across frames to stay within the upload budget.
+	 **/
+	virtual void queueTextureUpload(Image *image, love::image::ImageDataBase *data, int level, int slice, int x, int y) = 0;
+
+	/**
+	 * Sets the maximum number of bytes of queued texture uploads which are
+	 * sent to the GPU per frame. At least one row is always uploaded.
+	 **/
+	void setTextureUploadBudget(size_t bytes);
+	size_t getTextureUploadBudget() const;
+
+	bool isShaderValidationCached(const std::string &key) const;
+	void addShaderValidationCacheEntry(const std::string &key);
+
+	/**
+	 * Serializes the keys of all shader stages and programs which have passed
+	 * validation, so they can be skipped when loaded again in a later run.
+	 **/
+	std::string getShaderValidationCacheData() const;
+	bool loadShaderValidationCacheData(const char *data, size_t size);
+
 	/**
 	 * Resets the current color, background color, line style, and so forth.
 	 **/
@@ -586,6 +643,13 @@ class Graphics : public Module
 
 	Shader *getShader() const;
 
+	/**
+	 * Sets the buffer used by every Shader's uniform block with the given name.
+	 * A null buffer removes it.
+	 **/
+	virtual void setUniformBuffer(const std::string &blockname, UniformBuffer *buffer) = 0;
+	virtual UniformBuffer *getUniformBuffer(const std::string &blockname) const = 0;
+
 	void setCanvas(RenderTarget rt, uint32 temporaryRTFlags);
 	void setCanvas(const RenderTargets &rts);
 	void setCanvas(const RenderTargetsStrongRef &rts);
@@ -1007,14 +1071,14 @@ class Graphics : public Module
 		{}
 	};
 
-	virtual ShaderStage *newShaderStageInternal(ShaderStage::StageType stage, const std::string &cachekey, const std::string &source, bool gles) = 0;
-	virtual Shader *newShaderInternal(ShaderStage *vertex, ShaderStage *pixel) = 0;
+	virtual ShaderStage *newShaderStageInternal(ShaderStage::StageType stage, const std::string &cachekey, const std::string &source, bool gles, bool deferValidation) = 0;
+	virtual Shader *newShaderInternal(ShaderStage *vertex, ShaderStage *pixel, bool async) = 0;
 	virtual StreamBuffer *newStreamBuffer(BufferType type, size_t size) = 0;
 
 	virtual void setCanvasInternal(const RenderTargets &rts, int w, int h, int pixelw, int pixelh, bool hasSRGBcanvas) = 0;
 
 	virtual void initCapabilities() = 0;
-	virtual void getAPIStats(int &shaderswitches) const = 0;
+	virtual void getAPIStats(int &shaderswitches, int &uniformupdates, int &uniformupdatesskipped) const = 0;
 
 	void createQuadIndexBuffer();
 
@@ -1057,6 +1121,8 @@ class Graphics : public Module
 	int drawCalls;
 	int drawCallsBatched;
 
+	size_t textureUploadBudget;
+
 	Buffer *quadIndexBuffer;
 
 	Capabilities capabilities;
@@ -1075,6 +1141,9 @@ class Graphics : public Module
 
 	std::unordered_map<std::string, ShaderStage *> cachedShaderStages[ShaderStage::STAGE_MAX_ENUM];
 
+	std::unordered_set<std::string> shaderValidationCache;
+	bool shaderValidationDeferred;
+
 	static StringMap<DrawMode, DRAW_MAX_ENUM>::Entry drawModeEntries[];
 	static StringMap<DrawMode, DRAW_MAX_ENUM> drawModes;
 
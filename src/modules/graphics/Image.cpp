@@ -40,6 +40,8 @@ Image::Image(const Slices &data, const Settings &settings, bool validatedata)
 	, mipmapsType(settings.mipmaps ? MIPMAPS_GENERATED : MIPMAPS_NONE)
 	, sRGB(isGammaCorrect() && !settings.linear)
 	, usingDefaultTexture(false)
+	, queuedUploads(0)
+	, mipmapsQueued(false)
 {
 	if (validatedata && data.validate() == MIPMAPS_DATA)
 		mipmapsType = MIPMAPS_DATA;
@@ -114,6 +116,14 @@ void Image::init(PixelFormat fmt, int w, int h, const Settings &settings)
 
 void Image::uploadImageData(love::image::ImageDataBase *d, int level, int slice, int x, int y)
 {
+	if (settings.deferred && !isPixelFormatCompressed(d->getFormat()))
+	{
+		Graphics *gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+		gfx->queueTextureUpload(this, d, level, slice, x, y);
+		queuedUploads++;
+		return;
+	}
+
 	love::image::ImageData *id = dynamic_cast<love::image::ImageData *>(d);
 
 	love::thread::EmptyLock lock;
@@ -174,7 +184,7 @@ void Image::replacePixels(love::image::ImageDataBase *d, int slice, int mipmap,
 	uploadImageData(d, mipmap, slice, x, y);
 
 	if (reloadmipmaps && mipmap == 0 && getMipmapCount() > 1)
-		generateMipmaps();
+		updateMipmaps();
 }
 
 void Image::replacePixels(const void *data, size_t size, int slice, int mipmap, const Rect &rect, bool reloadmipmaps)
@@ -202,6 +212,37 @@ Image::MipmapsType Image::getMipmapsType() const
 	return mipmapsType;
 }
 
+bool Image::isReady() const
+{
+	return queuedUploads == 0;
+}
+
+void Image::finishQueuedUpload()
+{
+	if (queuedUploads > 0)
+		queuedUploads--;
+
+	if (queuedUploads == 0 && mipmapsQueued)
+	{
+		mipmapsQueued = false;
+		generateMipmaps();
+	}
+}
+
+void Image::updateMipmaps()
+{
+	if (queuedUploads > 0)
+		mipmapsQueued = true;
+	else
+		generateMipmaps();
+}
+
+void Image::resetQueuedUploads()
+{
+	queuedUploads = 0;
+	mipmapsQueued = false;
+}
+
 Image::Slices::Slices(TextureType textype)
 	: textureType(textype)
 {
@@ -391,6 +432,7 @@ StringMap<Image::SettingType, Image::SETTING_MAX_ENUM>::Entry Image::settingType
 	{ "mipmaps",  SETTING_MIPMAPS   },
 	{ "linear",   SETTING_LINEAR    },
 	{ "dpiscale", SETTING_DPI_SCALE },
+	{ "deferred", SETTING_DEFERRED  },
 };
 
 StringMap<Image::SettingType, Image::SETTING_MAX_ENUM> Image::settingTypes(Image::settingTypeEntries, sizeof(Image::settingTypeEntries));
@@ -51,6 +51,7 @@ class Image : public Texture
 		SETTING_MIPMAPS,
 		SETTING_LINEAR,
 		SETTING_DPI_SCALE,
+		SETTING_DEFERRED,
 		SETTING_MAX_ENUM
 	};
 
@@ -59,6 +60,10 @@ class Image : public Texture
 		bool mipmaps = false;
 		bool linear = false;
 		float dpiScale = 1.0f;
+
+		// Upload pixel data through the Graphics upload queue rather than
+		// immediately. Ignored for compressed formats.
+		bool deferred = false;
 	};
 
 	struct Slices
@@ -100,6 +105,19 @@ class Image : public Texture
 	bool isCompressed() const;
 	MipmapsType getMipmapsType() const;
 
+	/**
+	 * Gets whether all of the Image's pixel data has been sent to the GPU.
+	 * Only deferred Images can be drawn before they're ready, in which case
+	 * the parts which haven't arrived yet have undefined contents.
+	 **/
+	bool isReady() const;
+
+	/**
+	 * Called by the upload queue once one of this Image's queued uploads has
+	 * been sent to the GPU in full.
+	 **/
+	void finishQueuedUpload();
+
 	static int imageCount;
 
 	static bool getConstant(const char *in, SettingType &out);
@@ -117,6 +135,13 @@ class Image : public Texture
 
 	virtual void generateMipmaps() = 0;
 
+	// Generates mipmaps now, or once queued uploads have finished.
+	void updateMipmaps();
+
+	// Drops the bookkeeping for queued uploads, which the Graphics module
+	// discards when the texture is unloaded.
+	void resetQueuedUploads();
+
 	// The settings used to initialize this Image.
 	Settings settings;
 
@@ -129,6 +154,9 @@ class Image : public Texture
 	// back to a default texture.
 	bool usingDefaultTexture;
 
+	int queuedUploads;
+	bool mipmapsQueued;
+
 private:
 
 	Image(const Slices &data, const Settings &settings, bool validatedata);
@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "Readback.h"
+#include "common/Exception.h"
+
+namespace love
+{
+namespace graphics
+{
+
+love::Type Readback::type("Readback", &Object::type);
+
+Readback::Readback(love::image::ImageData *data)
+	: imageData(data)
+	, complete(false)
+{
+}
+
+Readback::~Readback()
+{
+}
+
+bool Readback::checkUpdate(bool wait)
+{
+	if (!error.empty())
+		throw love::Exception("%s", error.c_str());
+
+	try
+	{
+		return update(wait);
+	}
+	catch (love::Exception &e)
+	{
+		error = e.what();
+		throw;
+	}
+}
+
+bool Readback::isComplete()
+{
+	if (!complete)
+		complete = checkUpdate(false);
+
+	return complete;
+}
+
+love::image::ImageData *Readback::wait()
+{
+	if (!complete)
+		complete = checkUpdate(true);
+
+	return imageData;
+}
+
+love::image::ImageData *Readback::getImageData() const
+{
+	return complete ? imageData.get() : nullptr;
+}
+
+} // graphics
+} // love
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "common/Object.h"
+#include "image/ImageData.h"
+
+// C++
+#include <string>
+
+namespace love
+{
+namespace graphics
+{
+
+/**
+ * Pixels being copied from GPU memory into an ImageData in the background.
+ * The copy completes once the GPU has caught up with the commands issued
+ * before the readback was requested.
+ **/
+class Readback : public Object
+{
+public:
+
+	static love::Type type;
+
+	Readback(love::image::ImageData *data);
+	virtual ~Readback();
+
+	/**
+	 * Gets whether the pixels have arrived, without blocking. The ImageData
+	 * is filled in by the first call which finds that they have. Throws if
+	 * reading them back failed, on this and every later call.
+	 **/
+	bool isComplete();
+
+	/**
+	 * Blocks until the pixels have arrived. Throws if reading them back
+	 * failed.
+	 **/
+	love::image::ImageData *wait();
+
+	/**
+	 * Gets the ImageData, or null if it hasn't been filled in yet.
+	 **/
+	love::image::ImageData *getImageData() const;
+
+protected:
+
+	/**
+	 * Copies the pixels into the ImageData if they're available (or always,
+	 * when 'wait' is true.) Returns whether that has happened.
+	 **/
+	virtual bool update(bool wait) = 0;
+
+	StrongRef<love::image::ImageData> imageData;
+	bool complete;
+
+private:
+
+	bool checkUpdate(bool wait);
+
+	// Set if update() failed. The ImageData is never filled in after that.
+	std::string error;
+
+}; // Readback
+
+} // graphics
+} // love
@@ -22,6 +22,7 @@
 #include "Shader.h"
 #include "Graphics.h"
 #include "math/MathModule.h"
+#include "thread/threads.h"
 
 // glslang
 #include "libraries/glslang/glslang/Public/ShaderLang.h"
@@ -36,22 +37,31 @@ namespace graphics
 
 love::Type Shader::type("Shader", &Object::type);
 
+// glslang modifies a stage's shader object when it's parsed or linked, and
+// stages can be shared by programs which are validated on different threads.
+static love::thread::Mutex *glslangMutex = nullptr;
+
 Shader *Shader::current = nullptr;
 Shader *Shader::standardShaders[Shader::STANDARD_MAX_ENUM] = {nullptr};
 
-Shader::Shader(ShaderStage *vertex, ShaderStage *pixel)
+Shader::Shader(ShaderStage *vertex, ShaderStage *pixel, bool async)
 	: stages()
+	, stagesValidated(false)
 {
-	std::string err;
-	if (!validate(vertex, pixel, err))
-		throw love::Exception("%s", err.c_str());
-
 	stages[ShaderStage::STAGE_VERTEX] = vertex;
 	stages[ShaderStage::STAGE_PIXEL] = pixel;
+
+	// Async shaders are validated once their stages' background work is done.
+	if (!async)
+		validateStages();
 }
 
 Shader::~Shader()
 {
+	// The task uses the glslang mutex, which Graphics destroys.
+	if (validationTask.get() != nullptr)
+		validationTask->wait();
+
 	for (int i = 0; i < STANDARD_MAX_ENUM; i++)
 	{
 		if (this == standardShaders[i])
@@ -62,6 +72,107 @@ Shader::~Shader()
 		attachDefault(STANDARD_DEFAULT);
 }
 
+void Shader::validateStages()
+{
+	if (stagesValidated)
+		return;
+
+	if (!validationError.empty())
+		throw love::Exception("%s", validationError.c_str());
+
+	if (validationTask.get() != nullptr)
+	{
+		validationTask->wait();
+
+		StrongRef<ValidationTask> task = validationTask;
+		validationTask.set(nullptr);
+
+		if (task->hasError())
+		{
+			validationError = task->getError();
+			throw love::Exception("%s", validationError.c_str());
+		}
+
+		auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+		if (gfx != nullptr && !validationKey.empty())
+			gfx->addShaderValidationCacheEntry(validationKey);
+	}
+	else
+	{
+		std::string err;
+		if (!validate(stages[ShaderStage::STAGE_VERTEX], stages[ShaderStage::STAGE_PIXEL], err))
+			throw love::Exception("%s", err.c_str());
+	}
+
+	stagesValidated = true;
+}
+
+bool Shader::isValidationFinished()
+{
+	if (stagesValidated || !validationError.empty())
+		return true;
+
+	if (validationTask.get() != nullptr)
+		return validationTask->isFinished();
+
+	for (const auto &stage : stages)
+	{
+		if (stage.get() != nullptr && !stage->isValidationFinished())
+			return false;
+	}
+
+	ShaderStage *vertex = stages[ShaderStage::STAGE_VERTEX];
+	ShaderStage *pixel = stages[ShaderStage::STAGE_PIXEL];
+
+	try
+	{
+		// The stages' tasks are done, so these only collect their results.
+		if (vertex != nullptr)
+			vertex->waitForValidation();
+
+		if (pixel != nullptr)
+			pixel->waitForValidation();
+	}
+	catch (love::Exception &e)
+	{
+		// Reported by validateStages.
+		validationError = e.what();
+		return true;
+	}
+
+	validationKey = getValidationCacheKey(vertex, pixel);
+
+	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+	if (gfx != nullptr && !validationKey.empty() && gfx->isShaderValidationCached(validationKey))
+	{
+		stagesValidated = true;
+		return true;
+	}
+
+	validationTask.set(new ValidationTask(vertex, pixel), Acquire::NORETAIN);
+	love::thread::WorkerPool::getInstance().submit(validationTask);
+
+	return false;
+}
+
+void Shader::ValidationTask::run()
+{
+	std::string err;
+	if (!linkProgram(vertex, pixel, err))
+		throw love::Exception("%s", err.c_str());
+}
+
+void Shader::setFallback(Shader *fallback)
+{
+	for (Shader *s = fallback; s != nullptr; s = s->getFallback())
+	{
+		if (s == this)
+			throw love::Exception("A Shader cannot be its own fallback.");
+	}
+
+	this->fallback.set(fallback);
+}
+
 void Shader::attachDefault(StandardShader defaultType)
 {
 	Shader *defaultshader = standardShaders[defaultType];
@@ -128,6 +239,44 @@ void Shader::checkMainTexture(Texture *tex) const
 
 bool Shader::validate(ShaderStage *vertex, ShaderStage *pixel, std::string &err)
 {
+	if (vertex != nullptr)
+		vertex->waitForValidation();
+
+	if (pixel != nullptr)
+		pixel->waitForValidation();
+
+	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+
+	std::string programkey = getValidationCacheKey(vertex, pixel);
+
+	if (gfx != nullptr && !programkey.empty() && gfx->isShaderValidationCached(programkey))
+		return true;
+
+	if (!linkProgram(vertex, pixel, err))
+		return false;
+
+	if (gfx != nullptr && !programkey.empty())
+		gfx->addShaderValidationCacheEntry(programkey);
+
+	return true;
+}
+
+std::string Shader::getValidationCacheKey(ShaderStage *vertex, ShaderStage *pixel)
+{
+	// A program is only cacheable if all of its stages are.
+	std::string vertexkey = vertex != nullptr ? vertex->getValidationCacheKey() : "none";
+	std::string pixelkey = pixel != nullptr ? pixel->getValidationCacheKey() : "none";
+
+	if (vertexkey.empty() || pixelkey.empty())
+		return std::string();
+
+	return "program|" + vertexkey + "|" + pixelkey;
+}
+
+bool Shader::linkProgram(ShaderStage *vertex, ShaderStage *pixel, std::string &err)
+{
+	love::thread::Lock lock(glslangMutex);
+
 	glslang::TProgram program;
 
 	if (vertex != nullptr)
@@ -147,12 +296,18 @@ bool Shader::validate(ShaderStage *vertex, ShaderStage *pixel, std::string &err)
 
 bool Shader::initialize()
 {
+	if (glslangMutex == nullptr)
+		glslangMutex = love::thread::newMutex();
+
 	return glslang::InitializeProcess();
 }
 
 void Shader::deinitialize()
 {
 	glslang::FinalizeProcess();
+
+	delete glslangMutex;
+	glslangMutex = nullptr;
 }
 
 bool Shader::getConstant(const char *in, Language &out)
@@ -95,6 +95,7 @@ class Shader : public Object, public Resource
 		STANDARD_DEFAULT,
 		STANDARD_VIDEO,
 		STANDARD_ARRAY,
+		STANDARD_SDF,
 		STANDARD_MAX_ENUM
 	};
 
@@ -131,6 +132,39 @@ class Shader : public Object, public Resource
 		size_t dataSize;
 
 		Texture **textures;
+
+		// The values the backend last uploaded, used to skip redundant
+		// updates. Owned by the backend, may be null.
+		void *uploadedData;
+	};
+
+	// A variable inside a uniform block, and where it lives in the block's
+	// (std140) memory.
+	struct UniformBlockMember
+	{
+		std::string name;
+		int count;
+
+		union
+		{
+			int components;
+			MatrixSize matrix;
+		};
+
+		UniformType baseType;
+
+		size_t offset;
+		size_t arrayStride;
+		size_t matrixStride;
+		bool rowMajor;
+	};
+
+	struct UniformBlockInfo
+	{
+		std::string name;
+		int binding;
+		size_t dataSize;
+		std::vector<UniformBlockMember> members;
 	};
 
 	// Pointer to currently active Shader.
@@ -139,9 +173,37 @@ class Shader : public Object, public Resource
 	// Pointer to the default Shader.
 	static Shader *standardShaders[STANDARD_MAX_ENUM];
 
-	Shader(ShaderStage *vertex, ShaderStage *pixel);
+	Shader(ShaderStage *vertex, ShaderStage *pixel, bool async);
 	virtual ~Shader();
 
+	/**
+	 * Gets whether the Shader has finished compiling. Shaders created with
+	 * Graphics::newShaderAsync advance their compilation when this is called.
+	 * Throws if compilation failed.
+	 **/
+	virtual bool isReady() = 0;
+
+	/**
+	 * Blocks until the Shader has finished compiling. Throws if compilation
+	 * failed.
+	 **/
+	virtual void waitUntilReady() = 0;
+
+	/**
+	 * Gets the error message of a failed asynchronous compile, or an empty
+	 * string if there was none (yet). Unlike isReady, this never throws and
+	 * doesn't advance compilation.
+	 **/
+	virtual std::string getCompileError() const = 0;
+
+	/**
+	 * Sets the Shader which is used for drawing in place of this one until it
+	 * has finished compiling. If there is none, using this Shader blocks until
+	 * it's ready.
+	 **/
+	void setFallback(Shader *fallback);
+	Shader *getFallback() const { return fallback; }
+
 	/**
 	 * Binds this Shader's program to be used when rendering.
 	 **/
@@ -177,6 +239,13 @@ class Shader : public Object, public Resource
 	 **/
 	virtual bool hasUniform(const std::string &name) const = 0;
 
+	/**
+	 * Gets the layout of an active uniform block, or null if the shader has no
+	 * active block with that name. Blocks are sourced from the UniformBuffer
+	 * set for their name in Graphics.
+	 **/
+	virtual const UniformBlockInfo *getUniformBlockInfo(const std::string &name) const = 0;
+
 	/**
 	 * Sets the textures used when rendering a video. For internal use only.
 	 **/
@@ -199,10 +268,45 @@ class Shader : public Object, public Resource
 
 protected:
 
+	// Runs (or waits for) glslang validation of the stages. Throws on failure.
+	void validateStages();
+
+	// Whether validateStages won't block. Once the stages have been validated
+	// this starts linking the program with glslang on a worker thread, unless
+	// it's in the validation cache.
+	bool isValidationFinished();
+
 	StrongRef<ShaderStage> stages[ShaderStage::STAGE_MAX_ENUM];
 
+	StrongRef<Shader> fallback;
+
 private:
 
+	class ValidationTask : public love::thread::Task
+	{
+	public:
+
+		ValidationTask(ShaderStage *vertex, ShaderStage *pixel) : vertex(vertex), pixel(pixel) {}
+		virtual ~ValidationTask() {}
+
+		void run() override;
+
+	private:
+
+		StrongRef<ShaderStage> vertex;
+		StrongRef<ShaderStage> pixel;
+
+	}; // ValidationTask
+
+	static std::string getValidationCacheKey(ShaderStage *vertex, ShaderStage *pixel);
+	static bool linkProgram(ShaderStage *vertex, ShaderStage *pixel, std::string &err);
+
+	bool stagesValidated;
+
+	StrongRef<ValidationTask> validationTask;
+	std::string validationKey;
+	std::string validationError;
+
 	static StringMap<Language, LANGUAGE_MAX_ENUM>::Entry languageEntries[];
 	static StringMap<Language, LANGUAGE_MAX_ENUM> languages;
 	
@@ -21,6 +21,7 @@
 #include "ShaderStage.h"
 #include "common/Exception.h"
 #include "Graphics.h"
+#include "data/DataModule.h"
 
 #include "libraries/glslang/glslang/Public/ShaderLang.h"
 
@@ -136,29 +137,66 @@ namespace love
 namespace graphics
 {
 
-ShaderStage::ShaderStage(Graphics *gfx, StageType stage, const std::string &glsl, bool gles, const std::string &cachekey)
+ShaderStage::ShaderStage(Graphics *gfx, StageType stage, const std::string &glsl, bool gles, const std::string &cachekey, bool deferValidation)
 	: stageType(stage)
 	, source(glsl)
 	, cacheKey(cachekey)
+	, gles(gles)
+	, supportsGLSL3(gfx->getCapabilities().features[Graphics::FEATURE_GLSL3])
 	, glslangShader(nullptr)
 {
-	EShLanguage glslangStage = EShLangCount;
-	if (stage == STAGE_VERTEX)
-		glslangStage = EShLangVertex;
-	else if (stage == STAGE_PIXEL)
-		glslangStage = EShLangFragment;
-	else
+	if (stage != STAGE_VERTEX && stage != STAGE_PIXEL)
 		throw love::Exception("Cannot compile shader stage: unknown stage type.");
 
-	glslangShader = new glslang::TShader(glslangStage);
+	std::string validationkey = getValidationCacheKey();
+
+	// Sources which validated in a previous run don't need to go through the
+	// glslang front-end again, unless the whole program has to be linked.
+	if (!validationkey.empty() && gfx->isShaderValidationCached(validationkey))
+		return;
+
+	if (!validationkey.empty() && (deferValidation || gfx->isShaderValidationDeferred()))
+	{
+		// The driver compile in the backend's constructor overlaps with this.
+		validationTask.set(new ValidationTask(this), Acquire::NORETAIN);
+		love::thread::WorkerPool::getInstance().submit(validationTask);
+		return;
+	}
+
+	parse();
+
+	if (!validationkey.empty())
+		gfx->addShaderValidationCacheEntry(validationkey);
+}
+
+ShaderStage::~ShaderStage()
+{
+	// The task refers to this stage, so it can't outlive it.
+	if (validationTask.get() != nullptr)
+		validationTask->wait();
+
+	if (!cacheKey.empty())
+	{
+		auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+		if (gfx != nullptr)
+			gfx->cleanupCachedShaderStage(stageType, cacheKey);
+	}
+
+	delete glslangShader;
+}
+
+void ShaderStage::parse()
+{
+	EShLanguage glslangStage = stageType == STAGE_VERTEX ? EShLangVertex : EShLangFragment;
+
+	glslang::TShader *shader = new glslang::TShader(glslangStage);
 
-	bool supportsGLSL3 = gfx->getCapabilities().features[Graphics::FEATURE_GLSL3];
 	int defaultversion = gles ? 100 : 120;
 	EProfile defaultprofile = ENoProfile;
 
-	const char *csrc = glsl.c_str();
-	int srclen = (int) glsl.length();
-	glslangShader->setStringsWithLengths(&csrc, &srclen, 1);
+	const char *csrc = source.c_str();
+	int srclen = (int) source.length();
+	shader->setStringsWithLengths(&csrc, &srclen, 1);
 
 	bool forcedefault = false;
 	if (source.find("#define LOVE_GLSL1_ON_GLSL3") != std::string::npos)
@@ -166,30 +204,90 @@ ShaderStage::ShaderStage(Graphics *gfx, StageType stage, const std::string &glsl
 
 	bool forwardcompat = supportsGLSL3 && !forcedefault;
 
-	if (!glslangShader->parse(&defaultTBuiltInResource, defaultversion, defaultprofile, forcedefault, forwardcompat, EShMsgSuppressWarnings))
+	if (!shader->parse(&defaultTBuiltInResource, defaultversion, defaultprofile, forcedefault, forwardcompat, EShMsgSuppressWarnings))
 	{
 		const char *stagename = "unknown";
-		getConstant(stage, stagename);
+		getConstant(stageType, stagename);
 
 		std::string err = "Error validating " + std::string(stagename) + " shader:\n\n"
-			+ std::string(glslangShader->getInfoLog()) + "\n"
-			+ std::string(glslangShader->getInfoDebugLog());
+			+ std::string(shader->getInfoLog()) + "\n"
+			+ std::string(shader->getInfoDebugLog());
 
-		delete glslangShader;
+		delete shader;
 		throw love::Exception("%s", err.c_str());
 	}
+
+	glslangShader = shader;
 }
 
-ShaderStage::~ShaderStage()
+void ShaderStage::waitForValidation()
 {
-	if (!cacheKey.empty())
-	{
-		auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
-		if (gfx != nullptr)
-			gfx->cleanupCachedShaderStage(stageType, cacheKey);
-	}
+	if (validationTask.get() == nullptr)
+		return;
 
-	delete glslangShader;
+	validationTask->wait();
+
+	StrongRef<ValidationTask> task = validationTask;
+	validationTask.set(nullptr);
+
+	if (task->hasError())
+		throw love::Exception("%s", task->getError().c_str());
+
+	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+	if (gfx != nullptr)
+		gfx->addShaderValidationCacheEntry(getValidationCacheKey());
+}
+
+void ShaderStage::removeFromCache()
+{
+	if (cacheKey.empty())
+		return;
+
+	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+	if (gfx != nullptr)
+		gfx->cleanupCachedShaderStage(stageType, cacheKey);
+
+	cacheKey.clear();
+}
+
+bool ShaderStage::isValidationFinished() const
+{
+	return validationTask.get() == nullptr || validationTask->isFinished();
+}
+
+glslang::TShader *ShaderStage::getGLSLangShader()
+{
+	waitForValidation();
+
+	if (glslangShader == nullptr)
+		parse();
+
+	return glslangShader;
+}
+
+std::string ShaderStage::getValidationCacheKey() const
+{
+	if (cacheKey.empty())
+		return std::string();
+
+	const char *stagename = "unknown";
+	getConstant(stageType, stagename);
+
+	Shader::Language language = Shader::LANGUAGE_MAX_ENUM;
+	if (gles)
+		language = supportsGLSL3 ? Shader::LANGUAGE_ESSL3 : Shader::LANGUAGE_ESSL1;
+	else
+		language = supportsGLSL3 ? Shader::LANGUAGE_GLSL3 : Shader::LANGUAGE_GLSL1;
+
+	const char *langname = "unknown";
+	Shader::getConstant(language, langname);
+
+	size_t hexlen = 0;
+	char *hex = data::encode(data::ENCODE_HEX, cacheKey.data(), cacheKey.size(), hexlen);
+	std::string key = std::string(stagename) + ":" + langname + ":" + std::string(hex, hexlen);
+	delete[] hex;
+
+	return key;
 }
 
 bool ShaderStage::getConstant(const char *in, StageType &out)
@@ -24,6 +24,7 @@
 #include "common/StringMap.h"
 #include "Volatile.h"
 #include "Resource.h"
+#include "thread/WorkerPool.h"
 
 #include <stddef.h>
 #include <string>
@@ -51,27 +52,70 @@ class ShaderStage : public love::Object, public Volatile, public Resource
 		STAGE_MAX_ENUM
 	};
 
-	ShaderStage(Graphics *gfx, StageType stage, const std::string &glsl, bool gles, const std::string &cachekey);
+	ShaderStage(Graphics *gfx, StageType stage, const std::string &glsl, bool gles, const std::string &cachekey, bool deferValidation);
 	virtual ~ShaderStage();
 
 	StageType getStageType() const { return stageType; }
 	const std::string &getSource() const { return source; }
 	const std::string &getWarnings() const { return warnings; }
-	glslang::TShader *getGLSLangShader() const { return glslangShader; }
+	const std::string &getCacheKey() const { return cacheKey; }
+
+	/**
+	 * Blocks until glslang validation running on a background thread (if any)
+	 * has finished. Throws if the source failed to validate.
+	 **/
+	void waitForValidation();
+	bool isValidationFinished() const;
+
+	/**
+	 * Parses the source with glslang if that was skipped because the stage was
+	 * found in the validation cache. Throws if the source fails to validate.
+	 **/
+	glslang::TShader *getGLSLangShader();
+
+	/**
+	 * Key identifying this stage's source and target language in the shader
+	 * validation cache, or an empty string if the stage isn't cacheable.
+	 **/
+	std::string getValidationCacheKey() const;
 
 	static bool getConstant(const char *in, StageType &out);
 	static bool getConstant(StageType in, const char *&out);
 
 protected:
 
+	// Stops Graphics from handing this stage out for new shaders with the same
+	// source, e.g. because the driver failed to compile it.
+	void removeFromCache();
+
 	std::string warnings;
 
 private:
 
+	class ValidationTask : public love::thread::Task
+	{
+	public:
+
+		ValidationTask(ShaderStage *stage) : stage(stage) {}
+		virtual ~ValidationTask() {}
+
+		void run() override { stage->parse(); }
+
+	private:
+
+		ShaderStage *stage;
+
+	}; // ValidationTask
+
+	void parse();
+
 	StageType stageType;
 	std::string source;
 	std::string cacheKey;
+	bool gles;
+	bool supportsGLSL3;
 	glslang::TShader *glslangShader;
+	StrongRef<ValidationTask> validationTask;
 
 	static StringMap<StageType, STAGE_MAX_ENUM>::Entry stageNameEntries[];
 	static StringMap<StageType, STAGE_MAX_ENUM> stageNames;
@@ -83,7 +127,7 @@ class ShaderStageForValidation final : public ShaderStage
 public:
 
 	ShaderStageForValidation(Graphics *gfx, StageType stage, const std::string &glsl, bool gles)
-		: ShaderStage(gfx, stage, glsl, gles, "")
+		: ShaderStage(gfx, stage, glsl, gles, "", false)
 	{}
 
 	virtual ~ShaderStageForValidation() {}
@@ -35,6 +35,8 @@ Text::Text(Font *font, const std::vector<Font::ColoredString> &text)
 	, vertexAttributes(Font::vertexFormat, 0)
 	, vertex_buffer(nullptr)
 	, vert_offset(0)
+	, wasted_vertices(0)
+	, draw_commands_dirty(false)
 	, texture_cache_id((uint32) -1)
 {
 	set(text);
@@ -60,7 +62,7 @@ void Text::uploadVertices(const std::vector<Font::GlyphVertex> &vertices, size_t
 			newsize = std::max(size_t(vertex_buffer->getSize() * 1.5), newsize);
 
 		auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
-		Buffer *new_buffer = gfx->newBuffer(newsize, nullptr, BUFFER_VERTEX, vertex::USAGE_DYNAMIC, 0);
+		Buffer *new_buffer = gfx->newBuffer(newsize, nullptr, BUFFER_VERTEX, vertex::USAGE_DYNAMIC, Buffer::MAP_EXPLICIT_RANGE_MODIFY);
 
 		if (vertex_buffer != nullptr)
 			vertex_buffer->copyTo(0, vertex_buffer->getSize(), new_buffer, 0);
@@ -75,92 +77,196 @@ void Text::uploadVertices(const std::vector<Font::GlyphVertex> &vertices, size_t
 	{
 		uint8 *bufferdata = (uint8 *) vertex_buffer->map();
 		memcpy(bufferdata + offset, &vertices[0], datasize);
+
 		// We unmap when we draw, to avoid unnecessary full map()/unmap() calls.
+		// Only the ranges written since then are uploaded.
+		vertex_buffer->setMappedRangeModified(offset, datasize);
 	}
 }
 
 void Text::regenerateVertices()
 {
-	// If the font's texture cache was invalidated then we need to recreate the
-	// text's vertices, since glyph texcoords might have changed.
-	if (font->getTextureCacheID() != texture_cache_id)
+	// All entries share one glyph use, so atlas eviction can't drop one
+	// entry's glyphs to make room for the next one's. Otherwise a Text whose
+	// glyphs don't fit the atlas budget would invalidate the cache forever.
+	font->beginGlyphUse();
+
+	try
 	{
-		std::vector<TextData> textdata = text_data;
+		// If the font's texture cache was invalidated then we need to recreate
+		// the text's vertices, since glyph texcoords might have changed.
+		// Generating them can invalidate the cache again if the font has to
+		// add glyphs, but once they're all in the atlas a second pass can't.
+		while (font->getTextureCacheID() != texture_cache_id)
+		{
+			texture_cache_id = font->getTextureCacheID();
 
-		clear();
+			// Entries are packed back-to-back again, which also reclaims the
+			// space setAt left behind. The vertex buffer itself is reused.
+			vert_offset = 0;
+			wasted_vertices = 0;
 
-		for (const TextData &t : textdata)
-			addTextData(t);
+			std::vector<Font::GlyphVertex> vertices;
 
-		texture_cache_id = font->getTextureCacheID();
+			for (TextData &t : text_data)
+			{
+				generateTextData(t, vertices);
+				uploadTextData(t, vert_offset, vertices);
+				t.vertex_capacity = t.vertex_count;
+				vert_offset += t.vertex_count;
+			}
+
+			draw_commands_dirty = true;
+		}
+	}
+	catch (...)
+	{
+		font->endGlyphUse();
+		throw;
 	}
+
+	font->endGlyphUse();
 }
 
-void Text::addTextData(const TextData &t)
+void Text::generateTextData(TextData &t, std::vector<Font::GlyphVertex> &vertices)
 {
-	std::vector<Font::GlyphVertex> vertices;
-	std::vector<Font::DrawCommand> new_commands;
-
-	Font::TextInfo text_info;
+	vertices.clear();
 
 	Colorf constantcolor = Colorf(1.0f, 1.0f, 1.0f, 1.0f);
 
 	// We only have formatted text if the align mode is valid.
 	if (t.align == Font::ALIGN_MAX_ENUM)
-		new_commands = font->generateVertices(t.codepoints, constantcolor, vertices, 0.0f, Vector2(0.0f, 0.0f), &text_info);
+		t.commands = font->generateVertices(t.codepoints, constantcolor, vertices, 0.0f, Vector2(0.0f, 0.0f), &t.text_info);
 	else
-		new_commands = font->generateVerticesFormatted(t.codepoints, constantcolor, t.wrap, t.align, vertices, &text_info);
-
-	size_t voffset = vert_offset;
-
-	if (!t.append_vertices)
-	{
-		voffset = 0;
-		vert_offset = 0;
-		draw_commands.clear();
-		text_data.clear();
-	}
+		t.commands = font->generateVerticesFormatted(t.codepoints, constantcolor, t.wrap, t.align, vertices, &t.text_info);
 
 	if (t.use_matrix && !vertices.empty())
 		t.matrix.transformXY(vertices.data(), vertices.data(), (int) vertices.size());
 
-	uploadVertices(vertices, voffset);
+	t.vertex_count = vertices.size();
+}
 
-	if (!new_commands.empty())
-	{
-		// The start vertex should be adjusted to account for the vertex offset.
-		for (Font::DrawCommand &cmd : new_commands)
-			cmd.startvertex += (int) voffset;
+void Text::uploadTextData(TextData &t, size_t vertexstart, const std::vector<Font::GlyphVertex> &vertices)
+{
+	uploadVertices(vertices, vertexstart);
+
+	// The start vertex should be adjusted to account for the vertex offset.
+	for (Font::DrawCommand &cmd : t.commands)
+		cmd.startvertex += (int) vertexstart;
+
+	t.vertex_start = vertexstart;
+}
 
-		auto firstcmd = new_commands.begin();
+void Text::appendDrawCommands(const std::vector<Font::DrawCommand> &commands)
+{
+	if (commands.empty())
+		return;
+
+	auto firstcmd = commands.begin();
 
-		// If the first draw command in the new list has the same texture as the
-		// last one in the existing list we're building and its vertices are
-		// in-order, we can combine them (saving a draw call.)
-		if (!draw_commands.empty())
+	// If the first draw command in the new list has the same texture as the
+	// last one in the existing list we're building and its vertices are
+	// in-order, we can combine them (saving a draw call.)
+	if (!draw_commands.empty())
+	{
+		auto prevcmd = draw_commands.back();
+		if (prevcmd.texture == firstcmd->texture && (prevcmd.startvertex + prevcmd.vertexcount) == firstcmd->startvertex)
 		{
-			auto prevcmd = draw_commands.back();
-			if (prevcmd.texture == firstcmd->texture && (prevcmd.startvertex + prevcmd.vertexcount) == firstcmd->startvertex)
-			{
-				draw_commands.back().vertexcount += firstcmd->vertexcount;
-				++firstcmd;
-			}
+			draw_commands.back().vertexcount += firstcmd->vertexcount;
+			++firstcmd;
 		}
-
-		// Append the new draw commands to the list we're building.
-		draw_commands.insert(draw_commands.end(), firstcmd, new_commands.end());
 	}
 
-	vert_offset = voffset + vertices.size();
+	// Append the new draw commands to the list we're building.
+	draw_commands.insert(draw_commands.end(), firstcmd, commands.end());
+}
+
+void Text::rebuildDrawCommands()
+{
+	draw_commands.clear();
+
+	for (const TextData &t : text_data)
+		appendDrawCommands(t.commands);
+
+	draw_commands_dirty = false;
+}
+
+void Text::addTextData(const TextData &t)
+{
+	if (!t.append_vertices)
+		clear();
 
 	text_data.push_back(t);
-	text_data.back().text_info = text_info;
+	TextData &data = text_data.back();
+
+	// New entries go at the end, so only their own vertices are uploaded.
+	std::vector<Font::GlyphVertex> vertices;
+	generateTextData(data, vertices);
+	uploadTextData(data, vert_offset, vertices);
+
+	data.vertex_capacity = data.vertex_count;
+	vert_offset += data.vertex_count;
+
+	if (!draw_commands_dirty)
+		appendDrawCommands(data.commands);
 
 	// Font::generateVertices can invalidate the font's texture cache.
 	if (font->getTextureCacheID() != texture_cache_id)
 		regenerateVertices();
 }
 
+void Text::setTextData(int index, const TextData &t)
+{
+	if (index < 0 || index >= (int) text_data.size())
+		throw love::Exception("Invalid Text index: %d", index + 1);
+
+	TextData &data = text_data[index];
+
+	size_t oldstart = data.vertex_start;
+	size_t oldcapacity = data.vertex_capacity;
+
+	// The unused end of the entry's old range was already counted as wasted.
+	wasted_vertices -= oldcapacity - data.vertex_count;
+
+	data = t;
+
+	std::vector<Font::GlyphVertex> vertices;
+	generateTextData(data, vertices);
+
+	if (data.vertex_count <= oldcapacity)
+	{
+		// Fits in the entry's existing range.
+		uploadTextData(data, oldstart, vertices);
+		data.vertex_capacity = oldcapacity;
+		wasted_vertices += oldcapacity - data.vertex_count;
+	}
+	else if (oldstart + oldcapacity == vert_offset)
+	{
+		// The last entry in the buffer can just grow.
+		uploadTextData(data, oldstart, vertices);
+		data.vertex_capacity = data.vertex_count;
+		vert_offset = oldstart + data.vertex_count;
+	}
+	else
+	{
+		// Otherwise the entry moves to the end of the buffer, and its old range
+		// is left unused until the next full regeneration.
+		uploadTextData(data, vert_offset, vertices);
+		data.vertex_capacity = data.vertex_count;
+		vert_offset += data.vertex_count;
+		wasted_vertices += oldcapacity;
+	}
+
+	draw_commands_dirty = true;
+
+	// Rebuild everything once more vertices are wasted than used.
+	if (wasted_vertices > vert_offset / 2)
+		texture_cache_id = (uint32) -1;
+
+	if (font->getTextureCacheID() != texture_cache_id)
+		regenerateVertices();
+}
+
 void Text::set(const std::vector<Font::ColoredString> &text)
 {
 	return set(text, -1.0f, Font::ALIGN_MAX_ENUM);
@@ -192,12 +298,27 @@ int Text::addf(const std::vector<Font::ColoredString> &text, float wrap, Font::A
 	return (int) text_data.size() - 1;
 }
 
+void Text::setAt(int index, const std::vector<Font::ColoredString> &text, const Matrix4 &m)
+{
+	setfAt(index, text, -1.0f, Font::ALIGN_MAX_ENUM, m);
+}
+
+void Text::setfAt(int index, const std::vector<Font::ColoredString> &text, float wrap, Font::AlignMode align, const Matrix4 &m)
+{
+	Font::ColoredCodepoints codepoints;
+	Font::getCodepointsFromString(text, codepoints);
+
+	setTextData(index, {codepoints, wrap, align, {}, true, true, m});
+}
+
 void Text::clear()
 {
 	text_data.clear();
 	draw_commands.clear();
+	draw_commands_dirty = false;
 	texture_cache_id = font->getTextureCacheID();
 	vert_offset = 0;
+	wasted_vertices = 0;
 }
 
 void Text::setFont(Font *f)
@@ -239,13 +360,13 @@ int Text::getHeight(int index) const
 
 void Text::draw(Graphics *gfx, const Matrix4 &m)
 {
-	if (vertex_buffer == nullptr || draw_commands.empty())
+	if (vertex_buffer == nullptr || (draw_commands.empty() && !draw_commands_dirty))
 		return;
 
 	gfx->flushStreamDraws();
 
 	if (Shader::isDefaultActive())
-		Shader::attachDefault(Shader::STANDARD_DEFAULT);
+		Shader::attachDefault(font->isSDF() ? Shader::STANDARD_SDF : Shader::STANDARD_DEFAULT);
 
 	if (Shader::current)
 		Shader::current->checkMainTextureType(TEXTURE_2D, false);
@@ -254,6 +375,11 @@ void Text::draw(Graphics *gfx, const Matrix4 &m)
 	if (font->getTextureCacheID() != texture_cache_id)
 		regenerateVertices();
 
+	if (draw_commands_dirty)
+		rebuildDrawCommands();
+
+	font->uploadGlyphs();
+
 	int totalverts = 0;
 	for (const Font::DrawCommand &cmd : draw_commands)
 		totalverts = std::max(cmd.startvertex + cmd.vertexcount, totalverts);
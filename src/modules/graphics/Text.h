@@ -48,6 +48,13 @@ class Text : public Drawable
 	int add(const std::vector<Font::ColoredString> &text, const Matrix4 &m);
 	int addf(const std::vector<Font::ColoredString> &text, float wrap, Font::AlignMode align, const Matrix4 &m);
 
+	/**
+	 * Replaces the text at an index previously returned by add or addf. Only
+	 * that entry's vertices are regenerated and uploaded.
+	 **/
+	void setAt(int index, const std::vector<Font::ColoredString> &text, const Matrix4 &m);
+	void setfAt(int index, const std::vector<Font::ColoredString> &text, float wrap, Font::AlignMode align, const Matrix4 &m);
+
 	void clear();
 
 	void setFont(Font *f);
@@ -77,11 +84,23 @@ class Text : public Drawable
 		bool use_matrix;
 		bool append_vertices;
 		Matrix4 matrix;
+
+		// The entry's range in the vertex buffer. The capacity can be larger
+		// than the vertex count once the entry has been replaced with setAt.
+		size_t vertex_start;
+		size_t vertex_count;
+		size_t vertex_capacity;
+		std::vector<Font::DrawCommand> commands;
 	};
 
 	void uploadVertices(const std::vector<Font::GlyphVertex> &vertices, size_t vertoffset);
 	void regenerateVertices();
 	void addTextData(const TextData &s);
+	void setTextData(int index, const TextData &t);
+	void generateTextData(TextData &t, std::vector<Font::GlyphVertex> &vertices);
+	void uploadTextData(TextData &t, size_t vertexstart, const std::vector<Font::GlyphVertex> &vertices);
+	void appendDrawCommands(const std::vector<Font::DrawCommand> &commands);
+	void rebuildDrawCommands();
 
 	StrongRef<Font> font;
 
@@ -95,7 +114,12 @@ class Text : public Drawable
 	std::vector<TextData> text_data;
 
 	size_t vert_offset;
-	
+
+	// Vertices left unused by entries which setAt moved to the end.
+	size_t wasted_vertices;
+
+	bool draw_commands_dirty;
+
 	// Used so we know when the font's texture cache is invalidated.
 	uint32 texture_cache_id;
 	
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "UniformBuffer.h"
+#include "Graphics.h"
+#include "common/Exception.h"
+
+// C++
+#include <algorithm>
+#include <vector>
+
+// C
+#include <cstring>
+#include <cstdlib>
+
+namespace love
+{
+namespace graphics
+{
+
+love::Type UniformBuffer::type("UniformBuffer", &Object::type);
+
+UniformBuffer::UniformBuffer(Graphics *gfx, const Shader::UniformBlockInfo &block, vertex::Usage usage)
+	: blockName(block.name)
+	, buffer(nullptr)
+{
+	if (block.dataSize == 0)
+		throw love::Exception("Uniform block '%s' has no data.", block.name.c_str());
+
+	std::vector<char> zeroes(block.dataSize, 0);
+	buffer = gfx->newBuffer(block.dataSize, zeroes.data(), BUFFER_UNIFORM, usage, Buffer::MAP_EXPLICIT_RANGE_MODIFY);
+
+	for (const Shader::UniformBlockMember &layout : block.members)
+	{
+		// Samplers and other opaque types can't be in uniform blocks.
+		if (layout.baseType == Shader::UNIFORM_SAMPLER || layout.baseType == Shader::UNIFORM_UNKNOWN)
+			continue;
+
+		Member m;
+		m.layout = layout;
+
+		Shader::UniformInfo &u = m.info;
+		u.location = -1;
+		u.count = std::max(layout.count, 1);
+		u.baseType = layout.baseType;
+		u.textureType = TEXTURE_2D;
+		u.isDepthSampler = false;
+		u.name = layout.name;
+		u.textures = nullptr;
+		u.uploadedData = nullptr;
+
+		// Every scalar type which can be in a block is 4 bytes.
+		if (u.baseType == Shader::UNIFORM_MATRIX)
+		{
+			u.matrix = layout.matrix;
+			u.dataSize = sizeof(float) * u.matrix.columns * u.matrix.rows * u.count;
+		}
+		else
+		{
+			u.components = layout.components;
+			u.dataSize = sizeof(float) * u.components * u.count;
+		}
+
+		u.data = malloc(u.dataSize);
+		if (u.data == nullptr)
+			throw love::Exception("Out of memory.");
+
+		memset(u.data, 0, u.dataSize);
+
+		members[u.name] = m;
+	}
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	delete buffer;
+
+	for (const auto &p : members)
+		free(p.second.info.data);
+}
+
+const Shader::UniformInfo *UniformBuffer::getUniformInfo(const std::string &name) const
+{
+	const auto it = members.find(name);
+
+	if (it == members.end())
+		return nullptr;
+
+	return &(it->second.info);
+}
+
+bool UniformBuffer::hasUniform(const std::string &name) const
+{
+	return members.find(name) != members.end();
+}
+
+char *UniformBuffer::beginWrite(size_t offset, size_t size)
+{
+	if (offset + size > buffer->getSize())
+		throw love::Exception("Cannot write outside of the uniform buffer's memory.");
+
+	// Draws batched before this point must see the old contents. Flushing
+	// them also uploads (and unmaps) anything written before they were queued.
+	Graphics::flushStreamDrawsGlobal();
+
+	char *mem = (char *) buffer->map();
+	buffer->setMappedRangeModified(offset, size);
+	return mem;
+}
+
+void UniformBuffer::updateUniform(const Shader::UniformInfo *info, int count)
+{
+	const auto it = members.find(info->name);
+	if (it == members.end() || &it->second.info != info)
+		throw love::Exception("Uniform '%s' is not part of this uniform buffer.", info->name.c_str());
+
+	const Shader::UniformBlockMember &layout = it->second.layout;
+
+	count = std::min(std::max(count, 1), info->count);
+
+	// Size of the last element, so the modified range doesn't run past the
+	// end of arrays which are at the end of the block.
+	size_t elementsize = 0;
+	if (info->baseType == Shader::UNIFORM_MATRIX)
+	{
+		if (layout.rowMajor)
+			elementsize = layout.matrixStride * (info->matrix.rows - 1) + sizeof(float) * info->matrix.columns;
+		else
+			elementsize = layout.matrixStride * (info->matrix.columns - 1) + sizeof(float) * info->matrix.rows;
+	}
+	else
+		elementsize = sizeof(float) * info->components;
+
+	size_t size = layout.arrayStride * (count - 1) + elementsize;
+	char *mem = beginWrite(layout.offset, size) + layout.offset;
+
+	for (int i = 0; i < count; i++)
+	{
+		char *dst = mem + layout.arrayStride * i;
+
+		if (info->baseType == Shader::UNIFORM_MATRIX)
+		{
+			int columns = info->matrix.columns;
+			int rows = info->matrix.rows;
+			const float *src = info->floats + (columns * rows) * i;
+
+			// Our copy is column-major with tightly packed columns, std140
+			// pads each column (or row) out to a vec4.
+			for (int column = 0; column < columns; column++)
+			{
+				if (layout.rowMajor)
+				{
+					for (int row = 0; row < rows; row++)
+						memcpy(dst + layout.matrixStride * row + sizeof(float) * column, &src[column * rows + row], sizeof(float));
+				}
+				else
+					memcpy(dst + layout.matrixStride * column, &src[column * rows], sizeof(float) * rows);
+			}
+		}
+		else
+		{
+			const char *src = (const char *) info->data + elementsize * i;
+			memcpy(dst, src, elementsize);
+		}
+	}
+}
+
+void UniformBuffer::setData(size_t offset, size_t size, const void *data)
+{
+	char *mem = beginWrite(offset, size);
+	memcpy(mem + offset, data, size);
+}
+
+void UniformBuffer::flush()
+{
+	if (buffer->isMapped())
+		buffer->unmap();
+}
+
+} // graphics
+} // love
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "common/Object.h"
+#include "Shader.h"
+#include "Buffer.h"
+#include "vertex.h"
+
+// STL
+#include <string>
+#include <map>
+
+namespace love
+{
+namespace graphics
+{
+
+class Graphics;
+
+/**
+ * GPU memory backing a std140 uniform block. Values are written into a
+ * client-side copy and the modified range is uploaded in a single buffer
+ * update before the next draw which uses it.
+ **/
+class UniformBuffer : public Object
+{
+public:
+
+	static love::Type type;
+
+	UniformBuffer(Graphics *gfx, const Shader::UniformBlockInfo &block, vertex::Usage usage);
+	virtual ~UniformBuffer();
+
+	const std::string &getBlockName() const { return blockName; }
+	size_t getSize() const { return buffer->getSize(); }
+
+	/**
+	 * Gets the tightly packed staging values of a block member, which can be
+	 * filled the same way as a Shader uniform before calling updateUniform.
+	 **/
+	const Shader::UniformInfo *getUniformInfo(const std::string &name) const;
+	bool hasUniform(const std::string &name) const;
+
+	/**
+	 * Copies the first 'count' values of a block member into the block,
+	 * using the block's memory layout.
+	 **/
+	void updateUniform(const Shader::UniformInfo *info, int count);
+
+	/**
+	 * Copies bytes which are already in the block's memory layout.
+	 **/
+	void setData(size_t offset, size_t size, const void *data);
+
+	/**
+	 * Uploads everything written since the last flush.
+	 **/
+	void flush();
+
+	Buffer *getBuffer() const { return buffer; }
+
+private:
+
+	struct Member
+	{
+		Shader::UniformInfo info;
+		Shader::UniformBlockMember layout;
+	};
+
+	// Returns the client-side copy of the block, with the given range marked
+	// as modified.
+	char *beginWrite(size_t offset, size_t size);
+
+	std::string blockName;
+	std::map<std::string, Member> members;
+
+	Buffer *buffer;
+
+}; // UniformBuffer
+
+} // graphics
+} // love
@@ -0,0 +1,617 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "VirtualTexture.h"
+#include "Graphics.h"
+#include "common/Exception.h"
+#include "common/Module.h"
+#include "filesystem/Filesystem.h"
+#include "image/Image.h"
+
+// C++
+#include <algorithm>
+#include <cstring>
+
+namespace love
+{
+namespace graphics
+{
+
+love::Type VirtualTexture::type("VirtualTexture", &Object::type);
+
+class VirtualTexture::EncodedSource : public VirtualTexture::Source
+{
+public:
+
+	EncodedSource(Data *data, int width, int height, int pagesize, int border, bool streaming)
+		: data(data)
+		, width(width)
+		, height(height)
+		, pageSize(pagesize)
+		, border(border)
+		, streaming(streaming)
+		, bandUses(0)
+	{
+	}
+
+	love::image::ImageData *loadPage(int x, int y, int &offsetx, int &offsety) override
+	{
+		// A band of a format without a region decoder would decode the whole
+		// image each time, on several workers at once. Decode it just once.
+		if (!streaming)
+		{
+			{
+				love::thread::Lock lock(imageMutex);
+				if (image.get() == nullptr)
+					image.set(new love::image::ImageData(data), Acquire::NORETAIN);
+			}
+
+			offsetx = border - x * pageSize;
+			offsety = border - y * pageSize;
+
+			image->retain();
+			return image.get();
+		}
+
+		// Include as much of the border as the image has, so neighbouring
+		// pages filter seamlessly.
+		int top = std::max(y * pageSize - border, 0);
+		int bottom = std::min(y * pageSize + pageSize + border, height);
+
+		StrongRef<Band> band = getBand(y);
+
+		{
+			// Other pages in the band wait for its decode instead of doing
+			// their own.
+			love::thread::Lock lock(band->mutex);
+			if (band->image.get() == nullptr)
+			{
+				Rect rect = {0, top, width, bottom - top};
+				band->image.set(new love::image::ImageData(data, rect), Acquire::NORETAIN);
+			}
+		}
+
+		// The page's pixels are copied out of the band by the caller.
+		offsetx = border - x * pageSize;
+		offsety = top - (y * pageSize - border);
+
+		band->image->retain();
+		return band->image.get();
+	}
+
+private:
+
+	// The full-width rows of one row of pages (plus borders), decoded once.
+	class Band : public Object
+	{
+	public:
+
+		int row = 0;
+		uint64 lastUse = 0;
+		love::thread::MutexRef mutex;
+		StrongRef<love::image::ImageData> image;
+
+	}; // Band
+
+	// Few enough to bound memory use, enough for the rows a view usually spans.
+	static const size_t MAX_BANDS = 4;
+
+	StrongRef<Band> getBand(int row)
+	{
+		love::thread::Lock lock(bandsMutex);
+
+		for (const StrongRef<Band> &band : bands)
+		{
+			if (band->row == row)
+			{
+				band->lastUse = ++bandUses;
+				return band;
+			}
+		}
+
+		// Evicted bands stay alive for as long as a load is still using them.
+		if (bands.size() >= MAX_BANDS)
+		{
+			auto oldest = std::min_element(bands.begin(), bands.end(), [](const StrongRef<Band> &a, const StrongRef<Band> &b)
+			{
+				return a->lastUse < b->lastUse;
+			});
+			bands.erase(oldest);
+		}
+
+		StrongRef<Band> band(new Band(), Acquire::NORETAIN);
+		band->row = row;
+		band->lastUse = ++bandUses;
+		bands.push_back(band);
+
+		return band;
+	}
+
+	StrongRef<Data> data;
+	int width;
+	int height;
+	int pageSize;
+	int border;
+	bool streaming;
+
+	// The whole decoded image, for formats which can't decode regions.
+	love::thread::MutexRef imageMutex;
+	StrongRef<love::image::ImageData> image;
+
+	love::thread::MutexRef bandsMutex;
+	std::vector<StrongRef<Band>> bands;
+	uint64 bandUses;
+
+}; // EncodedSource
+
+class VirtualTexture::FileSource : public VirtualTexture::Source
+{
+public:
+
+	FileSource(const std::string &pattern, int pagesize, int border)
+		: pattern(pattern)
+		, pageSize(pagesize)
+		, border(border)
+	{
+		size_t count = 0;
+		for (size_t i = pattern.find("%d"); i != std::string::npos; i = pattern.find("%d", i + 2))
+			count++;
+
+		if (count != 2)
+			throw love::Exception("Page filename pattern must contain '%%d' exactly twice, for the page's x and y indices.");
+	}
+
+	love::image::ImageData *loadPage(int x, int y, int &offsetx, int &offsety) override
+	{
+		auto fs = Module::getInstance<love::filesystem::Filesystem>(Module::M_FILESYSTEM);
+		if (fs == nullptr)
+			throw love::Exception("The love.filesystem module must be loaded to stream virtual texture pages from files.");
+
+		std::string filename = pattern;
+		size_t pos = filename.find("%d");
+		filename.replace(pos, 2, std::to_string(x));
+		pos = filename.find("%d", pos);
+		filename.replace(pos, 2, std::to_string(y));
+
+		StrongRef<love::filesystem::FileData> filedata(fs->read(filename.c_str()), Acquire::NORETAIN);
+		love::image::ImageData *imagedata = new love::image::ImageData(filedata);
+
+		// Files which already include the border are used as-is.
+		bool hasborder = imagedata->getWidth() >= pageSize + border * 2 && imagedata->getHeight() >= pageSize + border * 2;
+
+		offsetx = hasborder ? 0 : border;
+		offsety = hasborder ? 0 : border;
+
+		return imagedata;
+	}
+
+private:
+
+	std::string pattern;
+	int pageSize;
+	int border;
+
+}; // FileSource
+
+// Replicates the edges of the rectangle of a page which has pixels in it out
+// to the rest of the page.
+static void extendEdges(love::image::ImageData *page, const Rect &r)
+{
+	size_t pixelsize = page->getPixelSize();
+	size_t pitch = pixelsize * page->getWidth();
+	uint8 *data = (uint8 *) page->getData();
+
+	for (int y = r.y; y < r.y + r.h; y++)
+	{
+		uint8 *row = data + y * pitch;
+
+		for (int x = 0; x < r.x; x++)
+			memcpy(row + x * pixelsize, row + r.x * pixelsize, pixelsize);
+
+		for (int x = r.x + r.w; x < page->getWidth(); x++)
+			memcpy(row + x * pixelsize, row + (r.x + r.w - 1) * pixelsize, pixelsize);
+	}
+
+	for (int y = 0; y < r.y; y++)
+		memcpy(data + y * pitch, data + r.y * pitch, pitch);
+
+	for (int y = r.y + r.h; y < page->getHeight(); y++)
+		memcpy(data + y * pitch, data + (r.y + r.h - 1) * pitch, pitch);
+}
+
+VirtualTexture::LoadTask::LoadTask(VirtualTexture *vt, Source *source, int page, int x, int y)
+	: source(source)
+	, page(page)
+	, x(x)
+	, y(y)
+	, pageSize(vt->settings.pageSize)
+	, border(vt->settings.border)
+	, format(vt->settings.format)
+{
+}
+
+void VirtualTexture::LoadTask::run()
+{
+	using love::image::ImageData;
+
+	int offsetx = 0;
+	int offsety = 0;
+	StrongRef<ImageData> src(source->loadPage(x, y, offsetx, offsety), Acquire::NORETAIN);
+
+	int size = pageSize + border * 2;
+
+	// Clip the loaded pixels to the page.
+	int sx = std::max(-offsetx, 0);
+	int sy = std::max(-offsety, 0);
+
+	Rect r;
+	r.x = std::max(offsetx, 0);
+	r.y = std::max(offsety, 0);
+	r.w = std::min(src->getWidth() - sx, size - r.x);
+	r.h = std::min(src->getHeight() - sy, size - r.y);
+
+	if (r.w <= 0 || r.h <= 0)
+		throw love::Exception("Virtual texture page (%d, %d) has no pixels.", x, y);
+
+	// paste() converts to the cache's format, if it differs.
+	imageData.set(new ImageData(size, size, format), Acquire::NORETAIN);
+	imageData->paste(src, r.x, r.y, sx, sy, r.w, r.h);
+
+	extendEdges(imageData, r);
+}
+
+VirtualTexture::VirtualTexture(Graphics *gfx, Data *encoded, const Settings &settings)
+	: settings(settings)
+	, frame(1)
+{
+	auto imagemodule = Module::getInstance<love::image::Image>(Module::M_IMAGE);
+	if (imagemodule == nullptr)
+		throw love::Exception("The love.image module must be loaded to create a virtual texture from an encoded image.");
+
+	int w = 0;
+	int h = 0;
+	imagemodule->getDimensions(encoded, w, h);
+
+	bool streaming = imagemodule->canDecodeRegion(encoded);
+
+	StrongRef<Source> src(new EncodedSource(encoded, w, h, settings.pageSize, settings.border, streaming), Acquire::NORETAIN);
+	init(gfx, src, w, h);
+}
+
+VirtualTexture::VirtualTexture(Graphics *gfx, const std::string &pattern, int width, int height, const Settings &settings)
+	: settings(settings)
+	, frame(1)
+{
+	StrongRef<Source> src(new FileSource(pattern, settings.pageSize, settings.border), Acquire::NORETAIN);
+	init(gfx, src, width, height);
+}
+
+VirtualTexture::~VirtualTexture()
+{
+	// Tasks which are still running are kept alive by the WorkerPool.
+}
+
+void VirtualTexture::init(Graphics *gfx, Source *src, int w, int h)
+{
+	if (w <= 0 || h <= 0)
+		throw love::Exception("Invalid virtual texture dimensions: %dx%d.", w, h);
+
+	if (settings.pageSize <= 0)
+		throw love::Exception("Virtual texture page size must be greater than 0.");
+
+	if (settings.border < 0 || settings.border > settings.pageSize / 2)
+		throw love::Exception("Invalid virtual texture page border: %d.", settings.border);
+
+	if (settings.cacheSize <= 0 || settings.cacheSize > 0x10000)
+		throw love::Exception("Virtual texture cache size must be between 1 and 65536 pages.");
+
+	if (settings.maxUploads <= 0 || settings.maxLoads <= 0)
+		throw love::Exception("Virtual texture upload and load limits must be greater than 0.");
+
+	if (isPixelFormatCompressed(settings.format) || isPixelFormatDepthStencil(settings.format))
+		throw love::Exception("Virtual textures must use an uncompressed color pixel format.");
+
+	const auto &caps = gfx->getCapabilities();
+
+	if (!caps.textureTypes[TEXTURE_2D_ARRAY])
+		throw love::Exception("Virtual textures require array texture support.");
+
+	int slicesize = settings.pageSize + settings.border * 2;
+	int maxsize = (int) caps.limits[Graphics::LIMIT_TEXTURE_SIZE];
+	int maxlayers = (int) caps.limits[Graphics::LIMIT_TEXTURE_LAYERS];
+
+	if (slicesize > maxsize)
+		throw love::Exception("Virtual texture pages can be at most %d pixels wide (including the border) on this system.", maxsize);
+
+	if (settings.cacheSize > maxlayers)
+		throw love::Exception("Virtual texture cache can hold at most %d pages on this system.", maxlayers);
+
+	source.set(src);
+	width = w;
+	height = h;
+	pagesX = (w + settings.pageSize - 1) / settings.pageSize;
+	pagesY = (h + settings.pageSize - 1) / settings.pageSize;
+
+	if (pagesX > maxsize || pagesY > maxsize)
+		throw love::Exception("Virtual texture has too many pages (%dx%d) for this system.", pagesX, pagesY);
+
+	pages.resize((size_t) pagesX * pagesY);
+	slots.resize(settings.cacheSize);
+
+	Image::Settings imagesettings;
+	imagesettings.linear = settings.linear;
+
+	pageImage.set(gfx->newImage(TEXTURE_2D_ARRAY, settings.format, slicesize, slicesize, settings.cacheSize, imagesettings), Acquire::NORETAIN);
+
+	Texture::Wrap wrap; // Clamp wrap mode.
+	pageImage->setWrap(wrap);
+
+	// Starts out with every page marked as non-resident.
+	StrongRef<love::image::ImageData> entries(new love::image::ImageData(pagesX, pagesY, PIXELFORMAT_RGBA8), Acquire::NORETAIN);
+
+	Image::Slices slices(TEXTURE_2D);
+	slices.set(0, 0, entries);
+
+	Image::Settings indirectionsettings;
+	indirectionsettings.linear = true;
+
+	indirectionImage.set(gfx->newImage(slices, indirectionsettings), Acquire::NORETAIN);
+
+	Texture::Filter filter;
+	filter.min = filter.mag = Texture::FILTER_NEAREST;
+	filter.mipmap = Texture::FILTER_NONE;
+	indirectionImage->setFilter(filter);
+	indirectionImage->setWrap(wrap);
+}
+
+void VirtualTexture::requestPage(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= pagesX || y >= pagesY)
+		throw love::Exception("Invalid virtual texture page: (%d, %d).", x, y);
+
+	int index = y * pagesX + x;
+	Page &page = pages[index];
+
+	if (page.lastRequest == frame)
+		return;
+
+	page.lastRequest = frame;
+
+	if (page.state == PAGE_RESIDENT)
+		slots[page.slot].lastUsed = frame;
+	else if (page.state == PAGE_EMPTY)
+	{
+		page.state = PAGE_QUEUED;
+		queue.push_back(index);
+	}
+}
+
+void VirtualTexture::requestRegion(const Rect &rect)
+{
+	int x0 = std::max(rect.x, 0) / settings.pageSize;
+	int y0 = std::max(rect.y, 0) / settings.pageSize;
+	int x1 = std::min(rect.x + rect.w, width) - 1;
+	int y1 = std::min(rect.y + rect.h, height) - 1;
+
+	if (rect.w <= 0 || rect.h <= 0 || x1 < 0 || y1 < 0)
+		return;
+
+	x1 /= settings.pageSize;
+	y1 /= settings.pageSize;
+
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+			requestPage(x, y);
+	}
+}
+
+void VirtualTexture::requestFeedback(love::image::ImageData *feedback)
+{
+	if (feedback->getFormat() != PIXELFORMAT_RGBA8)
+		throw love::Exception("Virtual texture feedback must use the rgba8 pixel format.");
+
+	love::thread::Lock lock(feedback->getMutex());
+
+	const uint8 *pixels = (const uint8 *) feedback->getData();
+	size_t count = (size_t) feedback->getWidth() * feedback->getHeight();
+
+	// Feedback passes are usually rendered at a fraction of the screen's
+	// resolution, but neighbouring pixels still tend to hit the same page.
+	int previous = -1;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const uint8 *p = pixels + i * 4;
+		if (p[3] == 0)
+			continue;
+
+		int x = p[0] + (p[2] & 0x0F) * 256;
+		int y = p[1] + (p[2] >> 4) * 256;
+
+		if (x >= pagesX || y >= pagesY)
+			continue;
+
+		int index = y * pagesX + x;
+		if (index != previous)
+		{
+			requestPage(x, y);
+			previous = index;
+		}
+	}
+}
+
+int VirtualTexture::findSlot() const
+{
+	int best = -1;
+
+	for (int i = 0; i < (int) slots.size(); i++)
+	{
+		const Slot &slot = slots[i];
+
+		if (slot.page < 0)
+			return i;
+
+		if (slot.lastUsed < frame && (best < 0 || slot.lastUsed < slots[best].lastUsed))
+			best = i;
+	}
+
+	return best;
+}
+
+void VirtualTexture::setIndirection(int page, int slot)
+{
+	uint8 entry[4] = {0, 0, 0, 0};
+
+	if (slot >= 0)
+	{
+		entry[0] = (uint8) (slot & 0xFF);
+		entry[1] = (uint8) (slot >> 8);
+		entry[3] = 255;
+	}
+
+	Rect rect = {page % pagesX, page / pagesX, 1, 1};
+	indirectionImage->replacePixels(entry, sizeof(entry), 0, 0, rect, false);
+}
+
+int VirtualTexture::update()
+{
+	int uploaded = 0;
+	std::string error;
+
+	for (size_t i = 0; i < loading.size() && uploaded < settings.maxUploads; )
+	{
+		LoadTask *task = loading[i];
+		if (!task->isFinished())
+		{
+			i++;
+			continue;
+		}
+
+		Page &page = pages[task->getPage()];
+
+		if (task->hasError())
+		{
+			// Failed pages aren't retried, so a missing file only errors once.
+			page.state = PAGE_FAILED;
+			if (error.empty())
+				error = task->getError();
+
+			loading.erase(loading.begin() + i);
+			continue;
+		}
+
+		int slotindex = findSlot();
+
+		// Everything in the cache is in use this frame. Keep the page around
+		// and try again next frame.
+		if (slotindex < 0)
+			break;
+
+		Slot &slot = slots[slotindex];
+
+		if (slot.page >= 0)
+		{
+			pages[slot.page].state = PAGE_EMPTY;
+			pages[slot.page].slot = -1;
+			setIndirection(slot.page, -1);
+		}
+
+		love::image::ImageData *data = task->getImageData();
+		Rect rect = {0, 0, data->getWidth(), data->getHeight()};
+		pageImage->replacePixels(data->getData(), data->getSize(), slotindex, 0, rect, false);
+
+		slot.page = task->getPage();
+		slot.lastUsed = frame;
+
+		page.state = PAGE_RESIDENT;
+		page.slot = slotindex;
+		setIndirection(slot.page, slotindex);
+
+		loading.erase(loading.begin() + i);
+		uploaded++;
+	}
+
+	auto &pool = love::thread::WorkerPool::getInstance();
+
+	while (!queue.empty() && (int) loading.size() < settings.maxLoads)
+	{
+		int index = queue.front();
+		queue.pop_front();
+
+		Page &page = pages[index];
+		if (page.state != PAGE_QUEUED)
+			continue;
+
+		// Skip pages which weren't requested this frame or the last one.
+		if (page.lastRequest + 1 < frame)
+		{
+			page.state = PAGE_EMPTY;
+			continue;
+		}
+
+		page.state = PAGE_LOADING;
+
+		LoadTask *task = new LoadTask(this, source, index, index % pagesX, index / pagesX);
+		loading.emplace_back(task, Acquire::NORETAIN);
+		pool.submit(task);
+	}
+
+	frame++;
+
+	if (!error.empty())
+		throw love::Exception("Could not load virtual texture page: %s", error.c_str());
+
+	return uploaded;
+}
+
+bool VirtualTexture::isPageResident(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= pagesX || y >= pagesY)
+		return false;
+
+	return pages[y * pagesX + x].state == PAGE_RESIDENT;
+}
+
+int VirtualTexture::getResidentCount() const
+{
+	int count = 0;
+	for (const Slot &slot : slots)
+	{
+		if (slot.page >= 0)
+			count++;
+	}
+	return count;
+}
+
+int VirtualTexture::getPendingCount() const
+{
+	int count = (int) loading.size();
+	for (int index : queue)
+	{
+		if (pages[index].state == PAGE_QUEUED)
+			count++;
+	}
+	return count;
+}
+
+} // graphics
+} // love
@@ -0,0 +1,251 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "common/Object.h"
+#include "common/Data.h"
+#include "common/math.h"
+#include "common/int.h"
+#include "common/pixelformat.h"
+#include "image/ImageData.h"
+#include "thread/WorkerPool.h"
+#include "Image.h"
+
+// C++
+#include <string>
+#include <vector>
+#include <deque>
+
+namespace love
+{
+namespace graphics
+{
+
+class Graphics;
+
+/**
+ * A very large image which is split into square pages, only some of which
+ * are resident in GPU memory at a time.
+ *
+ * Resident pages live in the layers of a fixed-size array Image (the page
+ * cache). A second, much smaller Image has one texel per page and maps each
+ * page to its layer: layer = r*255 + g*255*256, and alpha is 1 for resident
+ * pages and 0 otherwise. It uses nearest filtering. A shader can look up a
+ * virtual texture coordinate like this:
+ *
+ *     vec4 entry = Texel(indirection, uv);
+ *     float layer = dot(floor(entry.rg * 255.0 + 0.5), vec2(1.0, 256.0));
+ *     vec2 inpage = (border + fract(uv * pagecount) * pagesize) / (pagesize + 2.0 * border);
+ *     vec4 color = Texel(pages, vec3(inpage, layer));
+ *
+ * Pages have 'border' texels copied from their neighbours on each side, so
+ * linear filtering doesn't bleed across page edges.
+ *
+ * Pages are requested each frame, explicitly or from the pixels of a
+ * feedback pass, and loaded on the shared WorkerPool. update() uploads the
+ * pages which have finished loading, evicting the least recently requested
+ * ones once the cache is full.
+ **/
+class VirtualTexture : public Object
+{
+public:
+
+	static love::Type type;
+
+	struct Settings
+	{
+		int pageSize = 128;
+		int border = 1;
+		int cacheSize = 64;
+
+		// Maximum number of pages uploaded by a single update() call.
+		int maxUploads = 8;
+
+		// Maximum number of pages being loaded at once.
+		int maxLoads = 16;
+
+		PixelFormat format = PIXELFORMAT_RGBA8;
+		bool linear = false;
+	};
+
+	/**
+	 * Pages are decoded from a single encoded image. For formats which can
+	 * decode regions (PNG and QOI), each row of pages is decoded as one
+	 * full-width band, and the last few bands are kept to cut pages out of.
+	 * They can't seek, so decoding a band still reads the image from the top
+	 * down to it: a band costs roughly as much as its row offset. Other
+	 * formats are decoded whole, once, and kept in memory. Very large images
+	 * should be split into page files (see the pattern constructor) instead.
+	 **/
+	VirtualTexture(Graphics *gfx, Data *encoded, const Settings &settings);
+
+	/**
+	 * Each page is a separate image file, named by formatting 'pattern' with
+	 * the page's x and y indices (e.g. "tiles/%d_%d.png"). Files can either
+	 * be pageSize pixels wide, or include the border as well.
+	 **/
+	VirtualTexture(Graphics *gfx, const std::string &pattern, int width, int height, const Settings &settings);
+
+	virtual ~VirtualTexture();
+
+	/**
+	 * Marks a page as needed this frame. Non-resident pages are queued for
+	 * loading.
+	 **/
+	void requestPage(int x, int y);
+
+	/**
+	 * Requests every page which overlaps a rectangle, in virtual pixels.
+	 **/
+	void requestRegion(const Rect &rect);
+
+	/**
+	 * Requests the pages written by a feedback pass. Each RGBA8 pixel with a
+	 * non-zero alpha holds a page index: x = r + (b % 16) * 256 and
+	 * y = g + floor(b / 16) * 256, with r, g and b in [0, 255].
+	 **/
+	void requestFeedback(love::image::ImageData *feedback);
+
+	/**
+	 * Uploads pages which have finished loading, starts loading newly
+	 * requested ones, and begins a new frame. Returns the number of pages
+	 * uploaded.
+	 **/
+	int update();
+
+	bool isPageResident(int x, int y) const;
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	int getPageSize() const { return settings.pageSize; }
+	int getPageBorder() const { return settings.border; }
+	int getPageCountX() const { return pagesX; }
+	int getPageCountY() const { return pagesY; }
+	int getCacheSize() const { return settings.cacheSize; }
+	int getResidentCount() const;
+	int getPendingCount() const;
+
+	Image *getPageImage() const { return pageImage; }
+	Image *getIndirectionImage() const { return indirectionImage; }
+
+private:
+
+	class Source : public Object
+	{
+	public:
+
+		virtual ~Source() {}
+
+		// Called from worker threads. The result's top-left pixel goes at
+		// (offsetx, offsety) in the bordered page, and anything outside the
+		// page is ignored. It doesn't need to include the border or be in the
+		// cache's pixel format.
+		virtual love::image::ImageData *loadPage(int x, int y, int &offsetx, int &offsety) = 0;
+
+	}; // Source
+
+	class EncodedSource;
+	class FileSource;
+
+	class LoadTask : public love::thread::Task
+	{
+	public:
+
+		LoadTask(VirtualTexture *vt, Source *source, int page, int x, int y);
+		virtual ~LoadTask() {}
+
+		void run() override;
+
+		int getPage() const { return page; }
+		love::image::ImageData *getImageData() const { return imageData; }
+
+	private:
+
+		StrongRef<Source> source;
+		int page;
+		int x;
+		int y;
+
+		int pageSize;
+		int border;
+		PixelFormat format;
+
+		StrongRef<love::image::ImageData> imageData;
+
+	}; // LoadTask
+
+	enum PageState
+	{
+		PAGE_EMPTY,
+		PAGE_QUEUED,
+		PAGE_LOADING,
+		PAGE_RESIDENT,
+		PAGE_FAILED,
+	};
+
+	struct Page
+	{
+		uint8 state = PAGE_EMPTY;
+		int slot = -1;
+		uint32 lastRequest = 0;
+	};
+
+	struct Slot
+	{
+		int page = -1;
+		uint32 lastUsed = 0;
+	};
+
+	void init(Graphics *gfx, Source *source, int width, int height);
+
+	// Gets a free slot, or the least recently used one which wasn't used
+	// this frame. Returns -1 if every slot is in use.
+	int findSlot() const;
+
+	void setIndirection(int page, int slot);
+
+	Settings settings;
+
+	StrongRef<Source> source;
+
+	int width;
+	int height;
+	int pagesX;
+	int pagesY;
+
+	std::vector<Page> pages;
+	std::vector<Slot> slots;
+
+	std::deque<int> queue;
+	std::vector<StrongRef<LoadTask>> loading;
+
+	// Requests made before the next update() belong to this frame. Starts at
+	// 1 so pages which have never been requested are always stale.
+	uint32 frame;
+
+	StrongRef<Image> pageImage;
+	StrongRef<Image> indirectionImage;
+
+}; // VirtualTexture
+
+} // graphics
+} // love
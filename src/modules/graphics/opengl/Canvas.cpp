@@ -19,6 +19,7 @@
  **/
 
 #include "Canvas.h"
+#include "Readback.h"
 #include "graphics/Graphics.h"
 #include "Graphics.h"
 
@@ -460,6 +461,30 @@ love::image::ImageData *Canvas::newImageData(love::image::Image *module, int sli
 	bool isSRGB = false;
 	OpenGL::TextureFormat fmt = gl.convertPixelFormat(data->getFormat(), false, isSRGB);
 
+	GLuint current_fbo = beginReadPixels(slice, mipmap);
+	glReadPixels(r.x, r.y, r.w, r.h, fmt.externalformat, fmt.type, data->getData());
+	endReadPixels(slice, mipmap, current_fbo);
+
+	return data;
+}
+
+love::graphics::Readback *Canvas::newImageDataAsync(love::image::Image *module, int slice, int mipmap, const Rect &r)
+{
+	love::image::ImageData *data = love::graphics::Canvas::newImageData(module, slice, mipmap, r);
+	StrongRef<love::image::ImageData> dataref(data, Acquire::NORETAIN);
+
+	bool isSRGB = false;
+	OpenGL::TextureFormat fmt = gl.convertPixelFormat(data->getFormat(), false, isSRGB);
+
+	GLuint current_fbo = beginReadPixels(slice, mipmap);
+	Readback *readback = new Readback(data, r, fmt.externalformat, fmt.type);
+	endReadPixels(slice, mipmap, current_fbo);
+
+	return readback;
+}
+
+GLuint Canvas::beginReadPixels(int slice, int mipmap)
+{
 	GLuint current_fbo = gl.getFramebuffer(OpenGL::FRAMEBUFFER_ALL);
 	gl.bindFramebuffer(OpenGL::FRAMEBUFFER_ALL, getFBO());
 
@@ -470,14 +495,15 @@ love::image::ImageData *Canvas::newImageData(love::image::Image *module, int sli
 		gl.framebufferTexture(GL_COLOR_ATTACHMENT0, texType, texture, mipmap, layer, face);
 	}
 
-	glReadPixels(r.x, r.y, r.w, r.h, fmt.externalformat, fmt.type, data->getData());
+	return current_fbo;
+}
 
+void Canvas::endReadPixels(int slice, int mipmap, GLuint previousfbo)
+{
 	if (slice > 0 || mipmap > 0)
 		gl.framebufferTexture(GL_COLOR_ATTACHMENT0, texType, texture, 0, 0, 0);
 
-	gl.bindFramebuffer(OpenGL::FRAMEBUFFER_ALL, current_fbo);
-
-	return data;
+	gl.bindFramebuffer(OpenGL::FRAMEBUFFER_ALL, previousfbo);
 }
 
 void Canvas::generateMipmaps()
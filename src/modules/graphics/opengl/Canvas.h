@@ -54,6 +54,7 @@ class Canvas final : public love::graphics::Canvas, public Volatile
 	ptrdiff_t getHandle() const override;
 
 	love::image::ImageData *newImageData(love::image::Image *module, int slice, int mipmap, const Rect &rect) override;
+	love::graphics::Readback *newImageDataAsync(love::image::Image *module, int slice, int mipmap, const Rect &rect) override;
 	void generateMipmaps() override;
 
 	int getMSAA() const override
@@ -99,6 +100,11 @@ class Canvas final : public love::graphics::Canvas, public Volatile
 		}
 	};
 
+	// Bind the FBO for reading from the given slice and mipmap level. Returns
+	// the previously bound framebuffer, for endReadPixels.
+	GLuint beginReadPixels(int slice, int mipmap);
+	void endReadPixels(int slice, int mipmap, GLuint previousfbo);
+
 	GLuint fbo;
 
 	GLuint texture;
@@ -72,6 +72,22 @@ bool FenceSync::cpuWait()
 	return true;
 }
 
+bool FenceSync::isSignaled()
+{
+	if (sync == 0)
+		return true;
+
+	// The flush makes sure the fence will eventually be reached, if nothing
+	// else submits the pending commands.
+	GLenum status = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+	if (status == GL_TIMEOUT_EXPIRED)
+		return false;
+
+	cleanup();
+	return true;
+}
+
 void FenceSync::cleanup()
 {
 	if (sync != 0)
@@ -43,6 +43,13 @@ class FenceSync
 
 	bool fence();
 	bool cpuWait();
+
+	/**
+	 * Returns whether the GPU has reached the fence (or there is none),
+	 * without blocking.
+	 **/
+	bool isSignaled();
+
 	void cleanup();
 
 private:
@@ -42,6 +42,7 @@
 // C
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 
 #ifdef LOVE_IOS
 #include <SDL_syswm.h>
@@ -57,6 +58,7 @@ namespace opengl
 Graphics::Graphics()
 	: windowHasStencil(false)
 	, mainVAO(0)
+	, uploadBuffer(nullptr)
 {
 	gl = OpenGL();
 	Canvas::resetFormatSupport();
@@ -84,6 +86,8 @@ Graphics::Graphics()
 
 Graphics::~Graphics()
 {
+	queuedUploads.clear();
+	delete uploadBuffer;
 }
 
 const char *Graphics::getName() const
@@ -111,14 +115,14 @@ love::graphics::Canvas *Graphics::newCanvas(const Canvas::Settings &settings)
 	return new Canvas(settings);
 }
 
-love::graphics::ShaderStage *Graphics::newShaderStageInternal(ShaderStage::StageType stage, const std::string &cachekey, const std::string &source, bool gles)
+love::graphics::ShaderStage *Graphics::newShaderStageInternal(ShaderStage::StageType stage, const std::string &cachekey, const std::string &source, bool gles, bool deferValidation)
 {
-	return new ShaderStage(this, stage, source, gles, cachekey);
+	return new ShaderStage(this, stage, source, gles, cachekey, deferValidation);
 }
 
-love::graphics::Shader *Graphics::newShaderInternal(love::graphics::ShaderStage *vertex, love::graphics::ShaderStage *pixel)
+love::graphics::Shader *Graphics::newShaderInternal(love::graphics::ShaderStage *vertex, love::graphics::ShaderStage *pixel, bool async)
 {
-	return new Shader(vertex, pixel);
+	return new Shader(vertex, pixel, async);
 }
 
 love::graphics::Buffer *Graphics::newBuffer(size_t size, const void *data, BufferType type, vertex::Usage usage, uint32 mapflags)
@@ -270,6 +274,9 @@ void Graphics::unSetMode()
 
 	flushStreamDraws();
 
+	// Images queue their data again when they're reloaded.
+	queuedUploads.clear();
+
 	// Unload all volatile objects. These must be reloaded after the display
 	// mode change.
 	Volatile::unloadAll();
@@ -308,6 +315,7 @@ void Graphics::setActive(bool enable)
 
 void Graphics::draw(const DrawCommand &cmd)
 {
+	prepareUniformBuffers();
 	gl.prepareDraw();
 	gl.setVertexAttributes(*cmd.attributes, *cmd.buffers);
 	gl.bindTextureToUnit(cmd.texture, 0, false);
@@ -325,6 +333,7 @@ void Graphics::draw(const DrawCommand &cmd)
 
 void Graphics::draw(const DrawIndexedCommand &cmd)
 {
+	prepareUniformBuffers();
 	gl.prepareDraw();
 	gl.setVertexAttributes(*cmd.attributes, *cmd.buffers);
 	gl.bindTextureToUnit(cmd.texture, 0, false);
@@ -344,6 +353,24 @@ void Graphics::draw(const DrawIndexedCommand &cmd)
 	++drawCalls;
 }
 
+void Graphics::prepareUniformBuffers()
+{
+	for (int i = 0; i < (int) uniformBuffers.size(); i++)
+	{
+		love::graphics::UniformBuffer *buffer = uniformBuffers[i].get();
+		GLuint handle = 0;
+
+		if (buffer != nullptr)
+		{
+			// Upload any values written since the last draw, all at once.
+			buffer->flush();
+			handle = (GLuint) buffer->getBuffer()->getHandle();
+		}
+
+		gl.bindUniformBuffer(i, handle);
+	}
+}
+
 static inline void advanceVertexOffsets(const vertex::Attributes &attributes, vertex::BufferBindings &buffers, int vertexcount)
 {
 	// TODO: Figure out a better way to avoid touching the same buffer multiple
@@ -372,6 +399,7 @@ void Graphics::drawQuads(int start, int count, const vertex::Attributes &attribu
 	const int MAX_VERTICES_PER_DRAW = LOVE_UINT16_MAX;
 	const int MAX_QUADS_PER_DRAW    = MAX_VERTICES_PER_DRAW / 4;
 
+	prepareUniformBuffers();
 	gl.prepareDraw();
 	gl.bindTextureToUnit(texture, 0, false);
 	gl.setCullMode(CULL_NONE);
@@ -1006,10 +1034,15 @@ void Graphics::present(void *screenshotCallbackData)
 	glBindRenderbuffer(GL_RENDERBUFFER, info.info.uikit.colorbuffer);
 #endif
 
+	processTextureUploads();
+
 	for (StreamBuffer *buffer : streamBufferState.vb)
 		buffer->nextFrame();
 	streamBufferState.indexBuffer->nextFrame();
 
+	if (uploadBuffer != nullptr)
+		uploadBuffer->nextFrame();
+
 	auto window = getInstance<love::window::Window>(M_WINDOW);
 	if (window != nullptr)
 		window->swapBuffers();
@@ -1017,9 +1050,32 @@ void Graphics::present(void *screenshotCallbackData)
 	// Reset the per-frame stat counts.
 	drawCalls = 0;
 	gl.stats.shaderSwitches = 0;
+	gl.stats.uniformUpdates = 0;
+	gl.stats.uniformUpdatesSkipped = 0;
 	canvasSwitchCount = 0;
 	drawCallsBatched = 0;
 
+	// Swap in an async shader which finished compiling while its fallback was
+	// used for drawing. A failed compile is never reported from here: the
+	// shader keeps the error for Shader:getCompileError, Shader:isReady and
+	// its next use, and it's never attached.
+	Shader *shader = (Shader *) states.back().shader.get();
+	if (shader != nullptr && shader != Shader::current && shader->getCompileError().empty())
+	{
+		bool ready = false;
+
+		try
+		{
+			ready = shader->isReady();
+		}
+		catch (love::Exception &)
+		{
+		}
+
+		if (ready)
+			shader->attach();
+	}
+
 	// This assumes temporary canvases will only be used within a render pass.
 	for (int i = (int) temporaryCanvases.size() - 1; i >= 0; i--)
 	{
@@ -1034,6 +1090,110 @@ void Graphics::present(void *screenshotCallbackData)
 	}
 }
 
+void Graphics::queueTextureUpload(love::graphics::Image *image, love::image::ImageDataBase *data, int level, int slice, int x, int y)
+{
+	QueuedUpload upload;
+	upload.image.set((Image *) image);
+	upload.data.set(data);
+	upload.level = level;
+	upload.slice = slice;
+	upload.x = x;
+	upload.y = y;
+	upload.rowsUploaded = 0;
+
+	queuedUploads.push_back(upload);
+}
+
+void Graphics::processTextureUploads()
+{
+	if (queuedUploads.empty())
+		return;
+
+	OpenGL::TempDebugGroup debuggroup("Queued texture uploads");
+
+	size_t uploadedsize = 0;
+
+	while (!queuedUploads.empty())
+	{
+		QueuedUpload &upload = queuedUploads.front();
+		love::image::ImageDataBase *data = upload.data;
+
+		int height = data->getHeight();
+		size_t rowsize = data->getSize() / height;
+
+		// The staging buffer holds a frame's worth of uploads, and at least
+		// one row so large images can't get stuck.
+		bool resize = uploadBuffer == nullptr || uploadBuffer->getSize() < rowsize
+			|| (uploadedsize == 0 && uploadBuffer->getSize() < textureUploadBudget);
+
+		if (resize)
+		{
+			delete uploadBuffer;
+			uploadBuffer = nullptr;
+			uploadBuffer = CreateStreamBuffer(BUFFER_PIXEL_UNPACK, std::max(textureUploadBudget, rowsize));
+		}
+
+		size_t rows = height - upload.rowsUploaded;
+
+		size_t budgetrows = 0;
+		if (textureUploadBudget > uploadedsize)
+			budgetrows = (textureUploadBudget - uploadedsize) / rowsize;
+
+		if (budgetrows == 0)
+		{
+			if (uploadedsize > 0)
+				break;
+			budgetrows = 1;
+		}
+
+		rows = std::min(rows, budgetrows);
+
+		StreamBuffer::MapInfo map = uploadBuffer->map(rowsize * rows);
+		rows = std::min(rows, map.size / rowsize);
+
+		// The staging buffer is full until the GPU catches up.
+		if (rows == 0)
+		{
+			uploadBuffer->unmap(0);
+			gl.bindBuffer(BUFFER_PIXEL_UNPACK, 0);
+			break;
+		}
+
+		size_t size = rowsize * rows;
+
+		{
+			love::image::ImageData *id = dynamic_cast<love::image::ImageData *>(data);
+
+			love::thread::EmptyLock lock;
+			if (id != nullptr)
+				lock.setLock(id->getMutex());
+
+			memcpy(map.data, (const uint8 *) data->getData() + rowsize * upload.rowsUploaded, size);
+		}
+
+		size_t offset = uploadBuffer->unmap(size);
+		uploadBuffer->markUsed(size);
+
+		// With a pixel buffer bound, the data pointer is an offset into it.
+		gl.bindBuffer(BUFFER_PIXEL_UNPACK, (GLuint) uploadBuffer->getHandle());
+
+		Rect rect = {upload.x, upload.y + upload.rowsUploaded, data->getWidth(), (int) rows};
+		upload.image->uploadByteData(data->getFormat(), (const void *) offset, size, upload.level, upload.slice, rect);
+
+		gl.bindBuffer(BUFFER_PIXEL_UNPACK, 0);
+
+		uploadedsize += size;
+		upload.rowsUploaded += (int) rows;
+
+		if (upload.rowsUploaded >= height)
+		{
+			StrongRef<Image> image = upload.image;
+			queuedUploads.pop_front();
+			image->finishQueuedUpload();
+		}
+	}
+}
+
 void Graphics::setScissor(const Rect &rect)
 {
 	flushStreamDraws();
@@ -1331,6 +1491,43 @@ void Graphics::setWireframe(bool enable)
 	states.back().wireframe = enable;
 }
 
+void Graphics::setUniformBuffer(const std::string &blockname, love::graphics::UniformBuffer *buffer)
+{
+	if (buffer != nullptr && !capabilities.features[FEATURE_UNIFORM_BUFFERS])
+		throw love::Exception("Uniform buffers are not supported on this system.");
+
+	int binding = gl.getUniformBlockBinding(blockname, buffer != nullptr);
+
+	if (binding < 0)
+	{
+		// Nothing can be using a block name that was never given a binding.
+		if (buffer == nullptr)
+			return;
+
+		throw love::Exception("Too many different uniform block names are in use (the maximum is %d.)", gl.getMaxUniformBufferBindings());
+	}
+
+	if (binding < (int) uniformBuffers.size() && uniformBuffers[binding].get() == buffer)
+		return;
+
+	flushStreamDraws();
+
+	if (binding >= (int) uniformBuffers.size())
+		uniformBuffers.resize(binding + 1);
+
+	uniformBuffers[binding].set(buffer);
+}
+
+love::graphics::UniformBuffer *Graphics::getUniformBuffer(const std::string &blockname) const
+{
+	int binding = gl.getUniformBlockBinding(blockname, false);
+
+	if (binding < 0 || binding >= (int) uniformBuffers.size())
+		return nullptr;
+
+	return uniformBuffers[binding].get();
+}
+
 Graphics::Renderer Graphics::getRenderer() const
 {
 	return GLAD_ES_VERSION_2_0 ? RENDERER_OPENGLES : RENDERER_OPENGL;
@@ -1366,9 +1563,11 @@ Graphics::RendererInfo Graphics::getRendererInfo() const
 	return info;
 }
 
-void Graphics::getAPIStats(int &shaderswitches) const
+void Graphics::getAPIStats(int &shaderswitches, int &uniformupdates, int &uniformupdatesskipped) const
 {
 	shaderswitches = gl.stats.shaderSwitches;
+	uniformupdates = gl.stats.uniformUpdates;
+	uniformupdatesskipped = gl.stats.uniformUpdatesSkipped;
 }
 
 void Graphics::initCapabilities()
@@ -1381,7 +1580,8 @@ void Graphics::initCapabilities()
 	capabilities.features[FEATURE_SHADER_DERIVATIVES] = GLAD_VERSION_2_0 || GLAD_ES_VERSION_3_0 || GLAD_OES_standard_derivatives;
 	capabilities.features[FEATURE_GLSL3] = GLAD_ES_VERSION_3_0 || gl.isCoreProfile();
 	capabilities.features[FEATURE_INSTANCING] = gl.isInstancingSupported();
-	static_assert(FEATURE_MAX_ENUM == 8, "Graphics::initCapabilities must be updated when adding a new graphics feature!");
+	capabilities.features[FEATURE_UNIFORM_BUFFERS] = capabilities.features[FEATURE_GLSL3] && gl.isUniformBufferSupported();
+	static_assert(FEATURE_MAX_ENUM == 9, "Graphics::initCapabilities must be updated when adding a new graphics feature!");
 
 	capabilities.limits[LIMIT_POINT_SIZE] = gl.getMaxPointSize();
 	capabilities.limits[LIMIT_TEXTURE_SIZE] = gl.getMax2DTextureSize();
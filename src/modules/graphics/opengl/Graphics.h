@@ -24,6 +24,7 @@
 // STD
 #include <stack>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 
 // OpenGL
@@ -104,6 +105,11 @@ class Graphics final : public love::graphics::Graphics
 
 	void setWireframe(bool enable) override;
 
+	void setUniformBuffer(const std::string &blockname, love::graphics::UniformBuffer *buffer) override;
+	love::graphics::UniformBuffer *getUniformBuffer(const std::string &blockname) const override;
+
+	void queueTextureUpload(love::graphics::Image *image, love::image::ImageDataBase *data, int level, int slice, int x, int y) override;
+
 	bool isCanvasFormatSupported(PixelFormat format) const override;
 	bool isCanvasFormatSupported(PixelFormat format, bool readable) const override;
 	bool isImageFormatSupported(PixelFormat format, bool sRGB) const override;
@@ -117,6 +123,19 @@ class Graphics final : public love::graphics::Graphics
 
 private:
 
+	struct QueuedUpload
+	{
+		StrongRef<Image> image;
+		StrongRef<love::image::ImageDataBase> data;
+		int level;
+		int slice;
+		int x;
+		int y;
+
+		// Rows which have already been sent to the GPU.
+		int rowsUploaded;
+	};
+
 	struct CachedFBOHasher
 	{
 		size_t operator() (const RenderTargets &rts) const
@@ -136,23 +155,34 @@ class Graphics final : public love::graphics::Graphics
 		}
 	};
 
-	love::graphics::ShaderStage *newShaderStageInternal(ShaderStage::StageType stage, const std::string &cachekey, const std::string &source, bool gles) override;
-	love::graphics::Shader *newShaderInternal(love::graphics::ShaderStage *vertex, love::graphics::ShaderStage *pixel) override;
+	love::graphics::ShaderStage *newShaderStageInternal(ShaderStage::StageType stage, const std::string &cachekey, const std::string &source, bool gles, bool deferValidation) override;
+	love::graphics::Shader *newShaderInternal(love::graphics::ShaderStage *vertex, love::graphics::ShaderStage *pixel, bool async) override;
 	love::graphics::StreamBuffer *newStreamBuffer(BufferType type, size_t size) override;
 	void setCanvasInternal(const RenderTargets &rts, int w, int h, int pixelw, int pixelh, bool hasSRGBcanvas) override;
 	void initCapabilities() override;
-	void getAPIStats(int &shaderswitches) const override;
+	void getAPIStats(int &shaderswitches, int &uniformupdates, int &uniformupdatesskipped) const override;
 
 	void endPass();
+	void prepareUniformBuffers();
 	void bindCachedFBO(const RenderTargets &targets);
 	void discard(OpenGL::FramebufferTarget target, const std::vector<bool> &colorbuffers, bool depthstencil);
 
 	void setDebug(bool enable);
 
+	// Sends queued texture uploads to the GPU through the staging buffer,
+	// until this frame's share of the upload budget is used up.
+	void processTextureUploads();
+
 	std::unordered_map<RenderTargets, GLuint, CachedFBOHasher> framebufferObjects;
 	bool windowHasStencil;
 	GLuint mainVAO;
 
+	// Indexed by binding point (see OpenGL::getUniformBlockBinding.)
+	std::vector<StrongRef<love::graphics::UniformBuffer>> uniformBuffers;
+
+	std::deque<QueuedUpload> queuedUploads;
+	love::graphics::StreamBuffer *uploadBuffer;
+
 }; // Graphics
 
 } // opengl
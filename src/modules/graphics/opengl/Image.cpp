@@ -142,7 +142,7 @@ void Image::loadData()
 	}
 
 	if (mipmapsType == MIPMAPS_GENERATED)
-		generateMipmaps();
+		updateMipmaps();
 }
 
 void Image::uploadByteData(PixelFormat pixelformat, const void *data, size_t size, int level, int slice, const Rect &r)
@@ -260,6 +260,7 @@ void Image::unloadVolatile()
 	gl.deleteTexture(texture);
 	texture = 0;
 
+	resetQueuedUploads();
 	setGraphicsMemorySize(0);
 }
 
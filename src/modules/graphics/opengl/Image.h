@@ -58,6 +58,9 @@ class Image final : public love::graphics::Image, public Volatile
 
 private:
 
+	// The upload queue calls uploadByteData with a pixel buffer bound.
+	friend class Graphics;
+
 	void uploadByteData(PixelFormat pixelformat, const void *data, size_t size, int level, int slice, const Rect &r) override;
 	void generateMipmaps() override;
 
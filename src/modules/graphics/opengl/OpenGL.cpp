@@ -105,6 +105,7 @@ OpenGL::OpenGL()
 	, maxRenderTargets(1)
 	, maxRenderbufferSamples(0)
 	, maxTextureUnits(1)
+	, maxUniformBufferBindings(0)
 	, maxPointSize(1)
 	, coreProfile(false)
 	, vendor(VENDOR_UNKNOWN)
@@ -251,9 +252,21 @@ void OpenGL::setupContext()
 	for (int i = 0; i < (int) BUFFER_MAX_ENUM; i++)
 	{
 		state.boundBuffers[i] = 0;
+
+		if (i == BUFFER_UNIFORM && !isUniformBufferSupported())
+			continue;
+		if (i == BUFFER_PIXEL_UNPACK && !isPixelBufferSupported())
+			continue;
+
 		glBindBuffer(getGLBufferType((BufferType) i), 0);
 	}
 
+	state.boundUniformBuffers.clear();
+	state.boundUniformBuffers.resize(maxUniformBufferBindings, 0);
+
+	for (int i = 0; i < maxUniformBufferBindings; i++)
+		glBindBufferBase(GL_UNIFORM_BUFFER, i, 0);
+
 	// Initialize multiple texture unit support for shaders.
 	for (int i = 0; i < TEXTURE_MAX_ENUM; i++)
 	{
@@ -514,6 +527,11 @@ void OpenGL::initMaxValues()
 
 	glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
 
+	if (isUniformBufferSupported())
+		glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxUniformBufferBindings);
+	else
+		maxUniformBufferBindings = 0;
+
 	GLfloat limits[2];
 	if (GLAD_VERSION_3_0)
 		glGetFloatv(GL_POINT_SIZE_RANGE, limits);
@@ -626,6 +644,10 @@ GLenum OpenGL::getGLBufferType(BufferType type)
 		return GL_ARRAY_BUFFER;
 	case BUFFER_INDEX:
 		return GL_ELEMENT_ARRAY_BUFFER;
+	case BUFFER_UNIFORM:
+		return GL_UNIFORM_BUFFER;
+	case BUFFER_PIXEL_UNPACK:
+		return GL_PIXEL_UNPACK_BUFFER;
 	case BUFFER_MAX_ENUM:
 		return GL_ZERO;
 	}
@@ -720,6 +742,38 @@ void OpenGL::deleteBuffer(GLuint buffer)
 		if (state.boundBuffers[i] == buffer)
 			state.boundBuffers[i] = 0;
 	}
+
+	for (GLuint &bound : state.boundUniformBuffers)
+	{
+		if (bound == buffer)
+			bound = 0;
+	}
+}
+
+void OpenGL::bindUniformBuffer(int binding, GLuint buffer)
+{
+	if (state.boundUniformBuffers[binding] != buffer)
+	{
+		glBindBufferBase(GL_UNIFORM_BUFFER, (GLuint) binding, buffer);
+		state.boundUniformBuffers[binding] = buffer;
+
+		// glBindBufferBase also replaces the generic binding point.
+		state.boundBuffers[BUFFER_UNIFORM] = buffer;
+	}
+}
+
+int OpenGL::getUniformBlockBinding(const std::string &name, bool create)
+{
+	auto it = uniformBlockBindings.find(name);
+	if (it != uniformBlockBindings.end())
+		return it->second;
+
+	if (!create || (int) uniformBlockBindings.size() >= maxUniformBufferBindings)
+		return -1;
+
+	int binding = (int) uniformBlockBindings.size();
+	uniformBlockBindings[name] = binding;
+	return binding;
 }
 
 void OpenGL::setVertexAttributes(const vertex::Attributes &attributes, const vertex::BufferBindings &buffers)
@@ -1268,6 +1322,16 @@ bool OpenGL::isInstancingSupported() const
 		|| GLAD_ARB_instanced_arrays || GLAD_EXT_instanced_arrays || GLAD_ANGLE_instanced_arrays;
 }
 
+bool OpenGL::isUniformBufferSupported() const
+{
+	return GLAD_ES_VERSION_3_0 || GLAD_VERSION_3_1 || GLAD_ARB_uniform_buffer_object;
+}
+
+bool OpenGL::isPixelBufferSupported() const
+{
+	return GLAD_ES_VERSION_3_0 || GLAD_VERSION_2_1 || GLAD_ARB_pixel_buffer_object;
+}
+
 bool OpenGL::isDepthCompareSampleSupported() const
 {
 	// Our official API only supports this in GLSL3 shaders, but unofficially
@@ -1315,6 +1379,11 @@ int OpenGL::getMaxRenderbufferSamples() const
 	return maxRenderbufferSamples;
 }
 
+int OpenGL::getMaxUniformBufferBindings() const
+{
+	return maxUniformBufferBindings;
+}
+
 int OpenGL::getMaxTextureUnits() const
 {
 	return maxTextureUnits;
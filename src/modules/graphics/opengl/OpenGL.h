@@ -37,6 +37,8 @@
 // C++
 #include <vector>
 #include <stack>
+#include <map>
+#include <string>
 
 // The last argument to AttribPointer takes a buffer offset casted to a pointer.
 #define BUFFER_OFFSET(i) ((char *) NULL + (i))
@@ -126,6 +128,11 @@ class OpenGL
 	struct Stats
 	{
 		int shaderSwitches;
+
+		// glUniform calls made, and ones avoided because the shader already
+		// had the values.
+		int uniformUpdates;
+		int uniformUpdatesSkipped;
 	} stats;
 
 	struct Bugs
@@ -248,6 +255,19 @@ class OpenGL
 	 **/
 	void deleteBuffer(GLuint buffer);
 
+	/**
+	 * State-tracked glBindBufferBase for GL_UNIFORM_BUFFER.
+	 **/
+	void bindUniformBuffer(int binding, GLuint buffer);
+
+	/**
+	 * Gets the uniform buffer binding point used by every uniform block with
+	 * the given name, so a buffer bound there is seen by all shaders which
+	 * declare the block. Returns -1 if there is none and it couldn't (or
+	 * shouldn't) be created.
+	 **/
+	int getUniformBlockBinding(const std::string &name, bool create);
+
 	/**
 	 * Set all vertex attribute state.
 	 **/
@@ -372,6 +392,8 @@ class OpenGL
 	bool isClampZeroTextureWrapSupported() const;
 	bool isPixelShaderHighpSupported() const;
 	bool isInstancingSupported() const;
+	bool isUniformBufferSupported() const;
+	bool isPixelBufferSupported() const;
 	bool isDepthCompareSampleSupported() const;
 	bool isSamplerLODBiasSupported() const;
 	bool isBaseVertexSupported() const;
@@ -399,6 +421,11 @@ class OpenGL
 	 **/
 	int getMaxTextureUnits() const;
 
+	/**
+	 * Returns the number of uniform buffer binding points.
+	 **/
+	int getMaxUniformBufferBindings() const;
+
 	/**
 	 * Returns the maximum point size.
 	 **/
@@ -465,17 +492,25 @@ class OpenGL
 	int maxRenderTargets;
 	int maxRenderbufferSamples;
 	int maxTextureUnits;
+	int maxUniformBufferBindings;
 	float maxPointSize;
 
 	bool coreProfile;
 
 	Vendor vendor;
 
+	// Uniform block name -> binding point. Kept across context re-creation so
+	// relinked shaders get the same binding points.
+	std::map<std::string, int> uniformBlockBindings;
+
 	// Tracked OpenGL state.
 	struct
 	{
 		GLuint boundBuffers[BUFFER_MAX_ENUM];
 
+		// Buffers bound to the indexed GL_UNIFORM_BUFFER binding points.
+		std::vector<GLuint> boundUniformBuffers;
+
 		// Texture unit state (currently bound texture for each texture unit.)
 		std::vector<GLuint> boundTextures[TEXTURE_MAX_ENUM];
 
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "Readback.h"
+#include "common/Exception.h"
+
+// C
+#include <cstring>
+
+namespace love
+{
+namespace graphics
+{
+namespace opengl
+{
+
+Readback::Readback(love::image::ImageData *data, const Rect &rect, GLenum format, GLenum type)
+	: love::graphics::Readback(data)
+	, pbo(0)
+{
+	if (!isSupported())
+	{
+		love::thread::Lock lock(data->getMutex());
+		glReadPixels(rect.x, rect.y, rect.w, rect.h, format, type, data->getData());
+		complete = true;
+		return;
+	}
+
+	glGenBuffers(1, &pbo);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+	glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr) data->getSize(), nullptr, GL_STREAM_READ);
+
+	// With a pack buffer bound, this only queues the copy instead of waiting
+	// for the GPU to finish rendering.
+	glReadPixels(rect.x, rect.y, rect.w, rect.h, format, type, BUFFER_OFFSET(0));
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	sync.fence();
+}
+
+Readback::~Readback()
+{
+	deleteBuffer();
+}
+
+bool Readback::loadVolatile()
+{
+	return true;
+}
+
+void Readback::unloadVolatile()
+{
+	// The buffer won't survive the context, so get the pixels out now.
+	if (complete)
+		return;
+
+	try
+	{
+		wait();
+	}
+	catch (love::Exception &)
+	{
+	}
+}
+
+bool Readback::isSupported()
+{
+	return GLAD_ES_VERSION_3_0 || GLAD_VERSION_3_2
+		|| (GLAD_VERSION_2_1 && GLAD_ARB_sync && GLAD_ARB_map_buffer_range);
+}
+
+bool Readback::update(bool wait)
+{
+	if (pbo == 0)
+		return true;
+
+	if (wait)
+		sync.cpuWait();
+	else if (!sync.isSignaled())
+		return false;
+
+	size_t size = imageData->getSize();
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+
+	const void *src = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr) size, GL_MAP_READ_BIT);
+
+	if (src != nullptr)
+	{
+		love::thread::Lock lock(imageData->getMutex());
+		memcpy(imageData->getData(), src, size);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	deleteBuffer();
+
+	// The base class keeps reporting this, since the buffer is gone.
+	if (src == nullptr)
+		throw love::Exception("Could not read back the pixel data from the GPU.");
+
+	return true;
+}
+
+void Readback::deleteBuffer()
+{
+	sync.cleanup();
+
+	if (pbo != 0)
+	{
+		glDeleteBuffers(1, &pbo);
+		pbo = 0;
+	}
+}
+
+} // opengl
+} // graphics
+} // love
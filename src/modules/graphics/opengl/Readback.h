@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "common/config.h"
+#include "common/math.h"
+#include "graphics/Readback.h"
+#include "graphics/Volatile.h"
+#include "OpenGL.h"
+#include "FenceSync.h"
+
+namespace love
+{
+namespace graphics
+{
+namespace opengl
+{
+
+class Readback final : public love::graphics::Readback, public Volatile
+{
+public:
+
+	/**
+	 * Reads a rectangle of the currently bound read framebuffer. If pixel
+	 * buffers and fences aren't supported the pixels are read immediately.
+	 **/
+	Readback(love::image::ImageData *data, const Rect &rect, GLenum format, GLenum type);
+	virtual ~Readback();
+
+	// Implements Volatile.
+	bool loadVolatile() override;
+	void unloadVolatile() override;
+
+	static bool isSupported();
+
+protected:
+
+	bool update(bool wait) override;
+
+private:
+
+	void deleteBuffer();
+
+	// Pixel pack buffer which receives the pixels.
+	GLuint pbo;
+
+	FenceSync sync;
+
+}; // Readback
+
+} // opengl
+} // graphics
+} // love
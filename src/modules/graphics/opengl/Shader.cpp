@@ -22,6 +22,7 @@
 #include "common/config.h"
 
 #include "Shader.h"
+#include "ShaderStage.h"
 #include "Graphics.h"
 
 // C++
@@ -36,9 +37,10 @@ namespace graphics
 namespace opengl
 {
 
-Shader::Shader(love::graphics::ShaderStage *vertex, love::graphics::ShaderStage *pixel)
-	: love::graphics::Shader(vertex, pixel)
+Shader::Shader(love::graphics::ShaderStage *vertex, love::graphics::ShaderStage *pixel, bool async)
+	: love::graphics::Shader(vertex, pixel, async)
 	, program(0)
+	, linking(false)
 	, builtinUniforms()
 	, builtinUniformInfo()
 	, builtinAttributes()
@@ -47,7 +49,13 @@ Shader::Shader(love::graphics::ShaderStage *vertex, love::graphics::ShaderStage
 	, lastPointSize(0.0f)
 {
 	// load shader source and create program object
-	loadVolatile();
+	if (async)
+	{
+		OpenGL::TempDebugGroup debuggroup("Shader load");
+		startLink();
+	}
+	else
+		loadVolatile();
 }
 
 Shader::~Shader()
@@ -60,6 +68,9 @@ Shader::~Shader()
 		if (p.second.data != nullptr)
 			free(p.second.data);
 
+		if (p.second.uploadedData != nullptr)
+			free(p.second.uploadedData);
+
 		if (p.second.baseType == UNIFORM_SAMPLER)
 		{
 			for (int i = 0; i < p.second.count; i++)
@@ -150,8 +161,10 @@ void Shader::mapActiveUniforms()
 			u.data = oldu->second.data;
 			u.dataSize = oldu->second.dataSize;
 			u.textures = oldu->second.textures;
+			u.uploadedData = oldu->second.uploadedData;
 
-			updateUniform(&u, u.count, true);
+			// The program is new, so what was uploaded before doesn't count.
+			uploadUniform(&u, u.count);
 		}
 		else
 		{
@@ -244,6 +257,13 @@ void Shader::mapActiveUniforms()
 					break;
 				}
 			}
+
+			if (u.dataSize > 0)
+			{
+				// The program now has the same values as our copy.
+				u.uploadedData = malloc(u.dataSize);
+				memcpy(u.uploadedData, u.data, u.dataSize);
+			}
 		}
 
 		uniforms[u.name] = u;
@@ -276,6 +296,7 @@ void Shader::mapActiveUniforms()
 		if (uniforms.find(p.first) == uniforms.end())
 		{
 			free(p.second.data);
+			free(p.second.uploadedData);
 
 			if (p.second.baseType != UNIFORM_SAMPLER)
 				continue;
@@ -293,10 +314,96 @@ void Shader::mapActiveUniforms()
 	gl.useProgram(activeprogram);
 }
 
+void Shader::mapActiveUniformBlocks()
+{
+	uniformBlocks.clear();
+
+	if (!gl.isUniformBufferSupported())
+		return;
+
+	GLint numblocks = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &numblocks);
+
+	GLchar cname[256];
+	const GLint bufsize = (GLint) (sizeof(cname) / sizeof(GLchar));
+
+	for (int bindex = 0; bindex < numblocks; bindex++)
+	{
+		GLsizei namelen = 0;
+		glGetActiveUniformBlockName(program, (GLuint) bindex, bufsize, &namelen, cname);
+
+		UniformBlockInfo block;
+		block.name = std::string(cname, (size_t) namelen);
+
+		GLint datasize = 0;
+		glGetActiveUniformBlockiv(program, (GLuint) bindex, GL_UNIFORM_BLOCK_DATA_SIZE, &datasize);
+		block.dataSize = (size_t) datasize;
+
+		block.binding = gl.getUniformBlockBinding(block.name, true);
+		if (block.binding < 0)
+			throw love::Exception("Too many different uniform block names are in use (the maximum is %d.)", gl.getMaxUniformBufferBindings());
+
+		glUniformBlockBinding(program, (GLuint) bindex, (GLuint) block.binding);
+
+		GLint nummembers = 0;
+		glGetActiveUniformBlockiv(program, (GLuint) bindex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &nummembers);
+
+		std::vector<GLint> indices(nummembers);
+		if (nummembers > 0)
+			glGetActiveUniformBlockiv(program, (GLuint) bindex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES, indices.data());
+
+		for (GLint index : indices)
+		{
+			GLuint uindex = (GLuint) index;
+			GLint offset = 0, arraystride = 0, matrixstride = 0, rowmajor = 0;
+			GLenum gltype = 0;
+
+			UniformBlockMember m = {};
+
+			glGetActiveUniform(program, uindex, bufsize, &namelen, &m.count, &gltype, cname);
+			glGetActiveUniformsiv(program, 1, &uindex, GL_UNIFORM_OFFSET, &offset);
+			glGetActiveUniformsiv(program, 1, &uindex, GL_UNIFORM_ARRAY_STRIDE, &arraystride);
+			glGetActiveUniformsiv(program, 1, &uindex, GL_UNIFORM_MATRIX_STRIDE, &matrixstride);
+			glGetActiveUniformsiv(program, 1, &uindex, GL_UNIFORM_IS_ROW_MAJOR, &rowmajor);
+
+			m.name = std::string(cname, (size_t) namelen);
+			m.baseType = getUniformBaseType(gltype);
+			m.offset = (size_t) offset;
+			m.arrayStride = (size_t) arraystride;
+			m.matrixStride = (size_t) matrixstride;
+			m.rowMajor = rowmajor != 0;
+
+			if (m.baseType == UNIFORM_MATRIX)
+				m.matrix = getMatrixSize(gltype);
+			else
+				m.components = getUniformTypeComponents(gltype);
+
+			if (m.name.length() > 3)
+			{
+				size_t findpos = m.name.find("[0]");
+				if (findpos != std::string::npos && findpos == m.name.length() - 3)
+					m.name.erase(m.name.length() - 3);
+			}
+
+			block.members.push_back(m);
+		}
+
+		uniformBlocks[block.name] = block;
+	}
+}
+
 bool Shader::loadVolatile()
 {
 	OpenGL::TempDebugGroup debuggroup("Shader load");
 
+	startLink();
+	finishLink();
+
+	return true;
+}
+
+void Shader::startLink()
+{
     // Recreating the shader program will invalidate uniforms that rely on these.
 	canvasWasActive = false;
     lastViewport = Rect();
@@ -339,6 +446,33 @@ bool Shader::loadVolatile()
 
 	glLinkProgram(program);
 
+	linking = true;
+}
+
+void Shader::finishLink()
+{
+	if (!linking)
+		return;
+
+	linking = false;
+
+	try
+	{
+		validateStages();
+
+		for (const auto &stage : stages)
+		{
+			if (stage.get() != nullptr)
+				((ShaderStage *) stage.get())->finishCompile();
+		}
+	}
+	catch (love::Exception &)
+	{
+		glDeleteProgram(program);
+		program = 0;
+		throw;
+	}
+
 	GLint status;
 	glGetProgramiv(program, GL_LINK_STATUS, &status);
 
@@ -352,6 +486,7 @@ bool Shader::loadVolatile()
 
 	// Get all active uniform variables in this shader from OpenGL.
 	mapActiveUniforms();
+	mapActiveUniformBlocks();
 
 	for (int i = 0; i < int(ATTRIB_MAX_ENUM); i++)
 	{
@@ -369,8 +504,6 @@ bool Shader::loadVolatile()
 		attach();
 		updateBuiltinUniforms();
 	}
-
-	return true;
 }
 
 void Shader::unloadVolatile()
@@ -384,6 +517,8 @@ void Shader::unloadVolatile()
 		program = 0;
 	}
 
+	linking = false;
+
 	// active texture list is probably invalid, clear it
 	textureUnits.clear();
 	textureUnits.push_back(TextureUnit());
@@ -436,8 +571,58 @@ std::string Shader::getWarnings() const
 	return warnings;
 }
 
+bool Shader::isReady()
+{
+	if (!asyncError.empty())
+		throw love::Exception("%s", asyncError.c_str());
+
+	if (!linking)
+		return true;
+
+	// glslang validation runs on worker threads, including linking the
+	// program when it isn't in the validation cache.
+	if (!isValidationFinished())
+		return false;
+
+	// Without the extension, the driver may block when we ask for the results.
+	if (GLAD_KHR_parallel_shader_compile || GLAD_ARB_parallel_shader_compile)
+	{
+		GLint complete = GL_FALSE;
+		glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+		if (complete == GL_FALSE)
+			return false;
+	}
+
+	waitUntilReady();
+	return true;
+}
+
+void Shader::waitUntilReady()
+{
+	if (!asyncError.empty())
+		throw love::Exception("%s", asyncError.c_str());
+
+	try
+	{
+		finishLink();
+	}
+	catch (love::Exception &e)
+	{
+		asyncError = e.what();
+		throw;
+	}
+}
+
 void Shader::attach()
 {
+	if (linking && fallback.get() != nullptr && !isReady())
+	{
+		fallback->attach();
+		return;
+	}
+
+	waitUntilReady();
+
 	if (current != this)
 	{
 		Graphics::flushStreamDrawsGlobal();
@@ -484,6 +669,20 @@ void Shader::updateUniform(const UniformInfo *info, int count)
 
 void Shader::updateUniform(const UniformInfo *info, int count, bool internalupdate)
 {
+	count = std::min(std::max(count, 1), info->count);
+
+	// Sending the same values again doesn't need to break the current batch
+	// or reach the driver at all.
+	if (info->uploadedData != nullptr)
+	{
+		size_t size = (info->dataSize / info->count) * count;
+		if (memcmp(info->data, info->uploadedData, size) == 0)
+		{
+			++gl.stats.uniformUpdatesSkipped;
+			return;
+		}
+	}
+
 	if (current != this && !internalupdate)
 	{
 		pendingUniformUpdates.push_back(std::make_pair(info, count));
@@ -493,6 +692,16 @@ void Shader::updateUniform(const UniformInfo *info, int count, bool internalupda
 	if (!internalupdate)
 		flushStreamDraws();
 
+	uploadUniform(info, count);
+}
+
+void Shader::uploadUniform(const UniformInfo *info, int count)
+{
+	++gl.stats.uniformUpdates;
+
+	if (info->uploadedData != nullptr)
+		memcpy(info->uploadedData, info->data, (info->dataSize / info->count) * count);
+
 	int location = info->location;
 	UniformType type = info->baseType;
 
@@ -588,11 +797,17 @@ void Shader::sendTextures(const UniformInfo *info, Texture **textures, int count
 
 	bool shaderactive = current == this;
 
+	count = std::min(count, info->count);
+
+	if (!internalUpdate && std::equal(textures, textures + count, info->textures))
+	{
+		++gl.stats.uniformUpdatesSkipped;
+		return;
+	}
+
 	if (!internalUpdate && shaderactive)
 		flushStreamDraws();
 
-	count = std::min(count, info->count);
-
 	// Bind the textures to the texture units.
 	for (int i = 0; i < count; i++)
 	{
@@ -665,6 +880,16 @@ bool Shader::hasUniform(const std::string &name) const
 	return uniforms.find(name) != uniforms.end();
 }
 
+const Shader::UniformBlockInfo *Shader::getUniformBlockInfo(const std::string &name) const
+{
+	const auto it = uniformBlocks.find(name);
+
+	if (it == uniformBlocks.end())
+		return nullptr;
+
+	return &(it->second);
+}
+
 ptrdiff_t Shader::getHandle() const
 {
 	return program;
@@ -708,8 +933,17 @@ void Shader::updateScreenParams()
 	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
 	bool canvasActive = gfx->isCanvasActive();
 
-	if ((view == lastViewport && canvasWasActive == canvasActive) || current != this)
+	if (current != this)
+		return;
+
+	GLint location = builtinUniforms[BUILTIN_SCREEN_SIZE];
+
+	if (view == lastViewport && canvasWasActive == canvasActive)
+	{
+		if (location >= 0)
+			++gl.stats.uniformUpdatesSkipped;
 		return;
+	}
 
 	// In the shader, we do pixcoord.y = gl_FragCoord.y * params.z + params.w.
 	// This lets us flip pixcoord.y when needed, to be consistent (drawing with
@@ -733,9 +967,11 @@ void Shader::updateScreenParams()
 		params[3] = (GLfloat) view.h;
 	}
 
-	GLint location = builtinUniforms[BUILTIN_SCREEN_SIZE];
 	if (location >= 0)
+	{
 		glUniform4fv(location, 1, params);
+		++gl.stats.uniformUpdates;
+	}
 
 	canvasWasActive = canvasActive;
 	lastViewport = view;
@@ -743,12 +979,23 @@ void Shader::updateScreenParams()
 
 void Shader::updatePointSize(float size)
 {
-	if (size == lastPointSize || current != this)
+	if (current != this)
 		return;
 
 	GLint location = builtinUniforms[BUILTIN_POINT_SIZE];
+
+	if (size == lastPointSize)
+	{
+		if (location >= 0)
+			++gl.stats.uniformUpdatesSkipped;
+		return;
+	}
+
 	if (location >= 0)
+	{
 		glUniform1f(location, size);
+		++gl.stats.uniformUpdates;
+	}
 
 	lastPointSize = size;
 }
@@ -768,14 +1015,18 @@ void Shader::updateBuiltinUniforms()
 	const Matrix4 &curproj = gfx->getProjection();
 	const Matrix4 &curxform = gfx->getTransform();
 
-	bool tpmatrixneedsupdate = false;
+	bool xformchanged = memcmp(curxform.getElements(), lastTransformMatrix.getElements(), sizeof(float) * 16) != 0;
+	bool projchanged = memcmp(curproj.getElements(), lastProjectionMatrix.getElements(), sizeof(float) * 16) != 0;
 
 	// Only upload the matrices if they've changed.
-	if (memcmp(curxform.getElements(), lastTransformMatrix.getElements(), sizeof(float) * 16) != 0)
+	if (xformchanged)
 	{
 		GLint location = builtinUniforms[BUILTIN_MATRIX_VIEW_FROM_LOCAL];
 		if (location >= 0)
+		{
 			glUniformMatrix4fv(location, 1, GL_FALSE, curxform.getElements());
+			++gl.stats.uniformUpdates;
+		}
 
 		// Also upload the re-calculated normal matrix, if possible. The normal
 		// matrix is the transpose of the inverse of the rotation portion
@@ -785,30 +1036,46 @@ void Shader::updateBuiltinUniforms()
 		{
 			Matrix3 normalmatrix = Matrix3(curxform).transposedInverse();
 			glUniformMatrix3fv(location, 1, GL_FALSE, normalmatrix.getElements());
+			++gl.stats.uniformUpdates;
 		}
 
-		tpmatrixneedsupdate = true;
 		lastTransformMatrix = curxform;
 	}
+	else
+	{
+		if (builtinUniforms[BUILTIN_MATRIX_VIEW_FROM_LOCAL] >= 0)
+			++gl.stats.uniformUpdatesSkipped;
+		if (builtinUniforms[BUILTIN_MATRIX_VIEW_NORMAL_FROM_LOCAL] >= 0)
+			++gl.stats.uniformUpdatesSkipped;
+	}
+
+	GLint projlocation = builtinUniforms[BUILTIN_MATRIX_CLIP_FROM_VIEW];
 
-	if (memcmp(curproj.getElements(), lastProjectionMatrix.getElements(), sizeof(float) * 16) != 0)
+	if (projchanged)
 	{
-		GLint location = builtinUniforms[BUILTIN_MATRIX_CLIP_FROM_VIEW];
-		if (location >= 0)
-			glUniformMatrix4fv(location, 1, GL_FALSE, curproj.getElements());
+		if (projlocation >= 0)
+		{
+			glUniformMatrix4fv(projlocation, 1, GL_FALSE, curproj.getElements());
+			++gl.stats.uniformUpdates;
+		}
 
-		tpmatrixneedsupdate = true;
 		lastProjectionMatrix = curproj;
 	}
+	else if (projlocation >= 0)
+		++gl.stats.uniformUpdatesSkipped;
+
+	GLint tplocation = builtinUniforms[BUILTIN_MATRIX_CLIP_FROM_LOCAL];
 
-	if (tpmatrixneedsupdate)
+	if (tplocation >= 0)
 	{
-		GLint location = builtinUniforms[BUILTIN_MATRIX_CLIP_FROM_LOCAL];
-		if (location >= 0)
+		if (xformchanged || projchanged)
 		{
 			Matrix4 tp_matrix(curproj, curxform);
-			glUniformMatrix4fv(location, 1, GL_FALSE, tp_matrix.getElements());
+			glUniformMatrix4fv(tplocation, 1, GL_FALSE, tp_matrix.getElements());
+			++gl.stats.uniformUpdates;
 		}
+		else
+			++gl.stats.uniformUpdatesSkipped;
 	}
 }
 
@@ -47,7 +47,7 @@ class Shader final : public love::graphics::Shader, public Volatile
 	 * Creates a new Shader using a list of source codes.
 	 * Source must contain either vertex or pixel shader code, or both.
 	 **/
-	Shader(love::graphics::ShaderStage *vertex, love::graphics::ShaderStage *pixel);
+	Shader(love::graphics::ShaderStage *vertex, love::graphics::ShaderStage *pixel, bool async);
 	virtual ~Shader();
 
 	// Implements Volatile
@@ -55,6 +55,9 @@ class Shader final : public love::graphics::Shader, public Volatile
 	void unloadVolatile() override;
 
 	// Implements Shader.
+	bool isReady() override;
+	void waitUntilReady() override;
+	std::string getCompileError() const override { return asyncError; }
 	void attach() override;
 	std::string getWarnings() const override;
 	int getVertexAttributeIndex(const std::string &name) override;
@@ -63,6 +66,7 @@ class Shader final : public love::graphics::Shader, public Volatile
 	void updateUniform(const UniformInfo *info, int count) override;
 	void sendTextures(const UniformInfo *info, Texture **textures, int count) override;
 	bool hasUniform(const std::string &name) const override;
+	const UniformBlockInfo *getUniformBlockInfo(const std::string &name) const override;
 	ptrdiff_t getHandle() const override;
 	void setVideoTextures(Texture *ytexture, Texture *cbtexture, Texture *crtexture) override;
 
@@ -85,7 +89,21 @@ class Shader final : public love::graphics::Shader, public Volatile
 	// Map active uniform names to their locations.
 	void mapActiveUniforms();
 
+	// Get the layout of each active uniform block and point it at the binding
+	// shared by all blocks with the same name.
+	void mapActiveUniformBlocks();
+
+	// Issues the link, which the driver may complete in the background.
+	void startLink();
+
+	// Checks compile and link results (blocking if needed) and gets the
+	// program's uniforms and attributes.
+	void finishLink();
+
 	void updateUniform(const UniformInfo *info, int count, bool internalupdate);
+
+	// Issues the glUniform call, regardless of what was uploaded previously.
+	void uploadUniform(const UniformInfo *info, int count);
 	void sendTextures(const UniformInfo *info, Texture **textures, int count, bool internalupdate);
 
 	int getUniformTypeComponents(GLenum type) const;
@@ -102,6 +120,12 @@ class Shader final : public love::graphics::Shader, public Volatile
 	// volatile
 	GLuint program;
 
+	// True between glLinkProgram and finishLink.
+	bool linking;
+
+	// Set if an async compile failed, so later queries fail the same way.
+	std::string asyncError;
+
 	// Location values for any built-in uniform variables.
 	GLint builtinUniforms[BUILTIN_MAX_ENUM];
 	UniformInfo *builtinUniformInfo[BUILTIN_MAX_ENUM];
@@ -114,6 +138,8 @@ class Shader final : public love::graphics::Shader, public Volatile
 	// Uniform location buffer map
 	std::map<std::string, UniformInfo> uniforms;
 
+	std::map<std::string, UniformBlockInfo> uniformBlocks;
+
 	// Texture unit pool for setting images
 	std::vector<TextureUnit> textureUnits;
 
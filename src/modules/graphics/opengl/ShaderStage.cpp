@@ -27,10 +27,13 @@ namespace graphics
 namespace opengl
 {
 
-ShaderStage::ShaderStage(love::graphics::Graphics *gfx, StageType stage, const std::string &source, bool gles, const std::string &cachekey)
-	: love::graphics::ShaderStage(gfx, stage, source, gles, cachekey)
+ShaderStage::ShaderStage(love::graphics::Graphics *gfx, StageType stage, const std::string &source, bool gles, const std::string &cachekey, bool deferValidation)
+	: love::graphics::ShaderStage(gfx, stage, source, gles, cachekey, deferValidation)
 	, glShader(0)
+	, compilePending(false)
 {
+	// The compile results are checked when a Shader links the stage, so
+	// drivers which compile in the background aren't forced to finish here.
 	loadVolatile();
 }
 
@@ -68,6 +71,19 @@ bool ShaderStage::loadVolatile()
 	glShaderSource(glShader, 1, (const GLchar **)&src, &srclen);
 	glCompileShader(glShader);
 
+	compilePending = true;
+
+	return true;
+}
+
+void ShaderStage::finishCompile()
+{
+	if (!compilePending)
+		return;
+
+	const char *typestr = "unknown";
+	getConstant(getStageType(), typestr);
+
 	GLint infologlen;
 	glGetShaderiv(glShader, GL_INFO_LOG_LENGTH, &infologlen);
 
@@ -83,13 +99,23 @@ bool ShaderStage::loadVolatile()
 	GLint status = GL_FALSE;
 	glGetShaderiv(glShader, GL_COMPILE_STATUS, &status);
 
+	compilePending = false;
+
 	if (status == GL_FALSE)
 	{
 		glDeleteShader(glShader);
+		glShader = 0;
+
+		// glslang's errors are more consistent than the driver's, so prefer
+		// them if validation is still running in the background.
+		waitForValidation();
+
+		// A later shader with the same source should get a fresh compile
+		// rather than this stage, which no longer has a shader object.
+		removeFromCache();
+
 		throw love::Exception("Cannot compile %s shader code:\n%s", typestr, warnings.c_str());
 	}
-
-	return true;
 }
 
 void ShaderStage::unloadVolatile()
@@ -98,6 +124,7 @@ void ShaderStage::unloadVolatile()
 		glDeleteShader(glShader);
 
 	glShader = 0;
+	compilePending = false;
 }
 
 } // opengl
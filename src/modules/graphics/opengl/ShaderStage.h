@@ -35,11 +35,17 @@ class ShaderStage final : public love::graphics::ShaderStage
 {
 public:
 
-	ShaderStage(love::graphics::Graphics *gfx, StageType stage, const std::string &source, bool gles, const std::string &cachekey);
+	ShaderStage(love::graphics::Graphics *gfx, StageType stage, const std::string &source, bool gles, const std::string &cachekey, bool deferValidation);
 	virtual ~ShaderStage();
 
 	ptrdiff_t getHandle() const override { return glShader; }
 
+	/**
+	 * Gets the driver's compile results, blocking if needed. Throws if the
+	 * stage failed to compile.
+	 **/
+	void finishCompile();
+
 	// Implements Volatile.
 	bool loadVolatile() override;
 	void unloadVolatile() override;
@@ -47,6 +53,7 @@ class ShaderStage final : public love::graphics::ShaderStage
 private:
 
 	GLuint glShader;
+	bool compilePending;
 
 }; // ShaderStage
 
@@ -154,6 +154,11 @@ class StreamBufferSubDataOrphan final : public love::graphics::StreamBuffer, pub
 		gl.bindBuffer(mode, vbo);
 		glBufferData(glMode, bufferSize, nullptr, GL_STREAM_DRAW);
 
+		// A bound pixel unpack buffer would turn the client memory pointers of
+		// textures loaded after this one into offsets into it.
+		if (mode == BUFFER_PIXEL_UNPACK)
+			gl.bindBuffer(mode, 0);
+
 		frameGPUReadOffset = 0;
 		orphan = false;
 
@@ -360,6 +365,11 @@ class StreamBufferPersistentMapSync final : public StreamBufferSync, public Vola
 		glBufferStorage(glMode, bufferSize * BUFFER_FRAMES, nullptr, storageflags);
 		data = (uint8 *) glMapBufferRange(glMode, 0, bufferSize * BUFFER_FRAMES, mapflags);
 
+		// A bound pixel unpack buffer would turn the client memory pointers of
+		// textures loaded after this one into offsets into it.
+		if (mode == BUFFER_PIXEL_UNPACK)
+			gl.bindBuffer(mode, 0);
+
 		frameGPUReadOffset = 0;
 		frameIndex = 0;
 
@@ -493,6 +503,19 @@ class StreamBufferPinnedMemory final : public StreamBufferSync, public Volatile
 
 love::graphics::StreamBuffer *CreateStreamBuffer(BufferType mode, size_t size)
 {
+	// Staging memory for texture uploads only needs pixel buffer support, not
+	// the core profile. Without it uploads read straight from client memory.
+	if (mode == BUFFER_PIXEL_UNPACK)
+	{
+		if (!gl.isPixelBufferSupported())
+			return new StreamBufferClientMemory(mode, size);
+
+		if ((GLAD_VERSION_4_4 || GLAD_ARB_buffer_storage) && !gl.bugs.clientWaitSyncStalls)
+			return new StreamBufferPersistentMapSync(mode, size);
+
+		return new StreamBufferSubDataOrphan(mode, size);
+	}
+
 	if (gl.isCoreProfile())
 	{
 		if (!gl.bugs.clientWaitSyncStalls)
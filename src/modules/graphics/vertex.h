@@ -59,6 +59,8 @@ enum BufferType
 {
 	BUFFER_VERTEX = 0,
 	BUFFER_INDEX,
+	BUFFER_UNIFORM,
+	BUFFER_PIXEL_UNPACK,
 	BUFFER_MAX_ENUM
 };
 
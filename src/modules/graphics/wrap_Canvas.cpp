@@ -86,14 +86,11 @@ int w_Canvas_renderTo(lua_State *L)
 	return 0;
 }
 
-int w_Canvas_newImageData(lua_State *L)
+static void luax_checkreadregion(lua_State *L, Canvas *canvas, int &slice, int &mipmap, Rect &rect)
 {
-	Canvas *canvas = luax_checkcanvas(L, 1);
-	love::image::Image *image = luax_getmodule<love::image::Image>(L, love::image::Image::type);
-
-	int slice = 0;
-	int mipmap = 0;
-	Rect rect = {0, 0, canvas->getPixelWidth(), canvas->getPixelHeight()};
+	slice = 0;
+	mipmap = 0;
+	rect = {0, 0, canvas->getPixelWidth(), canvas->getPixelHeight()};
 
 	if (canvas->getTextureType() != TEXTURE_2D)
 		slice = (int) luaL_checkinteger(L, 2) - 1;
@@ -107,6 +104,17 @@ int w_Canvas_newImageData(lua_State *L)
 		rect.w = (int) luaL_checkinteger(L, 6);
 		rect.h = (int) luaL_checkinteger(L, 7);
 	}
+}
+
+int w_Canvas_newImageData(lua_State *L)
+{
+	Canvas *canvas = luax_checkcanvas(L, 1);
+	love::image::Image *image = luax_getmodule<love::image::Image>(L, love::image::Image::type);
+
+	int slice = 0;
+	int mipmap = 0;
+	Rect rect;
+	luax_checkreadregion(L, canvas, slice, mipmap, rect);
 
 	love::image::ImageData *img = nullptr;
 	luax_catchexcept(L, [&](){ img = canvas->newImageData(image, slice, mipmap, rect); });
@@ -116,6 +124,24 @@ int w_Canvas_newImageData(lua_State *L)
 	return 1;
 }
 
+int w_Canvas_newImageDataAsync(lua_State *L)
+{
+	Canvas *canvas = luax_checkcanvas(L, 1);
+	love::image::Image *image = luax_getmodule<love::image::Image>(L, love::image::Image::type);
+
+	int slice = 0;
+	int mipmap = 0;
+	Rect rect;
+	luax_checkreadregion(L, canvas, slice, mipmap, rect);
+
+	Readback *readback = nullptr;
+	luax_catchexcept(L, [&](){ readback = canvas->newImageDataAsync(image, slice, mipmap, rect); });
+
+	luax_pushtype(L, readback);
+	readback->release();
+	return 1;
+}
+
 int w_Canvas_generateMipmaps(lua_State *L)
 {
 	Canvas *c = luax_checkcanvas(L, 1);
@@ -139,6 +165,7 @@ static const luaL_Reg w_Canvas_functions[] =
 	{ "getMSAA", w_Canvas_getMSAA },
 	{ "renderTo", w_Canvas_renderTo },
 	{ "newImageData", w_Canvas_newImageData },
+	{ "newImageDataAsync", w_Canvas_newImageDataAsync },
 	{ "generateMipmaps", w_Canvas_generateMipmaps },
 	{ "getMipmapMode", w_Canvas_getMipmapMode },
 	{ 0, 0 }
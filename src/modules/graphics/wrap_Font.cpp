@@ -213,6 +213,119 @@ int w_Font_hasGlyphs(lua_State *L)
 	return 1;
 }
 
+int w_Font_isSDF(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	luax_pushboolean(L, t->isSDF());
+	return 1;
+}
+
+int w_Font_hasShaping(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	luax_pushboolean(L, t->hasShaping());
+	return 1;
+}
+
+static void luax_checkcodepoints(lua_State *L, int startidx, Font::Codepoints &codepoints)
+{
+	int count = std::max(lua_gettop(L) - startidx + 1, 1);
+
+	for (int i = startidx; i < count + startidx; i++)
+	{
+		if (lua_type(L, i) == LUA_TSTRING)
+			Font::getCodepointsFromString(luax_checkstring(L, i), codepoints);
+		else
+			codepoints.push_back((uint32) luaL_checknumber(L, i));
+	}
+}
+
+int w_Font_preload(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	Font::Codepoints codepoints;
+	luax_catchexcept(L, [&]() {
+		luax_checkcodepoints(L, 2, codepoints);
+		t->preload(codepoints);
+	});
+	return 0;
+}
+
+int w_Font_preloadAsync(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	Font::Codepoints codepoints;
+	luax_catchexcept(L, [&]() {
+		luax_checkcodepoints(L, 2, codepoints);
+		t->preloadAsync(codepoints);
+	});
+	return 0;
+}
+
+int w_Font_isPreloaded(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	bool preloaded = false;
+	luax_catchexcept(L, [&]() { preloaded = t->isPreloaded(); });
+	luax_pushboolean(L, preloaded);
+	return 1;
+}
+
+int w_Font_setAtlasBudget(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	lua_Number bytes = luaL_checknumber(L, 2);
+	if (bytes < 0)
+		return luaL_error(L, "Atlas budget must not be negative.");
+	t->setAtlasBudget((size_t) bytes);
+	return 0;
+}
+
+int w_Font_getAtlasBudget(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	lua_pushnumber(L, (lua_Number) t->getAtlasBudget());
+	return 1;
+}
+
+int w_Font_compactAtlas(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	luax_catchexcept(L, [&]() { t->compactAtlas(); });
+	return 0;
+}
+
+int w_Font_getAtlasStats(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	Font::AtlasStats stats = t->getAtlasStats();
+
+	if (lua_istable(L, 2))
+		lua_pushvalue(L, 2);
+	else
+		lua_createtable(L, 0, 6);
+
+	lua_pushinteger(L, stats.textures);
+	lua_setfield(L, -2, "textures");
+
+	lua_pushinteger(L, stats.glyphs);
+	lua_setfield(L, -2, "glyphs");
+
+	lua_pushnumber(L, (lua_Number) stats.textureMemory);
+	lua_setfield(L, -2, "texturememory");
+
+	lua_pushnumber(L, stats.occupancy);
+	lua_setfield(L, -2, "occupancy");
+
+	lua_pushinteger(L, stats.evictions);
+	lua_setfield(L, -2, "evictions");
+
+	lua_pushinteger(L, stats.compactions);
+	lua_setfield(L, -2, "compactions");
+
+	return 1;
+}
+
 int w_Font_getKerning(lua_State *L)
 {
 	Font *t = luax_checkfont(L, 1);
@@ -270,8 +383,17 @@ static const luaL_Reg w_Font_functions[] =
 	{ "getBaseline", w_Font_getBaseline },
 	{ "hasGlyphs", w_Font_hasGlyphs },
 	{ "getKerning", w_Font_getKerning },
+	{ "preload", w_Font_preload },
+	{ "preloadAsync", w_Font_preloadAsync },
+	{ "isPreloaded", w_Font_isPreloaded },
+	{ "setAtlasBudget", w_Font_setAtlasBudget },
+	{ "getAtlasBudget", w_Font_getAtlasBudget },
+	{ "compactAtlas", w_Font_compactAtlas },
+	{ "getAtlasStats", w_Font_getAtlasStats },
 	{ "setFallbacks", w_Font_setFallbacks },
 	{ "getDPIScale", w_Font_getDPIScale },
+	{ "isSDF", w_Font_isSDF },
+	{ "hasShaping", w_Font_hasShaping },
 	{ 0, 0 }
 };
 
@@ -711,6 +711,7 @@ static Image::Settings w__optImageSettings(lua_State *L, int idx, bool &setdpisc
 
 		s.mipmaps = luax_boolflag(L, idx, Image::getConstant(Image::SETTING_MIPMAPS), s.mipmaps);
 		s.linear = luax_boolflag(L, idx, Image::getConstant(Image::SETTING_LINEAR), s.linear);
+		s.deferred = luax_boolflag(L, idx, Image::getConstant(Image::SETTING_DEFERRED), s.deferred);
 
 		lua_getfield(L, idx, Image::getConstant(Image::SETTING_DPI_SCALE));
 		if (lua_isnumber(L, -1))
@@ -724,6 +725,39 @@ static Image::Settings w__optImageSettings(lua_State *L, int idx, bool &setdpisc
 	return s;
 }
 
+// LTEX files are laid out for direct upload, so they're memory-mapped rather
+// than read into memory when loaded by filename.
+static bool isMappedTextureFilename(lua_State *L, int idx)
+{
+	if (lua_type(L, idx) != LUA_TSTRING)
+		return false;
+
+	std::string filename = lua_tostring(L, idx);
+	std::string ext;
+
+	size_t dotpos = filename.rfind('.');
+
+	if (dotpos != std::string::npos)
+		ext = filename.substr(dotpos + 1);
+
+	std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+
+	return ext == "ltex";
+}
+
+// Uncompressed LTEX files are parsed as CompressedImageData, so they upload
+// straight from the file. Where an ImageData is needed instead (e.g. to split
+// it into cube faces), their base level is copied into one. Returns null for
+// actually compressed data. Other containers (e.g. DDS) keep their mipmaps as
+// CompressedImageData and aren't converted.
+static image::ImageData *getBaseImageData(image::CompressedImageData *cdata)
+{
+	if (isPixelFormatCompressed(cdata->getFormat()))
+		return nullptr;
+
+	return new image::ImageData(cdata->getWidth(0), cdata->getHeight(0), cdata->getFormat(), cdata->getData(0), false);
+}
+
 static std::pair<StrongRef<image::ImageData>, StrongRef<image::CompressedImageData>>
 getImageData(lua_State *L, int idx, bool allowcompressed, float *dpiscale)
 {
@@ -741,15 +775,32 @@ getImageData(lua_State *L, int idx, bool allowcompressed, float *dpiscale)
 		if (imagemodule == nullptr)
 			luaL_error(L, "Cannot load images without the love.image module.");
 
-		StrongRef<Data> fdata(filesystem::luax_getdata(L, idx), Acquire::NORETAIN);
+		auto fs = Module::getInstance<filesystem::Filesystem>(Module::M_FILESYSTEM);
+
+		bool mapped = fs != nullptr && isMappedTextureFilename(L, idx);
+
+		StrongRef<Data> fdata;
+		if (mapped)
+			luax_catchexcept(L, [&]() { fdata.set(fs->mapFile(lua_tostring(L, idx)), Acquire::NORETAIN); });
+		else
+			fdata.set(filesystem::luax_getdata(L, idx), Acquire::NORETAIN);
 
 		if (dpiscale != nullptr)
 			parseDPIScale(fdata, dpiscale);
 
-		if (allowcompressed && imagemodule->isCompressed(fdata))
+		// LTEX files can only be parsed as CompressedImageData.
+		if ((allowcompressed || mapped) && imagemodule->isCompressed(fdata))
 			luax_catchexcept(L, [&]() { cdata.set(imagemodule->newCompressedData(fdata), Acquire::NORETAIN); });
 		else
 			luax_catchexcept(L, [&]() { idata.set(imagemodule->newImageData(fdata), Acquire::NORETAIN); });
+
+		if (!allowcompressed && cdata.get() != nullptr)
+		{
+			luax_catchexcept(L, [&]() { idata.set(getBaseImageData(cdata), Acquire::NORETAIN); });
+			if (idata.get() == nullptr)
+				luaL_error(L, "Compressed LTEX textures can only be used where compressed images are supported.");
+			cdata.set(nullptr);
+		}
 	}
 	else
 		idata.set(image::luax_checkimagedata(L, idx));
@@ -783,10 +834,16 @@ int w_newCubeImage(lua_State *L)
 
 	if (!lua_istable(L, 1))
 	{
+		bool ltex = isMappedTextureFilename(L, 1);
 		auto data = getImageData(L, 1, true, autodpiscale);
 
 		std::vector<StrongRef<love::image::ImageData>> faces;
 
+		// A single uncompressed LTEX file is split into faces like any other
+		// image file.
+		if (ltex && data.second.get())
+			luax_catchexcept(L, [&](){ data.first.set(getBaseImageData(data.second), Acquire::NORETAIN); });
+
 		if (data.first.get())
 		{
 			luax_catchexcept(L, [&](){ faces = imagemodule->newCubeFaces(data.first); });
@@ -983,8 +1040,14 @@ int w_newVolumeImage(lua_State *L)
 	}
 	else
 	{
+		bool ltex = isMappedTextureFilename(L, 1);
 		auto data = getImageData(L, 1, true, autodpiscale);
 
+		// A single uncompressed LTEX file is split into layers like any other
+		// image file.
+		if (ltex && data.second.get())
+			luax_catchexcept(L, [&](){ data.first.set(getBaseImageData(data.second), Acquire::NORETAIN); });
+
 		if (data.first.get())
 		{
 			std::vector<StrongRef<love::image::ImageData>> layers;
@@ -1391,6 +1454,47 @@ int w_newShader(lua_State *L)
 	return 1;
 }
 
+int w_newShaderAsync(lua_State *L)
+{
+	bool gles = instance()->getRenderer() == Graphics::RENDERER_OPENGLES;
+
+	// The fallback Shader comes after the source code arguments.
+	Shader *fallback = nullptr;
+	for (int i = 2; i <= 3; i++)
+	{
+		if (luax_istype(L, i, Shader::type))
+		{
+			fallback = luax_checkshader(L, i);
+			break;
+		}
+	}
+
+	std::string vertexsource, pixelsource;
+	w_getShaderSource(L, 1, gles, vertexsource, pixelsource);
+
+	bool should_error = false;
+	try
+	{
+		Shader *shader = instance()->newShaderAsync(vertexsource, pixelsource, fallback);
+		luax_pushtype(L, shader);
+		shader->release();
+	}
+	catch (love::Exception &e)
+	{
+		luax_getfunction(L, "graphics", "_transformGLSLErrorMessages");
+		lua_pushstring(L, e.what());
+
+		// Function pushes the new error string onto the stack.
+		lua_pcall(L, 1, 1, 0);
+		should_error = true;
+	}
+
+	if (should_error)
+		return lua_error(L);
+
+	return 1;
+}
+
 int w_validateShader(lua_State *L)
 {
 	bool gles = luax_checkboolean(L, 1);
@@ -1421,6 +1525,76 @@ int w_validateShader(lua_State *L)
 	return 1;
 }
 
+int w_setShaderValidationDeferred(lua_State *L)
+{
+	instance()->setShaderValidationDeferred(luax_checkboolean(L, 1));
+	return 0;
+}
+
+int w_isShaderValidationDeferred(lua_State *L)
+{
+	luax_pushboolean(L, instance()->isShaderValidationDeferred());
+	return 1;
+}
+
+int w_setTextureUploadBudget(lua_State *L)
+{
+	lua_Number bytes = luaL_checknumber(L, 1);
+	if (bytes < 0)
+		return luaL_error(L, "Texture upload budget must not be negative.");
+
+	instance()->setTextureUploadBudget((size_t) bytes);
+	return 0;
+}
+
+int w_getTextureUploadBudget(lua_State *L)
+{
+	lua_pushnumber(L, (lua_Number) instance()->getTextureUploadBudget());
+	return 1;
+}
+
+int w_saveShaderValidationCache(lua_State *L)
+{
+	auto fs = Module::getInstance<love::filesystem::Filesystem>(Module::M_FILESYSTEM);
+	if (fs == nullptr)
+		return luaL_error(L, "love.filesystem is not loaded.");
+
+	const char *filename = luaL_checkstring(L, 1);
+	std::string data = instance()->getShaderValidationCacheData();
+
+	luax_catchexcept(L, [&](){ fs->write(filename, data.data(), (int64) data.size()); });
+	return 0;
+}
+
+int w_loadShaderValidationCache(lua_State *L)
+{
+	using namespace love::filesystem;
+
+	auto fs = Module::getInstance<Filesystem>(Module::M_FILESYSTEM);
+
+	// A missing cache file is expected the first time a game is run.
+	if (lua_isstring(L, 1))
+	{
+		Filesystem::Info info = {};
+		if (fs == nullptr || !fs->getInfo(lua_tostring(L, 1), info))
+		{
+			luax_pushboolean(L, false);
+			return 1;
+		}
+	}
+
+	FileData *fd = luax_getfiledata(L, 1);
+
+	bool success = false;
+	luax_catchexcept(L,
+		[&]() { success = instance()->loadShaderValidationCacheData((const char *) fd->getData(), fd->getSize()); },
+		[&](bool) { fd->release(); }
+	);
+
+	luax_pushboolean(L, success);
+	return 1;
+}
+
 static vertex::Usage luax_optmeshusage(lua_State *L, int idx, vertex::Usage def)
 {
 	const char *usagestr = lua_isnoneornil(L, idx) ? nullptr : luaL_checkstring(L, idx);
@@ -1661,6 +1835,76 @@ int w_newText(lua_State *L)
 	return 1;
 }
 
+int w_newUniformBuffer(lua_State *L)
+{
+	luax_checkgraphicscreated(L);
+
+	Shader *shader = luax_checkshader(L, 1);
+	std::string blockname = luax_checkstring(L, 2);
+	vertex::Usage usage = luax_optmeshusage(L, 3, vertex::USAGE_DYNAMIC);
+
+	UniformBuffer *buffer = nullptr;
+	luax_catchexcept(L, [&]() { buffer = instance()->newUniformBuffer(shader, blockname, usage); });
+
+	luax_pushtype(L, buffer);
+	buffer->release();
+	return 1;
+}
+
+int w_newVirtualTexture(lua_State *L)
+{
+	luax_checkgraphicscreated(L);
+
+	// Page files are named by a pattern, so the total size must be given.
+	bool pattern = lua_isstring(L, 1) && lua_isnumber(L, 2);
+	int startidx = pattern ? 4 : 2;
+
+	VirtualTexture::Settings settings;
+
+	if (!lua_isnoneornil(L, startidx))
+	{
+		luaL_checktype(L, startidx, LUA_TTABLE);
+
+		settings.pageSize = luax_intflag(L, startidx, "pagesize", settings.pageSize);
+		settings.border = luax_intflag(L, startidx, "border", settings.border);
+		settings.cacheSize = luax_intflag(L, startidx, "cachesize", settings.cacheSize);
+		settings.maxUploads = luax_intflag(L, startidx, "maxuploads", settings.maxUploads);
+		settings.maxLoads = luax_intflag(L, startidx, "maxloads", settings.maxLoads);
+		settings.linear = luax_boolflag(L, startidx, "linear", settings.linear);
+
+		lua_getfield(L, startidx, "format");
+		if (!lua_isnoneornil(L, -1))
+		{
+			const char *str = luaL_checkstring(L, -1);
+			if (!getConstant(str, settings.format))
+				return luax_enumerror(L, "pixel format", str);
+		}
+		lua_pop(L, 1);
+	}
+
+	VirtualTexture *vt = nullptr;
+
+	if (pattern)
+	{
+		std::string str = luax_checkstring(L, 1);
+		int width = (int) luaL_checkinteger(L, 2);
+		int height = (int) luaL_checkinteger(L, 3);
+		luax_catchexcept(L, [&]() { vt = instance()->newVirtualTexture(str, width, height, settings); });
+	}
+	else
+	{
+		love::filesystem::FileData *fd = love::filesystem::luax_getfiledata(L, 1);
+		luax_catchexcept(L,
+			[&]() { vt = instance()->newVirtualTexture(fd, settings); },
+			[&](bool) { fd->release(); }
+		);
+	}
+
+	luax_pushtype(L, vt);
+	vt->release();
+	return 1;
+}
+
 int w_newVideo(lua_State *L)
 {
 	luax_checkgraphicscreated(L);
@@ -2083,7 +2327,7 @@ int w_setShader(lua_State *L)
 	}
 
 	Shader *shader = luax_checkshader(L, 1);
-	instance()->setShader(shader);
+	luax_catchexcept(L, [&]() { instance()->setShader(shader); });
 	return 0;
 }
 
@@ -2098,6 +2342,30 @@ int w_getShader(lua_State *L)
 	return 1;
 }
 
+int w_setUniformBuffer(lua_State *L)
+{
+	std::string blockname = luax_checkstring(L, 1);
+	UniformBuffer *buffer = nullptr;
+
+	if (!lua_isnoneornil(L, 2))
+		buffer = luax_checkuniformbuffer(L, 2);
+
+	luax_catchexcept(L, [&]() { instance()->setUniformBuffer(blockname, buffer); });
+	return 0;
+}
+
+int w_getUniformBuffer(lua_State *L)
+{
+	std::string blockname = luax_checkstring(L, 1);
+	UniformBuffer *buffer = instance()->getUniformBuffer(blockname);
+	if (buffer)
+		luax_pushtype(L, buffer);
+	else
+		lua_pushnil(L);
+
+	return 1;
+}
+
 int w_setDefaultShaderCode(lua_State *L)
 {
 	for (int i = 0; i < 2; i++)
@@ -2116,13 +2384,15 @@ int w_setDefaultShaderCode(lua_State *L)
 			lua_getfield(L, -2, "pixel");
 			lua_getfield(L, -3, "videopixel");
 			lua_getfield(L, -4, "arraypixel");
+			lua_getfield(L, -5, "sdfpixel");
 
-			std::string vertex = luax_checkstring(L, -4);
-			std::string pixel = luax_checkstring(L, -3);
-			std::string videopixel = luax_checkstring(L, -2);
-			std::string arraypixel = luax_checkstring(L, -1);
+			std::string vertex = luax_checkstring(L, -5);
+			std::string pixel = luax_checkstring(L, -4);
+			std::string videopixel = luax_checkstring(L, -3);
+			std::string arraypixel = luax_checkstring(L, -2);
+			std::string sdfpixel = luax_checkstring(L, -1);
 
-			lua_pop(L, 5);
+			lua_pop(L, 6);
 
 			Graphics::defaultShaderCode[Shader::STANDARD_DEFAULT][lang][i].source[ShaderStage::STAGE_VERTEX] = vertex;
 			Graphics::defaultShaderCode[Shader::STANDARD_DEFAULT][lang][i].source[ShaderStage::STAGE_PIXEL] = pixel;
@@ -2132,6 +2402,9 @@ int w_setDefaultShaderCode(lua_State *L)
 
 			Graphics::defaultShaderCode[Shader::STANDARD_ARRAY][lang][i].source[ShaderStage::STAGE_VERTEX] = vertex;
 			Graphics::defaultShaderCode[Shader::STANDARD_ARRAY][lang][i].source[ShaderStage::STAGE_PIXEL] = arraypixel;
+
+			Graphics::defaultShaderCode[Shader::STANDARD_SDF][lang][i].source[ShaderStage::STAGE_VERTEX] = vertex;
+			Graphics::defaultShaderCode[Shader::STANDARD_SDF][lang][i].source[ShaderStage::STAGE_PIXEL] = sdfpixel;
 		}
 	}
 
@@ -2300,7 +2573,7 @@ int w_getStats(lua_State *L)
 	if (lua_istable(L, 1))
 		lua_pushvalue(L, 1);
 	else
-		lua_createtable(L, 0, 7);
+		lua_createtable(L, 0, 10);
 
 	lua_pushinteger(L, stats.drawCalls);
 	lua_setfield(L, -2, "drawcalls");
@@ -2314,6 +2587,12 @@ int w_getStats(lua_State *L)
 	lua_pushinteger(L, stats.shaderSwitches);
 	lua_setfield(L, -2, "shaderswitches");
 
+	lua_pushinteger(L, stats.uniformUpdates);
+	lua_setfield(L, -2, "uniformupdates");
+
+	lua_pushinteger(L, stats.uniformUpdatesSkipped);
+	lua_setfield(L, -2, "uniformupdatesskipped");
+
 	lua_pushinteger(L, stats.canvases);
 	lua_setfield(L, -2, "canvases");
 
@@ -2924,11 +3203,20 @@ static const luaL_Reg functions[] =
 	{ "newParticleSystem", w_newParticleSystem },
 	{ "newCanvas", w_newCanvas },
 	{ "newShader", w_newShader },
+	{ "newShaderAsync", w_newShaderAsync },
 	{ "newMesh", w_newMesh },
 	{ "newText", w_newText },
+	{ "newUniformBuffer", w_newUniformBuffer },
+	{ "newVirtualTexture", w_newVirtualTexture },
 	{ "_newVideo", w_newVideo },
 
 	{ "validateShader", w_validateShader },
+	{ "setShaderValidationDeferred", w_setShaderValidationDeferred },
+	{ "isShaderValidationDeferred", w_isShaderValidationDeferred },
+	{ "saveShaderValidationCache", w_saveShaderValidationCache },
+	{ "setTextureUploadBudget", w_setTextureUploadBudget },
+	{ "getTextureUploadBudget", w_getTextureUploadBudget },
+	{ "loadShaderValidationCache", w_loadShaderValidationCache },
 
 	{ "setCanvas", w_setCanvas },
 	{ "getCanvas", w_getCanvas },
@@ -2969,6 +3257,8 @@ static const luaL_Reg functions[] =
 
 	{ "setShader", w_setShader },
 	{ "getShader", w_getShader },
+	{ "setUniformBuffer", w_setUniformBuffer },
+	{ "getUniformBuffer", w_getUniformBuffer },
 	{ "_setDefaultShaderCode", w_setDefaultShaderCode },
 
 	{ "getSupported", w_getSupported },
@@ -3049,7 +3339,10 @@ static const lua_CFunction types[] =
 	luaopen_spritebatch,
 	luaopen_particlesystem,
 	luaopen_canvas,
+	luaopen_readback,
 	luaopen_shader,
+	luaopen_uniformbuffer,
+	luaopen_virtualtexture,
 	luaopen_mesh,
 	luaopen_text,
 	luaopen_video,
@@ -28,7 +28,10 @@
 #include "wrap_SpriteBatch.h"
 #include "wrap_ParticleSystem.h"
 #include "wrap_Canvas.h"
+#include "wrap_Readback.h"
 #include "wrap_Shader.h"
+#include "wrap_UniformBuffer.h"
+#include "wrap_VirtualTexture.h"
 #include "wrap_Mesh.h"
 #include "wrap_Text.h"
 #include "wrap_Video.h"
@@ -463,6 +463,18 @@ void effect() {
 uniform ArrayImage MainTex;
 void effect() {
 	love_PixelColor = Texel(MainTex, VaryingTexCoord.xyz) * VaryingColor;
+}]],
+	-- Signed distance field fonts store the distance in alpha, 0.5 on the edge.
+	sdfpixel = [[
+vec4 effect(vec4 vcolor, Image tex, vec2 texcoord, vec2 pixcoord) {
+	vec4 texel = Texel(tex, texcoord);
+#if !defined(GL_ES) || __VERSION__ >= 300
+	float width = max(fwidth(texel.a) * 0.7, 0.001);
+#else
+	float width = 0.0625; // No derivatives without an extension.
+#endif
+	texel.a = smoothstep(0.5 - width, 0.5 + width, texel.a);
+	return texel * vcolor;
 }]],
 }
 
@@ -484,6 +496,7 @@ for lang, info in pairs(langs) do
 			pixel = createShaderStageCode("PIXEL", defaultcode.pixel, info.target, info.gles, false, gammacorrect, false),
 			videopixel = createShaderStageCode("PIXEL", defaultcode.videopixel, info.target, info.gles, false, gammacorrect, true),
 			arraypixel = createShaderStageCode("PIXEL", defaultcode.arraypixel, info.target, info.gles, false, gammacorrect, true),
+			sdfpixel = createShaderStageCode("PIXEL", defaultcode.sdfpixel, info.target, info.gles, false, gammacorrect, false),
 		}
 	end
 end
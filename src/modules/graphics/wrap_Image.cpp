@@ -45,6 +45,13 @@ int w_Image_isCompressed(lua_State *L)
 	return 1;
 }
 
+int w_Image_isReady(lua_State *L)
+{
+	Image *i = luax_checkimage(L, 1);
+	luax_pushboolean(L, i->isReady());
+	return 1;
+}
+
 int w_Image_replacePixels(lua_State *L)
 {
 	Image *i = luax_checkimage(L, 1);
@@ -78,6 +85,7 @@ static const luaL_Reg w_Image_functions[] =
 {
 	{ "isFormatLinear", w_Image_isFormatLinear },
 	{ "isCompressed", w_Image_isCompressed },
+	{ "isReady", w_Image_isReady },
 	{ "replacePixels", w_Image_replacePixels },
 	{ 0, 0 }
 };
@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "wrap_Readback.h"
+
+namespace love
+{
+namespace graphics
+{
+
+Readback *luax_checkreadback(lua_State *L, int idx)
+{
+	return luax_checktype<Readback>(L, idx);
+}
+
+int w_Readback_isComplete(lua_State *L)
+{
+	Readback *readback = luax_checkreadback(L, 1);
+	bool complete = false;
+	luax_catchexcept(L, [&]() { complete = readback->isComplete(); });
+	luax_pushboolean(L, complete);
+	return 1;
+}
+
+int w_Readback_wait(lua_State *L)
+{
+	Readback *readback = luax_checkreadback(L, 1);
+	love::image::ImageData *data = nullptr;
+	luax_catchexcept(L, [&]() { data = readback->wait(); });
+	luax_pushtype(L, data);
+	return 1;
+}
+
+int w_Readback_getImageData(lua_State *L)
+{
+	Readback *readback = luax_checkreadback(L, 1);
+	love::image::ImageData *data = readback->getImageData();
+	if (data)
+		luax_pushtype(L, data);
+	else
+		lua_pushnil(L);
+	return 1;
+}
+
+static const luaL_Reg w_Readback_functions[] =
+{
+	{ "isComplete", w_Readback_isComplete },
+	{ "wait", w_Readback_wait },
+	{ "getImageData", w_Readback_getImageData },
+	{ 0, 0 }
+};
+
+extern "C" int luaopen_readback(lua_State *L)
+{
+	return luax_register_type(L, &Readback::type, w_Readback_functions, nullptr);
+}
+
+} // graphics
+} // love
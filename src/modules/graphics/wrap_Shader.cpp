@@ -39,9 +39,18 @@ Shader *luax_checkshader(lua_State *L, int idx)
 	return luax_checktype<Shader>(L, idx);
 }
 
+// Uniform information is only available once the shader has been linked, so
+// async shaders need to finish compiling first.
+static Shader *luax_checkreadyshader(lua_State *L, int idx)
+{
+	Shader *shader = luax_checkshader(L, idx);
+	luax_catchexcept(L, [&]() { shader->waitUntilReady(); });
+	return shader;
+}
+
 int w_Shader_getWarnings(lua_State *L)
 {
-	Shader *shader = luax_checkshader(L, 1);
+	Shader *shader = luax_checkreadyshader(L, 1);
 	std::string warnings = shader->getWarnings();
 	lua_pushstring(L, warnings.c_str());
 	return 1;
@@ -77,7 +86,7 @@ static void _updateNumbers(lua_State *L, int startidx, T *values, int components
 	}
 }
 
-int w_Shader_sendFloats(lua_State *L, int startidx, Shader *shader, const Shader::UniformInfo *info, bool colors)
+static int w_Shader_sendFloats(lua_State *L, int startidx, const UniformUpdateFunc &update, const Shader::UniformInfo *info, bool colors)
 {
 	int count = _getCount(L, startidx, info);
 	int components = info->components;
@@ -100,27 +109,27 @@ int w_Shader_sendFloats(lua_State *L, int startidx, Shader *shader, const Shader
 		}
 	}
 
-	luax_catchexcept(L, [&]() { shader->updateUniform(info, count); });
+	luax_catchexcept(L, [&]() { update(info, count); });
 	return 0;
 }
 
-int w_Shader_sendInts(lua_State *L, int startidx, Shader *shader, const Shader::UniformInfo *info)
+static int w_Shader_sendInts(lua_State *L, int startidx, const UniformUpdateFunc &update, const Shader::UniformInfo *info)
 {
 	int count = _getCount(L, startidx, info);
 	_updateNumbers<int, lua_Integer, luaL_checkinteger>(L, startidx, info->ints, info->components, count);
-	luax_catchexcept(L, [&]() { shader->updateUniform(info, count); });
+	luax_catchexcept(L, [&]() { update(info, count); });
 	return 0;
 }
 
-int w_Shader_sendUnsignedInts(lua_State *L, int startidx, Shader *shader, const Shader::UniformInfo *info)
+static int w_Shader_sendUnsignedInts(lua_State *L, int startidx, const UniformUpdateFunc &update, const Shader::UniformInfo *info)
 {
 	int count = _getCount(L, startidx, info);
 	_updateNumbers<unsigned int, lua_Integer, luaL_checkinteger>(L, startidx, info->uints, info->components, count);
-	luax_catchexcept(L, [&]() { shader->updateUniform(info, count); });
+	luax_catchexcept(L, [&]() { update(info, count); });
 	return 0;
 }
 
-int w_Shader_sendBooleans(lua_State *L, int startidx, Shader *shader, const Shader::UniformInfo *info)
+static int w_Shader_sendBooleans(lua_State *L, int startidx, const UniformUpdateFunc &update, const Shader::UniformInfo *info)
 {
 	int count = _getCount(L, startidx, info);
 	int components = info->components;
@@ -153,11 +162,11 @@ int w_Shader_sendBooleans(lua_State *L, int startidx, Shader *shader, const Shad
 		}
 	}
 
-	luax_catchexcept(L, [&]() { shader->updateUniform(info, count); });
+	luax_catchexcept(L, [&]() { update(info, count); });
 	return 0;
 }
 
-int w_Shader_sendMatrices(lua_State *L, int startidx, Shader *shader, const Shader::UniformInfo *info)
+static int w_Shader_sendMatrices(lua_State *L, int startidx, const UniformUpdateFunc &update, const Shader::UniformInfo *info)
 {
 	bool columnmajor = false;
 
@@ -264,11 +273,11 @@ int w_Shader_sendMatrices(lua_State *L, int startidx, Shader *shader, const Shad
 		}
 	}
 
-	shader->updateUniform(info, count);
+	luax_catchexcept(L, [&]() { update(info, count); });
 	return 0;
 }
 
-int w_Shader_sendTextures(lua_State *L, int startidx, Shader *shader, const Shader::UniformInfo *info)
+static int w_Shader_sendTextures(lua_State *L, int startidx, Shader *shader, const Shader::UniformInfo *info)
 {
 	int count = _getCount(L, startidx, info);
 
@@ -287,28 +296,26 @@ int w_Shader_sendTextures(lua_State *L, int startidx, Shader *shader, const Shad
 	return 0;
 }
 
-static int w_Shader_sendLuaValues(lua_State *L, int startidx, Shader *shader, const Shader::UniformInfo *info, const char *name)
+static int w_Shader_sendLuaValues(lua_State *L, int startidx, const UniformUpdateFunc &update, const Shader::UniformInfo *info, const char *name)
 {
 	switch (info->baseType)
 	{
 	case Shader::UNIFORM_FLOAT:
-		return w_Shader_sendFloats(L, startidx, shader, info, false);
+		return w_Shader_sendFloats(L, startidx, update, info, false);
 	case Shader::UNIFORM_MATRIX:
-		return w_Shader_sendMatrices(L, startidx, shader, info);
+		return w_Shader_sendMatrices(L, startidx, update, info);
 	case Shader::UNIFORM_INT:
-		return w_Shader_sendInts(L, startidx, shader, info);
+		return w_Shader_sendInts(L, startidx, update, info);
 	case Shader::UNIFORM_UINT:
-		return w_Shader_sendUnsignedInts(L, startidx, shader, info);
+		return w_Shader_sendUnsignedInts(L, startidx, update, info);
 	case Shader::UNIFORM_BOOL:
-		return w_Shader_sendBooleans(L, startidx, shader, info);
-	case Shader::UNIFORM_SAMPLER:
-		return w_Shader_sendTextures(L, startidx, shader, info);
+		return w_Shader_sendBooleans(L, startidx, update, info);
 	default:
 		return luaL_error(L, "Unknown variable type for shader uniform '%s", name);
 	}
 }
 
-static int w_Shader_sendData(lua_State *L, int startidx, Shader *shader, const Shader::UniformInfo *info, bool colors)
+static int w_Shader_sendData(lua_State *L, int startidx, const UniformUpdateFunc &update, const Shader::UniformInfo *info, bool colors)
 {
 	if (info->baseType == Shader::UNIFORM_SAMPLER)
 		return luaL_error(L, "Uniform sampler values (textures) cannot be sent to Shaders via Data objects.");
@@ -416,13 +423,23 @@ static int w_Shader_sendData(lua_State *L, int startidx, Shader *shader, const S
 		}
 	}
 
-	shader->updateUniform(info, count);
+	luax_catchexcept(L, [&]() { update(info, count); });
 	return 0;
 }
 
+int luax_senduniform(lua_State *L, int startidx, const Shader::UniformInfo *info, bool colors, const UniformUpdateFunc &update)
+{
+	if (luax_istype(L, startidx, Data::type) || (info->baseType == Shader::UNIFORM_MATRIX && luax_istype(L, startidx + 1, Data::type)))
+		return w_Shader_sendData(L, startidx, update, info, colors);
+	else if (colors)
+		return w_Shader_sendFloats(L, startidx, update, info, true);
+	else
+		return w_Shader_sendLuaValues(L, startidx, update, info, info->name.c_str());
+}
+
 int w_Shader_send(lua_State *L)
 {
-	Shader *shader = luax_checkshader(L, 1);
+	Shader *shader = luax_checkreadyshader(L, 1);
 	const char *name = luaL_checkstring(L, 2);
 
 	const Shader::UniformInfo *info = shader->getUniformInfo(name);
@@ -431,15 +448,18 @@ int w_Shader_send(lua_State *L)
 
 	int startidx = 3;
 
-	if (luax_istype(L, startidx, Data::type) || (info->baseType == Shader::UNIFORM_MATRIX && luax_istype(L, startidx + 1, Data::type)))
-		return w_Shader_sendData(L, startidx, shader, info, false);
-	else
-		return w_Shader_sendLuaValues(L, startidx, shader, info, name);
+	if (info->baseType == Shader::UNIFORM_SAMPLER && !luax_istype(L, startidx, Data::type))
+		return w_Shader_sendTextures(L, startidx, shader, info);
+
+	return luax_senduniform(L, startidx, info, false, [shader](const Shader::UniformInfo *u, int count)
+	{
+		shader->updateUniform(u, count);
+	});
 }
 
 int w_Shader_sendColors(lua_State *L)
 {
-	Shader *shader = luax_checkshader(L, 1);
+	Shader *shader = luax_checkreadyshader(L, 1);
 	const char *name = luaL_checkstring(L, 2);
 
 	const Shader::UniformInfo *info = shader->getUniformInfo(name);
@@ -449,26 +469,60 @@ int w_Shader_sendColors(lua_State *L)
 	if (info->baseType != Shader::UNIFORM_FLOAT || info->components < 3)
 		return luaL_error(L, "sendColor can only be used on vec3 or vec4 uniforms.");
 
-	if (luax_istype(L, 3, Data::type))
-		return w_Shader_sendData(L, 3, shader, info, true);
-	else
-		return w_Shader_sendFloats(L, 3, shader, info, true);
+	return luax_senduniform(L, 3, info, true, [shader](const Shader::UniformInfo *u, int count)
+	{
+		shader->updateUniform(u, count);
+	});
 }
 
 int w_Shader_hasUniform(lua_State *L)
 {
-	Shader *shader = luax_checkshader(L, 1);
+	Shader *shader = luax_checkreadyshader(L, 1);
 	const char *name = luaL_checkstring(L, 2);
 	luax_pushboolean(L, shader->hasUniform(name));
 	return 1;
 }
 
+int w_Shader_isReady(lua_State *L)
+{
+	Shader *shader = luax_checkshader(L, 1);
+	bool ready = false;
+	luax_catchexcept(L, [&]() { ready = shader->isReady(); });
+	luax_pushboolean(L, ready);
+	return 1;
+}
+
+int w_Shader_getCompileError(lua_State *L)
+{
+	Shader *shader = luax_checkshader(L, 1);
+	std::string err = shader->getCompileError();
+	if (err.empty())
+		lua_pushnil(L);
+	else
+		luax_pushstring(L, err);
+	return 1;
+}
+
+int w_Shader_getFallback(lua_State *L)
+{
+	Shader *shader = luax_checkshader(L, 1);
+	Shader *fallback = shader->getFallback();
+	if (fallback)
+		luax_pushtype(L, fallback);
+	else
+		lua_pushnil(L);
+	return 1;
+}
+
 static const luaL_Reg w_Shader_functions[] =
 {
 	{ "getWarnings", w_Shader_getWarnings },
 	{ "send",        w_Shader_send },
 	{ "sendColor",   w_Shader_sendColors },
 	{ "hasUniform",  w_Shader_hasUniform },
+	{ "isReady",     w_Shader_isReady },
+	{ "getCompileError", w_Shader_getCompileError },
+	{ "getFallback", w_Shader_getFallback },
 	{ 0, 0 }
 };
 
@@ -24,12 +24,24 @@
 #include "common/config.h"
 #include "Shader.h"
 
+// C++
+#include <functional>
+
 namespace love
 {
 namespace graphics
 {
 
+// Receives a uniform's values once they have been read from Lua into its data.
+typedef std::function<void(const Shader::UniformInfo *info, int count)> UniformUpdateFunc;
+
 Shader *luax_checkshader(lua_State *L, int idx);
+
+/**
+ * Reads non-sampler uniform values (as Lua values or a Data object) starting
+ * at the given stack index, and passes them on to 'update'.
+ **/
+int luax_senduniform(lua_State *L, int startidx, const Shader::UniformInfo *info, bool colors, const UniformUpdateFunc &update);
 extern "C" int luaopen_shader(lua_State *L);
 
 } // graphics
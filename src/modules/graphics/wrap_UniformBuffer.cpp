@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "wrap_UniformBuffer.h"
+#include "wrap_Shader.h"
+#include "common/Data.h"
+
+namespace love
+{
+namespace graphics
+{
+
+UniformBuffer *luax_checkuniformbuffer(lua_State *L, int idx)
+{
+	return luax_checktype<UniformBuffer>(L, idx);
+}
+
+static const Shader::UniformInfo *luax_checkblockuniform(lua_State *L, UniformBuffer *buffer, const char *name)
+{
+	const Shader::UniformInfo *info = buffer->getUniformInfo(name);
+	if (info == nullptr)
+		luaL_error(L, "Uniform block '%s' has no variable named '%s'.", buffer->getBlockName().c_str(), name);
+	return info;
+}
+
+int w_UniformBuffer_send(lua_State *L)
+{
+	UniformBuffer *buffer = luax_checkuniformbuffer(L, 1);
+	const char *name = luaL_checkstring(L, 2);
+	const Shader::UniformInfo *info = luax_checkblockuniform(L, buffer, name);
+
+	return luax_senduniform(L, 3, info, false, [buffer](const Shader::UniformInfo *u, int count)
+	{
+		buffer->updateUniform(u, count);
+	});
+}
+
+int w_UniformBuffer_sendColor(lua_State *L)
+{
+	UniformBuffer *buffer = luax_checkuniformbuffer(L, 1);
+	const char *name = luaL_checkstring(L, 2);
+	const Shader::UniformInfo *info = luax_checkblockuniform(L, buffer, name);
+
+	if (info->baseType != Shader::UNIFORM_FLOAT || info->components < 3)
+		return luaL_error(L, "sendColor can only be used on vec3 or vec4 uniforms.");
+
+	return luax_senduniform(L, 3, info, true, [buffer](const Shader::UniformInfo *u, int count)
+	{
+		buffer->updateUniform(u, count);
+	});
+}
+
+int w_UniformBuffer_setData(lua_State *L)
+{
+	UniformBuffer *buffer = luax_checkuniformbuffer(L, 1);
+	Data *data = luax_checktype<Data>(L, 2);
+
+	lua_Integer offset = luaL_optinteger(L, 3, 0);
+	if (offset < 0)
+		return luaL_error(L, "Offset cannot be negative.");
+
+	lua_Integer size = luaL_optinteger(L, 4, (lua_Integer) data->getSize());
+	if (size <= 0 || (size_t) size > data->getSize())
+		return luaL_error(L, "Invalid size for the given Data.");
+
+	luax_catchexcept(L, [&]() { buffer->setData((size_t) offset, (size_t) size, data->getData()); });
+	return 0;
+}
+
+int w_UniformBuffer_hasUniform(lua_State *L)
+{
+	UniformBuffer *buffer = luax_checkuniformbuffer(L, 1);
+	const char *name = luaL_checkstring(L, 2);
+	luax_pushboolean(L, buffer->hasUniform(name));
+	return 1;
+}
+
+int w_UniformBuffer_getBlockName(lua_State *L)
+{
+	UniformBuffer *buffer = luax_checkuniformbuffer(L, 1);
+	luax_pushstring(L, buffer->getBlockName());
+	return 1;
+}
+
+int w_UniformBuffer_getSize(lua_State *L)
+{
+	UniformBuffer *buffer = luax_checkuniformbuffer(L, 1);
+	lua_pushinteger(L, (lua_Integer) buffer->getSize());
+	return 1;
+}
+
+static const luaL_Reg w_UniformBuffer_functions[] =
+{
+	{ "send", w_UniformBuffer_send },
+	{ "sendColor", w_UniformBuffer_sendColor },
+	{ "setData", w_UniformBuffer_setData },
+	{ "hasUniform", w_UniformBuffer_hasUniform },
+	{ "getBlockName", w_UniformBuffer_getBlockName },
+	{ "getSize", w_UniformBuffer_getSize },
+	{ 0, 0 }
+};
+
+extern "C" int luaopen_uniformbuffer(lua_State *L)
+{
+	return luax_register_type(L, &UniformBuffer::type, w_UniformBuffer_functions, nullptr);
+}
+
+} // graphics
+} // love
@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "wrap_VirtualTexture.h"
+#include "image/wrap_ImageData.h"
+
+namespace love
+{
+namespace graphics
+{
+
+VirtualTexture *luax_checkvirtualtexture(lua_State *L, int idx)
+{
+	return luax_checktype<VirtualTexture>(L, idx);
+}
+
+int w_VirtualTexture_requestPage(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	int x = (int) luaL_checkinteger(L, 2);
+	int y = (int) luaL_checkinteger(L, 3);
+	luax_catchexcept(L, [&]() { vt->requestPage(x, y); });
+	return 0;
+}
+
+int w_VirtualTexture_requestRegion(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+
+	Rect rect;
+	rect.x = (int) luaL_checkinteger(L, 2);
+	rect.y = (int) luaL_checkinteger(L, 3);
+	rect.w = (int) luaL_checkinteger(L, 4);
+	rect.h = (int) luaL_checkinteger(L, 5);
+
+	vt->requestRegion(rect);
+	return 0;
+}
+
+int w_VirtualTexture_requestFeedback(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	love::image::ImageData *feedback = love::image::luax_checkimagedata(L, 2);
+	luax_catchexcept(L, [&]() { vt->requestFeedback(feedback); });
+	return 0;
+}
+
+int w_VirtualTexture_update(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	int uploaded = 0;
+	luax_catchexcept(L, [&]() { uploaded = vt->update(); });
+	lua_pushinteger(L, uploaded);
+	return 1;
+}
+
+int w_VirtualTexture_isPageResident(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	int x = (int) luaL_checkinteger(L, 2);
+	int y = (int) luaL_checkinteger(L, 3);
+	luax_pushboolean(L, vt->isPageResident(x, y));
+	return 1;
+}
+
+int w_VirtualTexture_getDimensions(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	lua_pushinteger(L, vt->getWidth());
+	lua_pushinteger(L, vt->getHeight());
+	return 2;
+}
+
+int w_VirtualTexture_getPageSize(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	lua_pushinteger(L, vt->getPageSize());
+	return 1;
+}
+
+int w_VirtualTexture_getPageBorder(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	lua_pushinteger(L, vt->getPageBorder());
+	return 1;
+}
+
+int w_VirtualTexture_getPageCount(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	lua_pushinteger(L, vt->getPageCountX());
+	lua_pushinteger(L, vt->getPageCountY());
+	return 2;
+}
+
+int w_VirtualTexture_getCacheSize(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	lua_pushinteger(L, vt->getCacheSize());
+	return 1;
+}
+
+int w_VirtualTexture_getResidentCount(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	lua_pushinteger(L, vt->getResidentCount());
+	return 1;
+}
+
+int w_VirtualTexture_getPendingCount(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	lua_pushinteger(L, vt->getPendingCount());
+	return 1;
+}
+
+int w_VirtualTexture_getPageImage(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	luax_pushtype(L, vt->getPageImage());
+	return 1;
+}
+
+int w_VirtualTexture_getIndirectionImage(lua_State *L)
+{
+	VirtualTexture *vt = luax_checkvirtualtexture(L, 1);
+	luax_pushtype(L, vt->getIndirectionImage());
+	return 1;
+}
+
+static const luaL_Reg w_VirtualTexture_functions[] =
+{
+	{ "requestPage", w_VirtualTexture_requestPage },
+	{ "requestRegion", w_VirtualTexture_requestRegion },
+	{ "requestFeedback", w_VirtualTexture_requestFeedback },
+	{ "update", w_VirtualTexture_update },
+	{ "isPageResident", w_VirtualTexture_isPageResident },
+	{ "getDimensions", w_VirtualTexture_getDimensions },
+	{ "getPageSize", w_VirtualTexture_getPageSize },
+	{ "getPageBorder", w_VirtualTexture_getPageBorder },
+	{ "getPageCount", w_VirtualTexture_getPageCount },
+	{ "getCacheSize", w_VirtualTexture_getCacheSize },
+	{ "getResidentCount", w_VirtualTexture_getResidentCount },
+	{ "getPendingCount", w_VirtualTexture_getPendingCount },
+	{ "getPageImage", w_VirtualTexture_getPageImage },
+	{ "getIndirectionImage", w_VirtualTexture_getIndirectionImage },
+	{ 0, 0 }
+};
+
+extern "C" int luaopen_virtualtexture(lua_State *L)
+{
+	return luax_register_type(L, &VirtualTexture::type, w_VirtualTexture_functions, nullptr);
+}
+
+} // graphics
+} // love
@@ -0,0 +1,999 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "BlockCompressor.h"
+#include "common/Exception.h"
+#include "thread/WorkerPool.h"
+
+// C++
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+
+namespace love
+{
+namespace image
+{
+
+namespace
+{
+
+// Four pixels wide, four tall, RGBA.
+typedef uint8 Block[64];
+
+inline int clampByte(int v)
+{
+	return std::min(std::max(v, 0), 255);
+}
+
+inline int clampByte(float v)
+{
+	return std::min(std::max((int) (v + 0.5f), 0), 255);
+}
+
+inline void writeLE16(uint8 *dst, uint32 v)
+{
+	dst[0] = (uint8) (v & 0xFF);
+	dst[1] = (uint8) ((v >> 8) & 0xFF);
+}
+
+inline void writeLE(uint8 *dst, uint64 v, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+		dst[i] = (uint8) (v >> (i * 8));
+}
+
+inline void writeBE64(uint8 *dst, uint64 v)
+{
+	for (int i = 0; i < 8; i++)
+		dst[i] = (uint8) (v >> (56 - i * 8));
+}
+
+/**
+ * Finds the mean and principal axis of the first N channels of the given
+ * pixels (those with a nonzero mask entry, if a mask is given). Returns false
+ * if every pixel is the same.
+ **/
+template <int N>
+bool principalAxis(const Block block, const bool *mask, float mean[N], float axis[N])
+{
+	int count = 0;
+	for (int c = 0; c < N; c++)
+		mean[c] = 0.0f;
+
+	for (int i = 0; i < 16; i++)
+	{
+		if (mask && !mask[i])
+			continue;
+		for (int c = 0; c < N; c++)
+			mean[c] += block[i * 4 + c];
+		count++;
+	}
+
+	if (count == 0)
+		return false;
+
+	for (int c = 0; c < N; c++)
+		mean[c] /= count;
+
+	float cov[N][N] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		if (mask && !mask[i])
+			continue;
+		float d[N];
+		for (int c = 0; c < N; c++)
+			d[c] = block[i * 4 + c] - mean[c];
+		for (int a = 0; a < N; a++)
+		{
+			for (int b = 0; b < N; b++)
+				cov[a][b] += d[a] * d[b];
+		}
+	}
+
+	// Power iteration, starting from the channel with the most variance.
+	int start = 0;
+	for (int c = 1; c < N; c++)
+	{
+		if (cov[c][c] > cov[start][start])
+			start = c;
+	}
+
+	if (cov[start][start] < 1e-4f)
+		return false;
+
+	for (int c = 0; c < N; c++)
+		axis[c] = cov[start][c];
+
+	for (int iter = 0; iter < 8; iter++)
+	{
+		float next[N] = {};
+		for (int a = 0; a < N; a++)
+		{
+			for (int b = 0; b < N; b++)
+				next[a] += cov[a][b] * axis[b];
+		}
+
+		float len = 0.0f;
+		for (int c = 0; c < N; c++)
+			len += next[c] * next[c];
+
+		if (len < 1e-12f)
+			break;
+
+		len = 1.0f / sqrtf(len);
+		for (int c = 0; c < N; c++)
+			axis[c] = next[c] * len;
+	}
+
+	return true;
+}
+
+/**
+ * Finds the endpoints of a line through the pixels along the principal axis,
+ * pulled in slightly so the ends of the palette aren't wasted on outliers.
+ **/
+template <int N>
+void fitEndpoints(const Block block, const bool *mask, float e0[N], float e1[N])
+{
+	float mean[N];
+	float axis[N];
+
+	if (!principalAxis<N>(block, mask, mean, axis))
+	{
+		for (int c = 0; c < N; c++)
+			e0[c] = e1[c] = mean[c];
+		return;
+	}
+
+	float tmin = 1e30f;
+	float tmax = -1e30f;
+
+	for (int i = 0; i < 16; i++)
+	{
+		if (mask && !mask[i])
+			continue;
+		float t = 0.0f;
+		for (int c = 0; c < N; c++)
+			t += (block[i * 4 + c] - mean[c]) * axis[c];
+		tmin = std::min(tmin, t);
+		tmax = std::max(tmax, t);
+	}
+
+	float inset = (tmax - tmin) / 32.0f;
+	tmin += inset;
+	tmax -= inset;
+
+	for (int c = 0; c < N; c++)
+	{
+		e0[c] = std::min(std::max(mean[c] + axis[c] * tmin, 0.0f), 255.0f);
+		e1[c] = std::min(std::max(mean[c] + axis[c] * tmax, 0.0f), 255.0f);
+	}
+}
+
+/**
+ * Solves for the endpoints which best reproduce the pixels, given how far
+ * along the line each pixel was placed. Returns false if the system is
+ * degenerate (e.g. every pixel uses the same weight).
+ **/
+template <int N>
+bool refineEndpoints(const Block block, const bool *mask, const float weights[16], float e0[N], float e1[N])
+{
+	float a = 0.0f, b = 0.0f, c = 0.0f;
+	float x0[N] = {};
+	float x1[N] = {};
+
+	for (int i = 0; i < 16; i++)
+	{
+		if (mask && !mask[i])
+			continue;
+
+		float t = weights[i];
+		float s = 1.0f - t;
+		a += s * s;
+		b += s * t;
+		c += t * t;
+
+		for (int ch = 0; ch < N; ch++)
+		{
+			x0[ch] += s * block[i * 4 + ch];
+			x1[ch] += t * block[i * 4 + ch];
+		}
+	}
+
+	float det = a * c - b * b;
+	if (fabsf(det) < 1e-6f)
+		return false;
+
+	det = 1.0f / det;
+
+	for (int ch = 0; ch < N; ch++)
+	{
+		e0[ch] = std::min(std::max((c * x0[ch] - b * x1[ch]) * det, 0.0f), 255.0f);
+		e1[ch] = std::min(std::max((a * x1[ch] - b * x0[ch]) * det, 0.0f), 255.0f);
+	}
+
+	return true;
+}
+
+template <int N>
+int colorDistance(const uint8 *a, const uint8 *b)
+{
+	int d = 0;
+	for (int c = 0; c < N; c++)
+		d += (a[c] - b[c]) * (a[c] - b[c]);
+	return d;
+}
+
+/*
+ * BC1 (DXT1) color
+ */
+
+inline uint32 packRGB565(const float c[3])
+{
+	uint32 r = (uint32) clampByte(c[0] * 31.0f / 255.0f);
+	uint32 g = (uint32) clampByte(c[1] * 63.0f / 255.0f);
+	uint32 b = (uint32) clampByte(c[2] * 31.0f / 255.0f);
+	return (std::min(r, 31u) << 11) | (std::min(g, 63u) << 5) | std::min(b, 31u);
+}
+
+inline void unpackRGB565(uint32 v, uint8 *c)
+{
+	uint32 r = (v >> 11) & 31;
+	uint32 g = (v >> 5) & 63;
+	uint32 b = v & 31;
+	c[0] = (uint8) ((r << 3) | (r >> 2));
+	c[1] = (uint8) ((g << 2) | (g >> 4));
+	c[2] = (uint8) ((b << 3) | (b >> 2));
+	c[3] = 255;
+}
+
+struct BC1Result
+{
+	uint32 c0;
+	uint32 c1;
+	uint32 indices;
+	int error;
+};
+
+// Picks the nearest palette entry for each pixel. Transparent pixels (when
+// threecolor is used for punch-through alpha) always get index 3.
+BC1Result assignBC1(const Block block, const bool *opaque, uint32 c0, uint32 c1, bool threecolor)
+{
+	uint8 palette[4][4];
+	unpackRGB565(c0, palette[0]);
+	unpackRGB565(c1, palette[1]);
+
+	int count = threecolor ? 3 : 4;
+
+	for (int c = 0; c < 3; c++)
+	{
+		if (threecolor)
+		{
+			palette[2][c] = (uint8) ((palette[0][c] + palette[1][c]) / 2);
+			palette[3][c] = 0;
+		}
+		else
+		{
+			palette[2][c] = (uint8) ((2 * palette[0][c] + palette[1][c]) / 3);
+			palette[3][c] = (uint8) ((palette[0][c] + 2 * palette[1][c]) / 3);
+		}
+	}
+
+	BC1Result result = {c0, c1, 0, 0};
+
+	for (int i = 0; i < 16; i++)
+	{
+		if (opaque && !opaque[i])
+		{
+			result.indices |= 3u << (i * 2);
+			continue;
+		}
+
+		int best = 0;
+		int besterror = colorDistance<3>(&block[i * 4], palette[0]);
+		for (int p = 1; p < count; p++)
+		{
+			int error = colorDistance<3>(&block[i * 4], palette[p]);
+			if (error < besterror)
+			{
+				best = p;
+				besterror = error;
+			}
+		}
+
+		result.indices |= (uint32) best << (i * 2);
+		result.error += besterror;
+	}
+
+	return result;
+}
+
+// Orders the endpoints for the requested mode and assigns indices.
+BC1Result encodeBC1Endpoints(const Block block, const bool *opaque, uint32 c0, uint32 c1, bool threecolor)
+{
+	// Four-color mode is selected by c0 > c1, three-color mode by c0 <= c1.
+	if ((threecolor && c0 > c1) || (!threecolor && c0 < c1))
+		std::swap(c0, c1);
+
+	if (!threecolor && c0 == c1)
+	{
+		// Every palette entry is the same color anyway.
+		BC1Result result = {c0, c1, 0, 0};
+		for (int i = 0; i < 16; i++)
+		{
+			uint8 color[4];
+			unpackRGB565(c0, color);
+			result.error += colorDistance<3>(&block[i * 4], color);
+		}
+		return result;
+	}
+
+	return assignBC1(block, opaque, c0, c1, threecolor);
+}
+
+void encodeBC1(const Block block, uint8 *dst, bool allowalpha)
+{
+	bool opaque[16];
+	bool threecolor = false;
+	bool anyopaque = false;
+
+	for (int i = 0; i < 16; i++)
+	{
+		opaque[i] = !allowalpha || block[i * 4 + 3] >= 128;
+		threecolor = threecolor || !opaque[i];
+		anyopaque = anyopaque || opaque[i];
+	}
+
+	if (!anyopaque)
+	{
+		writeLE16(dst + 0, 0);
+		writeLE16(dst + 2, 0);
+		writeLE(dst + 4, 0xFFFFFFFF, 4);
+		return;
+	}
+
+	const bool *mask = threecolor ? opaque : nullptr;
+
+	float e0[3], e1[3];
+	fitEndpoints<3>(block, mask, e0, e1);
+
+	BC1Result best = encodeBC1Endpoints(block, mask, packRGB565(e0), packRGB565(e1), threecolor);
+
+	// One least squares pass over the weights implied by the chosen indices.
+	if (best.c0 != best.c1 && best.error > 0)
+	{
+		static const float fourweights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+		static const float threeweights[4] = {0.0f, 1.0f, 0.5f, 0.0f};
+		const float *table = threecolor ? threeweights : fourweights;
+
+		float weights[16];
+		for (int i = 0; i < 16; i++)
+			weights[i] = table[(best.indices >> (i * 2)) & 3];
+
+		if (refineEndpoints<3>(block, mask, weights, e0, e1))
+		{
+			BC1Result refined = encodeBC1Endpoints(block, mask, packRGB565(e0), packRGB565(e1), threecolor);
+			if (refined.error < best.error)
+				best = refined;
+		}
+	}
+
+	writeLE16(dst + 0, best.c0);
+	writeLE16(dst + 2, best.c1);
+	writeLE(dst + 4, best.indices, 4);
+}
+
+/*
+ * BC4-style alpha, as used by BC3 (DXT5)
+ */
+
+void encodeBC3Alpha(const Block block, uint8 *dst)
+{
+	int amin = 255;
+	int amax = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		amin = std::min(amin, (int) block[i * 4 + 3]);
+		amax = std::max(amax, (int) block[i * 4 + 3]);
+	}
+
+	uint64 bits = (uint64) amax | ((uint64) amin << 8);
+
+	if (amin != amax)
+	{
+		// a0 > a1 selects the eight value mode.
+		int palette[8];
+		palette[0] = amax;
+		palette[1] = amin;
+		for (int i = 1; i <= 6; i++)
+			palette[i + 1] = ((7 - i) * amax + i * amin + 3) / 7;
+
+		for (int i = 0; i < 16; i++)
+		{
+			int a = block[i * 4 + 3];
+			int best = 0;
+			int besterror = 256;
+			for (int p = 0; p < 8; p++)
+			{
+				int error = abs(a - palette[p]);
+				if (error < besterror)
+				{
+					best = p;
+					besterror = error;
+				}
+			}
+			bits |= (uint64) best << (16 + i * 3);
+		}
+	}
+
+	writeLE(dst, bits, 8);
+}
+
+/*
+ * BC7, mode 6 only: one subset, RGBA endpoints with per-endpoint p-bits and
+ * 4-bit indices. It handles color and alpha together, which suits most
+ * runtime-generated content.
+ */
+
+const int bc7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+class BitWriter
+{
+public:
+
+	BitWriter(uint8 *dst)
+		: dst(dst)
+		, pos(0)
+	{
+		memset(dst, 0, 16);
+	}
+
+	void write(uint32 value, int bits)
+	{
+		for (int i = 0; i < bits; i++, pos++)
+		{
+			if (value & (1u << i))
+				dst[pos / 8] |= (uint8) (1u << (pos % 8));
+		}
+	}
+
+private:
+
+	uint8 *dst;
+	int pos;
+
+}; // BitWriter
+
+// Quantizes an endpoint to 7 bits per channel plus a shared p-bit.
+void quantizeBC7Endpoint(const float e[4], uint8 q[4], uint32 &pbit)
+{
+	int besterror = 0x7FFFFFFF;
+
+	for (uint32 p = 0; p < 2; p++)
+	{
+		uint8 candidate[4];
+		int error = 0;
+		for (int c = 0; c < 4; c++)
+		{
+			int v = std::min(std::max((int) ((e[c] - p) / 2.0f + 0.5f), 0), 127);
+			candidate[c] = (uint8) v;
+			int d = ((v << 1) | (int) p) - (int) (e[c] + 0.5f);
+			error += d * d;
+		}
+
+		if (error < besterror)
+		{
+			besterror = error;
+			pbit = p;
+			memcpy(q, candidate, 4);
+		}
+	}
+}
+
+struct BC7Result
+{
+	uint8 q0[4];
+	uint8 q1[4];
+	uint32 p0;
+	uint32 p1;
+	uint8 indices[16];
+	int error;
+};
+
+BC7Result assignBC7(const Block block, const float e0[4], const float e1[4])
+{
+	BC7Result result;
+	quantizeBC7Endpoint(e0, result.q0, result.p0);
+	quantizeBC7Endpoint(e1, result.q1, result.p1);
+
+	uint8 palette[16][4];
+	for (int c = 0; c < 4; c++)
+	{
+		int a = (result.q0[c] << 1) | (int) result.p0;
+		int b = (result.q1[c] << 1) | (int) result.p1;
+		for (int i = 0; i < 16; i++)
+			palette[i][c] = (uint8) (((64 - bc7Weights4[i]) * a + bc7Weights4[i] * b + 32) >> 6);
+	}
+
+	result.error = 0;
+
+	for (int i = 0; i < 16; i++)
+	{
+		int best = 0;
+		int besterror = colorDistance<4>(&block[i * 4], palette[0]);
+		for (int p = 1; p < 16; p++)
+		{
+			int error = colorDistance<4>(&block[i * 4], palette[p]);
+			if (error < besterror)
+			{
+				best = p;
+				besterror = error;
+			}
+		}
+
+		result.indices[i] = (uint8) best;
+		result.error += besterror;
+	}
+
+	return result;
+}
+
+void encodeBC7(const Block block, uint8 *dst)
+{
+	float e0[4], e1[4];
+	fitEndpoints<4>(block, nullptr, e0, e1);
+
+	BC7Result best = assignBC7(block, e0, e1);
+
+	if (best.error > 0)
+	{
+		float weights[16];
+		for (int i = 0; i < 16; i++)
+			weights[i] = bc7Weights4[best.indices[i]] / 64.0f;
+
+		if (refineEndpoints<4>(block, nullptr, weights, e0, e1))
+		{
+			BC7Result refined = assignBC7(block, e0, e1);
+			if (refined.error < best.error)
+				best = refined;
+		}
+	}
+
+	// The first pixel's index is stored with its top bit implied to be zero,
+	// so swap the endpoints if it's in the upper half.
+	if (best.indices[0] >= 8)
+	{
+		std::swap(best.q0, best.q1);
+		std::swap(best.p0, best.p1);
+		for (int i = 0; i < 16; i++)
+			best.indices[i] = (uint8) (15 - best.indices[i]);
+	}
+
+	BitWriter writer(dst);
+	writer.write(1u << 6, 7);
+
+	for (int c = 0; c < 4; c++)
+	{
+		writer.write(best.q0[c], 7);
+		writer.write(best.q1[c], 7);
+	}
+
+	writer.write(best.p0, 1);
+	writer.write(best.p1, 1);
+
+	writer.write(best.indices[0], 3);
+	for (int i = 1; i < 16; i++)
+		writer.write(best.indices[i], 4);
+}
+
+/*
+ * ETC1, which is also a valid ETC2 RGB block since only the individual and
+ * differential modes are used.
+ */
+
+const int etcModifiers[8][2] =
+{
+	{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183},
+};
+
+// Index order in the block: +a, +b, -a, -b.
+inline int etcModifier(int table, int index)
+{
+	int m = etcModifiers[table][index & 1];
+	return (index & 2) ? -m : m;
+}
+
+struct ETCSubblock
+{
+	int table;
+	uint32 indices[8];
+	int error;
+};
+
+// Pixels of each half-block, in (x, y) pairs, for each flip mode.
+void getETCSubblockPixels(int flip, int half, int pixels[8][2])
+{
+	for (int i = 0; i < 8; i++)
+	{
+		if (flip)
+		{
+			pixels[i][0] = i % 4;
+			pixels[i][1] = half * 2 + i / 4;
+		}
+		else
+		{
+			pixels[i][0] = half * 2 + i / 4;
+			pixels[i][1] = i % 4;
+		}
+	}
+}
+
+ETCSubblock fitETCSubblock(const Block block, const int pixels[8][2], const int base[3])
+{
+	ETCSubblock best;
+	best.error = 0x7FFFFFFF;
+
+	for (int table = 0; table < 8; table++)
+	{
+		ETCSubblock candidate;
+		candidate.table = table;
+		candidate.error = 0;
+
+		for (int i = 0; i < 8 && candidate.error < best.error; i++)
+		{
+			const uint8 *p = &block[(pixels[i][1] * 4 + pixels[i][0]) * 4];
+			int besterror = 0x7FFFFFFF;
+
+			for (int index = 0; index < 4; index++)
+			{
+				int m = etcModifier(table, index);
+				int error = 0;
+				for (int c = 0; c < 3; c++)
+				{
+					int d = clampByte(base[c] + m) - p[c];
+					error += d * d;
+				}
+
+				if (error < besterror)
+				{
+					besterror = error;
+					candidate.indices[i] = (uint32) index;
+				}
+			}
+
+			candidate.error += besterror;
+		}
+
+		if (candidate.error < best.error)
+			best = candidate;
+	}
+
+	return best;
+}
+
+void averageETCSubblock(const Block block, const int pixels[8][2], float avg[3])
+{
+	avg[0] = avg[1] = avg[2] = 0.0f;
+	for (int i = 0; i < 8; i++)
+	{
+		const uint8 *p = &block[(pixels[i][1] * 4 + pixels[i][0]) * 4];
+		for (int c = 0; c < 3; c++)
+			avg[c] += p[c] / 8.0f;
+	}
+}
+
+uint64 encodeETC1(const Block block)
+{
+	uint64 bestbits = 0;
+	int besterror = 0x7FFFFFFF;
+
+	for (int flip = 0; flip < 2; flip++)
+	{
+		int pixels[2][8][2];
+		float avg[2][3];
+
+		for (int half = 0; half < 2; half++)
+		{
+			getETCSubblockPixels(flip, half, pixels[half]);
+			averageETCSubblock(block, pixels[half], avg[half]);
+		}
+
+		for (int differential = 0; differential < 2; differential++)
+		{
+			int q[2][3];
+			int base[2][3];
+
+			for (int half = 0; half < 2; half++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					if (differential)
+					{
+						q[half][c] = std::min((int) (avg[half][c] * 31.0f / 255.0f + 0.5f), 31);
+						base[half][c] = (q[half][c] << 3) | (q[half][c] >> 2);
+					}
+					else
+					{
+						q[half][c] = std::min((int) (avg[half][c] * 15.0f / 255.0f + 0.5f), 15);
+						base[half][c] = (q[half][c] << 4) | q[half][c];
+					}
+				}
+			}
+
+			if (differential)
+			{
+				bool fits = true;
+				for (int c = 0; c < 3; c++)
+				{
+					int d = q[1][c] - q[0][c];
+					fits = fits && d >= -4 && d <= 3;
+				}
+
+				if (!fits)
+					continue;
+			}
+
+			ETCSubblock sub[2];
+			int error = 0;
+			for (int half = 0; half < 2; half++)
+			{
+				sub[half] = fitETCSubblock(block, pixels[half], base[half]);
+				error += sub[half].error;
+			}
+
+			if (error >= besterror)
+				continue;
+
+			besterror = error;
+
+			uint64 bits = 0;
+			for (int c = 0; c < 3; c++)
+			{
+				int shift = 59 - c * 8;
+				if (differential)
+				{
+					bits |= (uint64) q[0][c] << shift;
+					bits |= (uint64) ((q[1][c] - q[0][c]) & 7) << (shift - 3);
+				}
+				else
+				{
+					bits |= (uint64) q[0][c] << (shift + 1);
+					bits |= (uint64) q[1][c] << (shift - 3);
+				}
+			}
+
+			bits |= (uint64) sub[0].table << 37;
+			bits |= (uint64) sub[1].table << 34;
+			bits |= (uint64) differential << 33;
+			bits |= (uint64) flip << 32;
+
+			for (int half = 0; half < 2; half++)
+			{
+				for (int i = 0; i < 8; i++)
+				{
+					int k = pixels[half][i][0] * 4 + pixels[half][i][1];
+					uint32 index = sub[half].indices[i];
+					bits |= (uint64) (index >> 1) << (16 + k);
+					bits |= (uint64) (index & 1) << k;
+				}
+			}
+
+			bestbits = bits;
+		}
+	}
+
+	return bestbits;
+}
+
+/*
+ * EAC alpha, as used by ETC2 RGBA8.
+ */
+
+const int eacModifiers[16][8] =
+{
+	{-3, -6,  -9, -15, 2, 5, 8, 14},
+	{-3, -7, -10, -13, 2, 6, 9, 12},
+	{-2, -5,  -8, -13, 1, 4, 7, 12},
+	{-2, -4,  -6, -13, 1, 3, 5, 12},
+	{-3, -6,  -8, -12, 2, 5, 7, 11},
+	{-3, -7,  -9, -11, 2, 6, 8, 10},
+	{-4, -7,  -8, -11, 3, 6, 7, 10},
+	{-3, -5,  -8, -11, 2, 4, 7, 10},
+	{-2, -6,  -8, -10, 1, 5, 7,  9},
+	{-2, -5,  -8, -10, 1, 4, 7,  9},
+	{-2, -4,  -8, -10, 1, 3, 7,  9},
+	{-2, -5,  -7, -10, 1, 4, 6,  9},
+	{-3, -4,  -7, -10, 2, 3, 6,  9},
+	{-1, -2,  -3, -10, 0, 1, 2,  9},
+	{-4, -6,  -8,  -9, 3, 5, 7,  8},
+	{-3, -5,  -7,  -9, 2, 4, 6,  8},
+};
+
+uint64 encodeEACAlpha(const Block block)
+{
+	int amin = 255;
+	int amax = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		amin = std::min(amin, (int) block[i * 4 + 3]);
+		amax = std::max(amax, (int) block[i * 4 + 3]);
+	}
+
+	// Table 13 has a zero modifier, which reproduces a flat block exactly.
+	if (amin == amax)
+	{
+		uint64 bits = ((uint64) amin << 56) | ((uint64) 1 << 52) | ((uint64) 13 << 48);
+		for (int k = 0; k < 16; k++)
+			bits |= (uint64) 4 << (45 - k * 3);
+		return bits;
+	}
+
+	uint64 bestbits = 0;
+	int besterror = 0x7FFFFFFF;
+
+	for (int table = 0; table < 16; table++)
+	{
+		const int *mods = eacModifiers[table];
+		int span = mods[7] - mods[3];
+		int guess = std::max((amax - amin + span / 2) / span, 1);
+
+		for (int multiplier = std::max(guess - 1, 1); multiplier <= std::min(guess + 1, 15); multiplier++)
+		{
+			int base = clampByte((amin + amax) / 2 - (mods[7] + mods[3]) * multiplier / 2);
+
+			uint64 bits = ((uint64) base << 56) | ((uint64) multiplier << 52) | ((uint64) table << 48);
+			int error = 0;
+
+			for (int k = 0; k < 16 && error < besterror; k++)
+			{
+				// Pixels are stored column by column.
+				int a = block[((k % 4) * 4 + k / 4) * 4 + 3];
+				int best = 0;
+				int bestdiff = 0x7FFFFFFF;
+
+				for (int index = 0; index < 8; index++)
+				{
+					int diff = abs(clampByte(base + mods[index] * multiplier) - a);
+					if (diff < bestdiff)
+					{
+						best = index;
+						bestdiff = diff;
+					}
+				}
+
+				bits |= (uint64) best << (45 - k * 3);
+				error += bestdiff * bestdiff;
+			}
+
+			if (error < besterror)
+			{
+				besterror = error;
+				bestbits = bits;
+			}
+		}
+	}
+
+	return bestbits;
+}
+
+void encodeBlock(PixelFormat format, const Block block, uint8 *dst)
+{
+	switch (format)
+	{
+	case PIXELFORMAT_DXT1:
+		encodeBC1(block, dst, true);
+		break;
+	case PIXELFORMAT_DXT5:
+		encodeBC3Alpha(block, dst);
+		encodeBC1(block, dst + 8, false);
+		break;
+	case PIXELFORMAT_BC7:
+		encodeBC7(block, dst);
+		break;
+	case PIXELFORMAT_ETC1:
+	case PIXELFORMAT_ETC2_RGB:
+		writeBE64(dst, encodeETC1(block));
+		break;
+	case PIXELFORMAT_ETC2_RGBA:
+		writeBE64(dst, encodeEACAlpha(block));
+		writeBE64(dst + 8, encodeETC1(block));
+		break;
+	default:
+		break;
+	}
+}
+
+size_t getBlockSize(PixelFormat format)
+{
+	switch (format)
+	{
+	case PIXELFORMAT_DXT1:
+	case PIXELFORMAT_ETC1:
+	case PIXELFORMAT_ETC2_RGB:
+		return 8;
+	case PIXELFORMAT_DXT5:
+	case PIXELFORMAT_BC7:
+	case PIXELFORMAT_ETC2_RGBA:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+} // anonymous namespace
+
+bool BlockCompressor::canCompress(PixelFormat format)
+{
+	return getBlockSize(format) > 0;
+}
+
+size_t BlockCompressor::getCompressedSize(PixelFormat format, int width, int height)
+{
+	size_t blocksx = (size_t) (width + 3) / 4;
+	size_t blocksy = (size_t) (height + 3) / 4;
+	return blocksx * blocksy * getBlockSize(format);
+}
+
+void BlockCompressor::compress(PixelFormat format, const uint8 *rgba, int width, int height, uint8 *dst)
+{
+	if (!canCompress(format))
+	{
+		const char *name = "unknown";
+		love::getConstant(format, name);
+		throw love::Exception("Cannot compress to the %s pixel format.", name);
+	}
+
+	if (width <= 0 || height <= 0)
+		throw love::Exception("Invalid image dimensions for compression.");
+
+	int blocksx = (width + 3) / 4;
+	int blocksy = (height + 3) / 4;
+	size_t blocksize = getBlockSize(format);
+
+	// Block rows are independent, and far more expensive than the overhead
+	// of a task each.
+	love::thread::WorkerPool::getInstance().parallelFor(blocksy, 1, [&](int start, int end)
+	{
+		Block block;
+
+		for (int by = start; by < end; by++)
+		{
+			for (int bx = 0; bx < blocksx; bx++)
+			{
+				for (int y = 0; y < 4; y++)
+				{
+					int sy = std::min(by * 4 + y, height - 1);
+					for (int x = 0; x < 4; x++)
+					{
+						int sx = std::min(bx * 4 + x, width - 1);
+						memcpy(&block[(y * 4 + x) * 4], &rgba[((size_t) sy * width + sx) * 4], 4);
+					}
+				}
+
+				encodeBlock(format, block, dst + ((size_t) by * blocksx + bx) * blocksize);
+			}
+		}
+	});
+}
+
+} // image
+} // love
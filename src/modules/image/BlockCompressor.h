@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_IMAGE_BLOCK_COMPRESSOR_H
+#define LOVE_IMAGE_BLOCK_COMPRESSOR_H
+
+// LOVE
+#include "common/int.h"
+#include "common/pixelformat.h"
+
+// C++
+#include <stddef.h>
+
+namespace love
+{
+namespace image
+{
+
+/**
+ * Encodes RGBA8 pixels into GPU block-compressed formats at runtime. The
+ * encoders favour speed over the last bit of quality: each 4x4 block is fit
+ * along its principal axis and refined once with least squares, rather than
+ * searched exhaustively like offline tools do.
+ **/
+class BlockCompressor
+{
+public:
+
+	/**
+	 * Whether the given compressed format can be encoded. Currently DXT1, DXT5,
+	 * BC7 (mode 6 only), ETC1, ETC2_RGB and ETC2_RGBA.
+	 **/
+	static bool canCompress(PixelFormat format);
+
+	/**
+	 * Gets the size in bytes of a width x height image in the given format.
+	 **/
+	static size_t getCompressedSize(PixelFormat format, int width, int height);
+
+	/**
+	 * Compresses tightly packed RGBA8 pixels. Blocks are encoded on worker
+	 * threads. Partial blocks at the right and bottom edges are padded by
+	 * repeating the last column and row.
+	 * @param dst Must be at least getCompressedSize(format, width, height) bytes.
+	 **/
+	static void compress(PixelFormat format, const uint8 *rgba, int width, int height, uint8 *dst);
+
+}; // BlockCompressor
+
+} // image
+} // love
+
+#endif // LOVE_IMAGE_BLOCK_COMPRESSOR_H
@@ -19,6 +19,7 @@
  **/
 
 #include "CompressedImageData.h"
+#include "BlockCompressor.h"
 
 namespace love
 {
@@ -57,6 +58,52 @@ CompressedImageData::CompressedImageData(const std::list<FormatHandler *> &forma
 		throw love::Exception("Could not parse compressed data: No valid data?");
 }
 
+CompressedImageData::CompressedImageData(const std::vector<ImageData *> &mipmaps, PixelFormat format)
+	: format(format)
+	, sRGB(false)
+{
+	if (!BlockCompressor::canCompress(format))
+	{
+		const char *name = "unknown";
+		love::getConstant(format, name);
+		throw love::Exception("Cannot compress ImageData to the %s pixel format.", name);
+	}
+
+	if (mipmaps.empty())
+		throw love::Exception("At least one ImageData is required!");
+
+	size_t totalsize = 0;
+	for (ImageData *mip : mipmaps)
+		totalsize += BlockCompressor::getCompressedSize(format, mip->getWidth(), mip->getHeight());
+
+	memory.set(new CompressedMemory(totalsize), Acquire::NORETAIN);
+
+	size_t offset = 0;
+
+	for (ImageData *mip : mipmaps)
+	{
+		int w = mip->getWidth();
+		int h = mip->getHeight();
+		size_t size = BlockCompressor::getCompressedSize(format, w, h);
+
+		// The encoders only read RGBA8.
+		StrongRef<ImageData> source(mip);
+		if (mip->getFormat() != PIXELFORMAT_RGBA8)
+			source.set(mip->convert(PIXELFORMAT_RGBA8), Acquire::NORETAIN);
+
+		{
+			love::thread::Lock lock(source->getMutex());
+			BlockCompressor::compress(format, (const uint8 *) source->getData(), w, h, memory->data + offset);
+		}
+
+		auto slice = new CompressedSlice(format, w, h, memory, offset, size);
+		dataImages.push_back(slice);
+		slice->release();
+
+		offset += size;
+	}
+}
+
 CompressedImageData::CompressedImageData(const CompressedImageData &c)
 	: format(c.format)
 	, sRGB(c.sRGB)
@@ -27,6 +27,7 @@
 #include "common/pixelformat.h"
 #include "CompressedSlice.h"
 #include "FormatHandler.h"
+#include "ImageData.h"
 
 // STL
 #include <vector>
@@ -49,6 +50,12 @@ class CompressedImageData : public Data
 	static love::Type type;
 
 	CompressedImageData(const std::list<FormatHandler *> &formats, Data *filedata);
+
+	/**
+	 * Compresses ImageData at runtime, with one ImageData per mipmap level
+	 * (largest first). See BlockCompressor for the supported formats.
+	 **/
+	CompressedImageData(const std::vector<ImageData *> &mipmaps, PixelFormat format);
 	CompressedImageData(const CompressedImageData &c);
 	virtual ~CompressedImageData();
 
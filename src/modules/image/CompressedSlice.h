@@ -24,6 +24,7 @@
 #include "common/int.h"
 #include "common/pixelformat.h"
 #include "common/Object.h"
+#include "common/Data.h"
 #include "ImageDataBase.h"
 
 namespace love
@@ -36,11 +37,22 @@ class CompressedMemory : public Object
 public:
 
 	CompressedMemory(size_t size);
+
+	/**
+	 * References size bytes of an existing Data, starting at offset, instead
+	 * of allocating and copying. The Data is kept alive while this is.
+	 **/
+	CompressedMemory(Data *source, size_t offset, size_t size);
+
 	virtual ~CompressedMemory();
 
 	uint8 *data;
 	size_t size;
 
+private:
+
+	StrongRef<Data> source;
+
 }; // CompressedMemory
 
 // Compressed image data can have multiple mipmap levels, each represented by a
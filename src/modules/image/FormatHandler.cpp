@@ -22,6 +22,9 @@
 #include "FormatHandler.h"
 #include "common/Exception.h"
 
+// C
+#include <cstring>
+
 namespace love
 {
 namespace image
@@ -50,7 +53,43 @@ FormatHandler::DecodedImage FormatHandler::decode(Data* /*data*/)
 	throw love::Exception("Image decoding is not implemented for this format backend.");
 }
 
-FormatHandler::EncodedImage FormatHandler::encode(const DecodedImage& /*img*/, EncodedFormat /*format*/)
+FormatHandler::DecodedImage FormatHandler::decodeRegion(Data *data, int x, int y, int width, int height)
+{
+	DecodedImage img = decode(data);
+
+	if (x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > img.width || y + height > img.height)
+	{
+		freeRawPixels(img.data);
+		throw love::Exception("Invalid region (%d, %d, %d, %d) for a %dx%d image.", x, y, width, height, img.width, img.height);
+	}
+
+	// Crop in place, so the memory is still freed the way the handler
+	// expects.
+	size_t pixelsize = getPixelFormatSize(img.format);
+	size_t srcrowsize = img.width * pixelsize;
+	size_t dstrowsize = width * pixelsize;
+
+	for (int row = 0; row < height; row++)
+		memmove(img.data + row * dstrowsize, img.data + (y + row) * srcrowsize + x * pixelsize, dstrowsize);
+
+	img.width = width;
+	img.height = height;
+	img.size = dstrowsize * height;
+
+	return img;
+}
+
+bool FormatHandler::canDecodeRegion(Data* /*data*/)
+{
+	return false;
+}
+
+bool FormatHandler::getDimensions(Data* /*data*/, int& /*width*/, int& /*height*/)
+{
+	return false;
+}
+
+FormatHandler::EncodedImage FormatHandler::encode(const DecodedImage& /*img*/, EncodedFormat /*format*/, int /*compressionLevel*/)
 {
 	throw love::Exception("Image encoding is not implemented for this format backend.");
 }
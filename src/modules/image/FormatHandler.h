@@ -43,6 +43,8 @@ class FormatHandler : public love::Object
 	{
 		ENCODED_TGA,
 		ENCODED_PNG,
+		ENCODED_QOI,
+		ENCODED_LTEX,
 		ENCODED_MAX_ENUM
 	};
 
@@ -84,10 +86,31 @@ class FormatHandler : public love::Object
 	 **/
 	virtual DecodedImage decode(Data *data);
 
+	/**
+	 * Decodes only the given rectangle of an image. Handlers which can stream
+	 * their format override this to keep memory use proportional to the
+	 * rectangle; by default the whole image is decoded and then cropped.
+	 **/
+	virtual DecodedImage decodeRegion(Data *data, int x, int y, int width, int height);
+
+	/**
+	 * Whether decodeRegion can decode the given Data without decoding the
+	 * whole image.
+	 **/
+	virtual bool canDecodeRegion(Data *data);
+
+	/**
+	 * Reads the dimensions of an encoded image without decoding its pixels.
+	 * Returns false if the handler can't do that for the given Data.
+	 **/
+	virtual bool getDimensions(Data *data, int &width, int &height);
+
 	/**
 	 * Encodes an image from raw pixel data into a particular format.
+	 * @param compressionLevel From 0 (fastest) to 9 (smallest), or -1 for the
+	 *        format's default. Ignored by formats without a tunable level.
 	 **/
-	virtual EncodedImage encode(const DecodedImage &img, EncodedFormat format);
+	virtual EncodedImage encode(const DecodedImage &img, EncodedFormat format, int compressionLevel);
 
 	/**
 	 * Whether this format handler can parse the given Data into a
@@ -24,6 +24,7 @@
 
 #include "magpie/PNGHandler.h"
 #include "magpie/STBHandler.h"
+#include "magpie/QOIHandler.h"
 #include "magpie/EXRHandler.h"
 
 #include "magpie/ddsHandler.h"
@@ -31,6 +32,7 @@
 #include "magpie/KTXHandler.h"
 #include "magpie/PKMHandler.h"
 #include "magpie/ASTCHandler.h"
+#include "magpie/LTEXHandler.h"
 
 namespace love
 {
@@ -48,12 +50,14 @@ Image::Image()
 	formatHandlers = {
 		new PNGHandler,
 		new STBHandler,
+		new QOIHandler,
 		new EXRHandler,
 		new DDSHandler,
 		new PVRHandler,
 		new KTXHandler,
 		new PKMHandler,
 		new ASTCHandler,
+		new LTEXHandler,
 	};
 }
 
@@ -75,6 +79,45 @@ love::image::ImageData *Image::newImageData(Data *data)
 	return new ImageData(data);
 }
 
+love::image::ImageData *Image::newImageData(Data *data, const Rect &region)
+{
+	return new ImageData(data, region);
+}
+
+void Image::getDimensions(Data *data, int &width, int &height)
+{
+	for (FormatHandler *handler : formatHandlers)
+	{
+		if (handler->canDecode(data))
+		{
+			if (handler->getDimensions(data, width, height))
+				return;
+			break;
+		}
+	}
+
+	// Fall back to decoding the whole image.
+	StrongRef<ImageData> imagedata(new ImageData(data), Acquire::NORETAIN);
+	width = imagedata->getWidth();
+	height = imagedata->getHeight();
+}
+
+bool Image::canDecodeRegion(Data *data)
+{
+	for (FormatHandler *handler : formatHandlers)
+	{
+		if (handler->canDecode(data))
+			return handler->canDecodeRegion(data);
+	}
+
+	return false;
+}
+
+ImageDecodeBatch *Image::newImageDataBatch(const std::vector<Data *> &datas)
+{
+	return new ImageDecodeBatch(datas);
+}
+
 love::image::ImageData *Image::newImageData(int width, int height, PixelFormat format)
 {
 	return new ImageData(width, height, format);
@@ -90,6 +133,21 @@ love::image::CompressedImageData *Image::newCompressedData(Data *data)
 	return new CompressedImageData(formatHandlers, data);
 }
 
+love::image::CompressedImageData *Image::newCompressedData(ImageData *data, PixelFormat format, bool mipmaps)
+{
+	std::vector<StrongRef<ImageData>> levels;
+	// The result isn't marked as sRGB, so the levels are filtered as linear
+	// data to match how they'll be sampled.
+	if (mipmaps)
+		data->generateMipmaps(false, levels);
+
+	std::vector<ImageData *> datas = {data};
+	for (const auto &level : levels)
+		datas.push_back(level.get());
+
+	return new CompressedImageData(datas, format);
+}
+
 bool Image::isCompressed(Data *data)
 {
 	for (FormatHandler *handler : formatHandlers)
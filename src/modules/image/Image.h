@@ -27,6 +27,7 @@
 #include "filesystem/File.h"
 #include "ImageData.h"
 #include "CompressedImageData.h"
+#include "ImageDecodeBatch.h"
 
 // C++
 #include <list>
@@ -82,6 +83,34 @@ class Image : public Module
 	 **/
 	ImageData *newImageData(int width, int height, PixelFormat format, void *data, bool own = false);
 
+	/**
+	 * Decodes only a rectangle of an encoded image. PNG and QOI images are
+	 * streamed, so memory use depends on the size of the rectangle rather
+	 * than of the whole image.
+	 * @param data The encoded image data.
+	 * @param region The rectangle to decode, in pixels.
+	 **/
+	ImageData *newImageData(Data *data, const Rect &region);
+
+	/**
+	 * Gets the dimensions of an encoded image. Most formats are read from
+	 * the header without decoding any pixels.
+	 **/
+	void getDimensions(Data *data, int &width, int &height);
+
+	/**
+	 * Whether a rectangle of an encoded image can be decoded without decoding
+	 * the whole image.
+	 **/
+	bool canDecodeRegion(Data *data);
+
+	/**
+	 * Starts decoding each of the given encoded images on worker threads.
+	 * @param datas The FileData (or other Data) for each image.
+	 * @return A handle for retrieving the ImageData as they're decoded.
+	 **/
+	ImageDecodeBatch *newImageDataBatch(const std::vector<Data *> &datas);
+
 	/**
 	 * Creates new CompressedImageData from FileData.
 	 * @param data The FileData containing the compressed image data.
@@ -89,6 +118,15 @@ class Image : public Module
 	 **/
 	CompressedImageData *newCompressedData(Data *data);
 
+	/**
+	 * Compresses ImageData into a GPU-compressed format at runtime.
+	 * @param data The ImageData to compress.
+	 * @param format The compressed format to use.
+	 * @param mipmaps Whether to generate and compress a full mipmap chain.
+	 * @return The new CompressedImageData.
+	 **/
+	CompressedImageData *newCompressedData(ImageData *data, PixelFormat format, bool mipmaps);
+
 	/**
 	 * Determines whether a FileData is Compressed image data or not.
 	 * @param data The FileData to test.
@@ -21,8 +21,24 @@
 #include "ImageData.h"
 #include "Image.h"
 #include "filesystem/Filesystem.h"
+#include "thread/WorkerPool.h"
+#include "thread/Channel.h"
+#include "math/MathModule.h"
+#include "common/math.h"
+#include "common/config.h"
 
 #include <algorithm> // min/max
+#include <vector>
+#include <limits>
+#include <math.h>
+
+#if defined(LOVE_SIMD_SSE)
+#include <xmmintrin.h>
+#endif
+
+#if defined(LOVE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
 
 using love::thread::Lock;
 
@@ -39,6 +55,12 @@ ImageData::ImageData(Data *data)
 	decode(data);
 }
 
+ImageData::ImageData(Data *data, const Rect &region)
+	: ImageDataBase(PIXELFORMAT_UNKNOWN, 0, 0)
+{
+	decode(data, &region);
+}
+
 ImageData::ImageData(int width, int height, PixelFormat format)
 	: ImageDataBase(format, width, height)
 {
@@ -105,7 +127,7 @@ void ImageData::create(int width, int height, PixelFormat format, void *data)
 	pixelGetFunction = getPixelGetFunction(format);
 }
 
-void ImageData::decode(Data *data)
+void ImageData::decode(Data *data, const Rect *region)
 {
 	FormatHandler *decoder = nullptr;
 	FormatHandler::DecodedImage decodedimage;
@@ -124,7 +146,9 @@ void ImageData::decode(Data *data)
 		}
 	}
 
-	if (decoder)
+	if (decoder && region != nullptr)
+		decodedimage = decoder->decodeRegion(data, region->x, region->y, region->w, region->h);
+	else if (decoder)
 		decodedimage = decoder->decode(data);
 
 	if (decodedimage.data == nullptr)
@@ -163,7 +187,7 @@ void ImageData::decode(Data *data)
 	pixelGetFunction = getPixelGetFunction(format);
 }
 
-love::filesystem::FileData *ImageData::encode(FormatHandler::EncodedFormat encodedFormat, const char *filename, bool writefile) const
+love::filesystem::FileData *ImageData::encode(FormatHandler::EncodedFormat encodedFormat, const char *filename, bool writefile, int compressionlevel) const
 {
 	FormatHandler *encoder = nullptr;
 	FormatHandler::EncodedImage encodedimage;
@@ -192,7 +216,7 @@ love::filesystem::FileData *ImageData::encode(FormatHandler::EncodedFormat encod
 	if (encoder != nullptr)
 	{
 		thread::Lock lock(mutex);
-		encodedimage = encoder->encode(rawimage, encodedFormat);
+		encodedimage = encoder->encode(rawimage, encodedFormat, compressionlevel);
 	}
 
 	if (encoder == nullptr || encodedimage.data == nullptr)
@@ -241,6 +265,61 @@ love::filesystem::FileData *ImageData::encode(FormatHandler::EncodedFormat encod
 	return filedata;
 }
 
+class EncodeTask : public love::thread::Task
+{
+public:
+
+	EncodeTask(ImageData *imagedata, FormatHandler::EncodedFormat format, const char *filename, int compressionlevel, love::thread::Channel *channel)
+		: imageData(imagedata)
+		, format(format)
+		, filename(filename)
+		, compressionLevel(compressionlevel)
+		, channel(channel)
+	{}
+
+	void run() override
+	{
+		love::filesystem::FileData *filedata = nullptr;
+
+		try
+		{
+			filedata = imageData->encode(format, filename.c_str(), false, compressionLevel);
+		}
+		catch (std::exception &e)
+		{
+			// Including std::bad_alloc: if nothing is pushed, a thread waiting
+			// on the channel would block forever.
+			channel->push(Variant(std::string(e.what())));
+			return;
+		}
+
+		channel->push(Variant(&love::filesystem::FileData::type, filedata));
+		filedata->release();
+	}
+
+private:
+
+	StrongRef<ImageData> imageData;
+	FormatHandler::EncodedFormat format;
+	std::string filename;
+	int compressionLevel;
+	StrongRef<love::thread::Channel> channel;
+
+}; // EncodeTask
+
+void ImageData::encodeAsync(FormatHandler::EncodedFormat format, const char *filename, int compressionlevel, love::thread::Channel *channel)
+{
+	// Report this right away instead of through the channel.
+	if (Module::getInstance<Image>(Module::M_IMAGE) == nullptr)
+		throw love::Exception("love.image must be loaded in order to encode an ImageData.");
+
+	EncodeTask *task = new EncodeTask(this, format, filename, compressionlevel, channel);
+
+	// The pool keeps its own reference until the task has run.
+	love::thread::WorkerPool::getInstance().submit(task);
+	task->release();
+}
+
 size_t ImageData::getSize() const
 {
 	return size_t(getWidth() * getHeight()) * getPixelSize();
@@ -299,8 +378,8 @@ static void setPixelRG16(const Colorf &c, ImageData::Pixel *p)
 static void setPixelRGBA16(const Colorf &c, ImageData::Pixel *p)
 {
 	p->rgba16[0] = (uint16) (clamp01(c.r) * 65535.0f + 0.5f);
-	p->rgba16[1] = (uint16) (clamp01(c.b) * 65535.0f + 0.5f);
-	p->rgba16[2] = (uint16) (clamp01(c.g) * 65535.0f + 0.5f);
+	p->rgba16[1] = (uint16) (clamp01(c.g) * 65535.0f + 0.5f);
+	p->rgba16[2] = (uint16) (clamp01(c.b) * 65535.0f + 0.5f);
 	p->rgba16[3] = (uint16) (clamp01(c.a) * 65535.0f + 0.5f);
 }
 
@@ -650,7 +729,7 @@ static void pasteRGBA32FtoRGBA16F(Row src, Row dst, int w)
 		dst.f16[i] = float32to16(src.f32[i]);
 }
 
-void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh)
+void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh, BlendMode blend)
 {
 	PixelFormat dstformat = getFormat();
 	PixelFormat srcformat = src->getFormat();
@@ -706,9 +785,19 @@ void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, in
 	if (sy + sh > srcH)
 		sh = srcH - sy;
 
+	// Clipping can leave nothing to paste.
+	if (sw <= 0 || sh <= 0)
+		return;
+
 	Lock lock2(src->mutex);
 	Lock lock1(mutex);
 
+	if (blend != BLEND_REPLACE)
+	{
+		pasteBlended(src, dx, dy, sx, sy, sw, sh, blend);
+		return;
+	}
+
 	uint8 *s = (uint8 *) src->getData();
 	uint8 *d = (uint8 *) getData();
 
@@ -720,7 +809,7 @@ void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, in
 	{
 		memcpy(d, s, srcpixelsize * sw * sh);
 	}
-	else if (sw > 0)
+	else
 	{
 		// Otherwise, copy each row individually.
 		for (int i = 0; i < sh; i++)
@@ -775,6 +864,878 @@ void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, in
 	}
 }
 
+// Unsigned normalized formats with 1, 2 or 4 channels. Missing channels are
+// read as 0, except alpha which is 1, matching the per-pixel functions.
+template <typename T, int channels>
+static void getRowUnorm(const T *row, int w, float *dst)
+{
+	const float maxvalue = (float) std::numeric_limits<T>::max();
+
+	if (channels == 4)
+	{
+		for (int i = 0; i < w * 4; i++)
+			dst[i] = row[i] / maxvalue;
+		return;
+	}
+
+	for (int x = 0; x < w; x++)
+	{
+		dst[x * 4 + 0] = row[x * channels + 0] / maxvalue;
+		dst[x * 4 + 1] = channels > 1 ? row[x * channels + 1] / maxvalue : 0.0f;
+		dst[x * 4 + 2] = 0.0f;
+		dst[x * 4 + 3] = 1.0f;
+	}
+}
+
+template <typename T, int channels>
+static void setRowUnorm(const float *src, int w, T *row)
+{
+	const float maxvalue = (float) std::numeric_limits<T>::max();
+
+	for (int x = 0; x < w; x++)
+	{
+		for (int c = 0; c < channels; c++)
+			row[x * channels + c] = (T) (std::min(std::max(src[x * 4 + c], 0.0f), 1.0f) * maxvalue + 0.5f);
+	}
+}
+
+// Reads a row of pixels as RGBA floats.
+static void getRowFloat(const uint8 *row, PixelFormat format, ImageData::PixelGetFunction getfunction, int w, float *dst)
+{
+	if (format == PIXELFORMAT_RGBA8)
+		getRowUnorm<uint8, 4>(row, w, dst);
+	else if (format == PIXELFORMAT_RG8)
+		getRowUnorm<uint8, 2>(row, w, dst);
+	else if (format == PIXELFORMAT_R8)
+		getRowUnorm<uint8, 1>(row, w, dst);
+	else if (format == PIXELFORMAT_RGBA16)
+		getRowUnorm<uint16, 4>((const uint16 *) row, w, dst);
+	else if (format == PIXELFORMAT_RGBA32F)
+		memcpy(dst, row, sizeof(float) * 4 * w);
+	else
+	{
+		size_t pixelsize = getPixelFormatSize(format);
+		Colorf c;
+		for (int x = 0; x < w; x++)
+		{
+			getfunction((const ImageData::Pixel *) (row + x * pixelsize), c);
+			dst[x * 4 + 0] = c.r;
+			dst[x * 4 + 1] = c.g;
+			dst[x * 4 + 2] = c.b;
+			dst[x * 4 + 3] = c.a;
+		}
+	}
+}
+
+// Writes a row of RGBA floats to pixels, clamping them if the format needs.
+static void setRowFloat(const float *src, PixelFormat format, ImageData::PixelSetFunction setfunction, int w, uint8 *row)
+{
+	if (format == PIXELFORMAT_RGBA8)
+		setRowUnorm<uint8, 4>(src, w, row);
+	else if (format == PIXELFORMAT_RG8)
+		setRowUnorm<uint8, 2>(src, w, row);
+	else if (format == PIXELFORMAT_R8)
+		setRowUnorm<uint8, 1>(src, w, row);
+	else if (format == PIXELFORMAT_RGBA16)
+		setRowUnorm<uint16, 4>(src, w, (uint16 *) row);
+	else if (format == PIXELFORMAT_RGBA32F)
+		memcpy(row, src, sizeof(float) * 4 * w);
+	else
+	{
+		size_t pixelsize = getPixelFormatSize(format);
+		for (int x = 0; x < w; x++)
+		{
+			Colorf c(src[x * 4 + 0], src[x * 4 + 1], src[x * 4 + 2], src[x * 4 + 3]);
+			setfunction(c, (ImageData::Pixel *) (row + x * pixelsize));
+		}
+	}
+}
+
+// Enough rows per task that the scheduling overhead doesn't dominate.
+static int getRowGrainSize(int width)
+{
+	return std::max(1, (64 * 1024) / std::max(width, 1));
+}
+
+// Runs func on every row of the image as RGBA floats, writing the results
+// back. Rows are processed on worker threads.
+template <typename F>
+static void transformRowsFloat(ImageData *img, F func)
+{
+	int w = img->getWidth();
+	PixelFormat format = img->getFormat();
+	size_t rowsize = w * img->getPixelSize();
+	uint8 *data = (uint8 *) img->getData();
+	auto getfunction = img->getPixelGetFunction();
+	auto setfunction = img->getPixelSetFunction();
+
+	love::thread::WorkerPool::getInstance().parallelFor(img->getHeight(), getRowGrainSize(w), [&](int start, int end)
+	{
+		std::vector<float> row(w * 4);
+		for (int y = start; y < end; y++)
+		{
+			getRowFloat(data + y * rowsize, format, getfunction, w, row.data());
+			func(row.data(), w);
+			setRowFloat(row.data(), format, setfunction, w, data + y * rowsize);
+		}
+	});
+}
+
+// Blends a row of RGBA float source pixels into a row of RGBA float
+// destination pixels. Each pixel fits in one 4-wide vector.
+static void blendRowFloat(const float *src, float *dst, int w, ImageData::BlendMode blend)
+{
+#if defined(LOVE_SIMD_SSE)
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 rgbmask = _mm_set_ps(0.0f, 1.0f, 1.0f, 1.0f);
+	const __m128 alphaone = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+	for (int x = 0; x < w; x++)
+	{
+		__m128 s = _mm_loadu_ps(src + x * 4);
+		__m128 d = _mm_loadu_ps(dst + x * 4);
+		__m128 sa = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));
+		__m128 invsa = _mm_sub_ps(one, sa);
+
+		if (blend == ImageData::BLEND_ALPHA)
+		{
+			// Replacing src.a with 1 gives out.a = src.a + dst.a * (1 - src.a).
+			s = _mm_add_ps(_mm_mul_ps(s, rgbmask), alphaone);
+			d = _mm_add_ps(_mm_mul_ps(s, sa), _mm_mul_ps(d, invsa));
+		}
+		else if (blend == ImageData::BLEND_ADD)
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_mul_ps(s, sa), rgbmask));
+		else if (blend == ImageData::BLEND_MULTIPLY)
+		{
+			__m128 f = _mm_add_ps(_mm_mul_ps(s, sa), invsa);
+			f = _mm_add_ps(_mm_mul_ps(f, rgbmask), alphaone);
+			d = _mm_mul_ps(d, f);
+		}
+
+		_mm_storeu_ps(dst + x * 4, d);
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float rgbmaskv[4] = {1.0f, 1.0f, 1.0f, 0.0f};
+	const float alphaonev[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+	const float32x4_t rgbmask = vld1q_f32(rgbmaskv);
+	const float32x4_t alphaone = vld1q_f32(alphaonev);
+
+	for (int x = 0; x < w; x++)
+	{
+		float32x4_t s = vld1q_f32(src + x * 4);
+		float32x4_t d = vld1q_f32(dst + x * 4);
+		float32x4_t sa = vdupq_n_f32(src[x * 4 + 3]);
+		float32x4_t invsa = vsubq_f32(one, sa);
+
+		if (blend == ImageData::BLEND_ALPHA)
+		{
+			s = vmlaq_f32(alphaone, s, rgbmask);
+			d = vmlaq_f32(vmulq_f32(d, invsa), s, sa);
+		}
+		else if (blend == ImageData::BLEND_ADD)
+			d = vmlaq_f32(d, vmulq_f32(s, sa), rgbmask);
+		else if (blend == ImageData::BLEND_MULTIPLY)
+		{
+			float32x4_t f = vmlaq_f32(invsa, s, sa);
+			f = vmlaq_f32(alphaone, f, rgbmask);
+			d = vmulq_f32(d, f);
+		}
+
+		vst1q_f32(dst + x * 4, d);
+	}
+#else
+	for (int x = 0; x < w; x++)
+	{
+		const float *s = src + x * 4;
+		float *d = dst + x * 4;
+		float sa = s[3];
+
+		if (blend == ImageData::BLEND_ALPHA)
+		{
+			for (int i = 0; i < 3; i++)
+				d[i] = s[i] * sa + d[i] * (1.0f - sa);
+			d[3] = sa + d[3] * (1.0f - sa);
+		}
+		else if (blend == ImageData::BLEND_ADD)
+		{
+			for (int i = 0; i < 3; i++)
+				d[i] += s[i] * sa;
+		}
+		else if (blend == ImageData::BLEND_MULTIPLY)
+		{
+			for (int i = 0; i < 3; i++)
+				d[i] *= s[i] * sa + (1.0f - sa);
+		}
+	}
+#endif
+}
+
+void ImageData::pasteBlended(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh, BlendMode blend)
+{
+	PixelFormat srcformat = src->getFormat();
+	PixelFormat dstformat = getFormat();
+
+	size_t srcrowsize = src->getWidth() * src->getPixelSize();
+	size_t dstrowsize = getWidth() * getPixelSize();
+
+	const uint8 *s = (const uint8 *) src->getData() + sy * srcrowsize + sx * src->getPixelSize();
+	uint8 *d = (uint8 *) getData() + dy * dstrowsize + dx * getPixelSize();
+
+	// Rows are blended in parallel, so a row could otherwise read source
+	// pixels which another worker has already blended.
+	std::vector<uint8> srccopy;
+	if (src == this && dx < sx + sw && sx < dx + sw && dy < sy + sh && sy < dy + sh)
+	{
+		size_t rowsize = sw * getPixelSize();
+		srccopy.resize(rowsize * sh);
+
+		for (int y = 0; y < sh; y++)
+			memcpy(srccopy.data() + y * rowsize, s + y * srcrowsize, rowsize);
+
+		s = srccopy.data();
+		srcrowsize = rowsize;
+	}
+
+	auto getsrc = src->pixelGetFunction;
+	auto getdst = pixelGetFunction;
+	auto setdst = pixelSetFunction;
+
+	// Both rows go through RGBA floats, so every pair of formats with get/set
+	// functions works and the result is clamped as the destination requires.
+	love::thread::WorkerPool::getInstance().parallelFor(sh, getRowGrainSize(sw), [&](int start, int end)
+	{
+		std::vector<float> srcrow(sw * 4);
+		std::vector<float> dstrow(sw * 4);
+
+		for (int y = start; y < end; y++)
+		{
+			getRowFloat(s + y * srcrowsize, srcformat, getsrc, sw, srcrow.data());
+			getRowFloat(d + y * dstrowsize, dstformat, getdst, sw, dstrow.data());
+			blendRowFloat(srcrow.data(), dstrow.data(), sw, blend);
+			setRowFloat(dstrow.data(), dstformat, setdst, sw, d + y * dstrowsize);
+		}
+	});
+}
+
+static void checkRegion(const ImageData *img, const Rect &r)
+{
+	if (r.x < 0 || r.y < 0 || r.w < 0 || r.h < 0
+		|| (int64) r.x + r.w > img->getWidth() || (int64) r.y + r.h > img->getHeight())
+	{
+		throw love::Exception("Invalid rectangle (x=%d, y=%d, w=%d, h=%d) for %dx%d ImageData.", r.x, r.y, r.w, r.h, img->getWidth(), img->getHeight());
+	}
+}
+
+void ImageData::getPixels(const Rect &rect, float *rgba) const
+{
+	checkRegion(this, rect);
+
+	if (pixelGetFunction == nullptr)
+		throw love::Exception("Unhandled pixel format %d in ImageData::getPixels", format);
+
+	size_t pixelsize = getPixelSize();
+	size_t pitch = width * pixelsize;
+
+	Lock lock(mutex);
+
+	for (int y = 0; y < rect.h; y++)
+	{
+		const uint8 *row = data + (rect.y + y) * pitch + rect.x * pixelsize;
+		getRowFloat(row, format, pixelGetFunction, rect.w, rgba + (size_t) y * rect.w * 4);
+	}
+}
+
+void ImageData::setPixels(const Rect &rect, const float *rgba)
+{
+	checkRegion(this, rect);
+
+	if (pixelSetFunction == nullptr)
+		throw love::Exception("Unhandled pixel format %d in ImageData::setPixels", format);
+
+	size_t pixelsize = getPixelSize();
+	size_t pitch = width * pixelsize;
+
+	Lock lock(mutex);
+
+	for (int y = 0; y < rect.h; y++)
+	{
+		uint8 *row = data + (rect.y + y) * pitch + rect.x * pixelsize;
+		setRowFloat(rgba + (size_t) y * rect.w * 4, format, pixelSetFunction, rect.w, row);
+	}
+}
+
+void ImageData::getRawPixels(const Rect &rect, void *dst) const
+{
+	checkRegion(this, rect);
+
+	size_t pixelsize = getPixelSize();
+	size_t pitch = width * pixelsize;
+	size_t rowsize = rect.w * pixelsize;
+
+	Lock lock(mutex);
+
+	for (int y = 0; y < rect.h; y++)
+		memcpy((uint8 *) dst + y * rowsize, data + (rect.y + y) * pitch + rect.x * pixelsize, rowsize);
+}
+
+void ImageData::setRawPixels(const Rect &rect, const void *src)
+{
+	checkRegion(this, rect);
+
+	size_t pixelsize = getPixelSize();
+	size_t pitch = width * pixelsize;
+	size_t rowsize = rect.w * pixelsize;
+
+	Lock lock(mutex);
+
+	for (int y = 0; y < rect.h; y++)
+		memcpy(data + (rect.y + y) * pitch + rect.x * pixelsize, (const uint8 *) src + y * rowsize, rowsize);
+}
+
+void ImageData::fill(const Rect &rect, const Colorf &c)
+{
+	checkRegion(this, rect);
+
+	if (pixelSetFunction == nullptr)
+		throw love::Exception("Unhandled pixel format %d in ImageData::fill", format);
+
+	if (rect.w == 0 || rect.h == 0)
+		return;
+
+	size_t pixelsize = getPixelSize();
+	size_t pitch = width * pixelsize;
+	size_t rowsize = rect.w * pixelsize;
+
+	Pixel p;
+	memset(&p, 0, sizeof(Pixel));
+	pixelSetFunction(c, &p);
+
+	Lock lock(mutex);
+
+	uint8 *first = data + rect.y * pitch + rect.x * pixelsize;
+
+	// Fill the first row by repeatedly doubling the filled part, then copy
+	// it to the rest.
+	memcpy(first, &p, pixelsize);
+	for (size_t filled = pixelsize; filled < rowsize; )
+	{
+		size_t size = std::min(filled, rowsize - filled);
+		memcpy(first + filled, first, size);
+		filled += size;
+	}
+
+	for (int y = 1; y < rect.h; y++)
+		memcpy(first + y * pitch, first, rowsize);
+}
+
+void ImageData::clear(const Rect &rect)
+{
+	checkRegion(this, rect);
+
+	size_t pixelsize = getPixelSize();
+	size_t pitch = width * pixelsize;
+
+	Lock lock(mutex);
+
+	for (int y = 0; y < rect.h; y++)
+		memset(data + (rect.y + y) * pitch + rect.x * pixelsize, 0, rect.w * pixelsize);
+}
+
+static float filterRadius(ImageData::ResizeFilter filter)
+{
+	switch (filter)
+	{
+	case ImageData::RESIZE_BOX:
+		return 0.5f;
+	case ImageData::RESIZE_BILINEAR:
+		return 1.0f;
+	case ImageData::RESIZE_LANCZOS:
+	default:
+		return 3.0f;
+	}
+}
+
+static float sinc(float x)
+{
+	if (fabsf(x) < 1e-5f)
+		return 1.0f;
+	x *= (float) LOVE_M_PI;
+	return sinf(x) / x;
+}
+
+static float filterWeight(ImageData::ResizeFilter filter, float x)
+{
+	switch (filter)
+	{
+	case ImageData::RESIZE_BOX:
+		return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+	case ImageData::RESIZE_BILINEAR:
+		return std::max(1.0f - fabsf(x), 0.0f);
+	case ImageData::RESIZE_LANCZOS:
+	default:
+		return fabsf(x) < 3.0f ? sinc(x) * sinc(x / 3.0f) : 0.0f;
+	}
+}
+
+// Source pixels and weights which make up each destination pixel along one
+// axis. Every destination pixel uses the same (maximum) number of weights.
+struct ResampleWeights
+{
+	int taps;
+	std::vector<int> first;
+	std::vector<float> weights;
+};
+
+static void computeResampleWeights(int srcsize, int dstsize, ImageData::ResizeFilter filter, ResampleWeights &rw)
+{
+	float scale = (float) srcsize / (float) dstsize;
+
+	// When shrinking, the filter is widened to cover every source pixel.
+	float filterscale = std::max(scale, 1.0f);
+	float support = filterRadius(filter) * filterscale;
+
+	rw.taps = std::min((int) ceilf(support) * 2 + 1, srcsize);
+	rw.first.resize(dstsize);
+	rw.weights.assign((size_t) dstsize * rw.taps, 0.0f);
+
+	for (int i = 0; i < dstsize; i++)
+	{
+		float center = (i + 0.5f) * scale;
+		int first = (int) floorf(center - support + 0.5f);
+		first = std::min(std::max(first, 0), srcsize - rw.taps);
+
+		float *weights = &rw.weights[(size_t) i * rw.taps];
+		float total = 0.0f;
+
+		for (int j = 0; j < rw.taps; j++)
+		{
+			weights[j] = filterWeight(filter, (first + j + 0.5f - center) / filterscale);
+			total += weights[j];
+		}
+
+		if (total != 0.0f)
+		{
+			for (int j = 0; j < rw.taps; j++)
+				weights[j] /= total;
+		}
+		else
+		{
+			// Can only happen with a box filter on an exact pixel edge.
+			int nearest = std::min(std::max((int) center, first), first + rw.taps - 1);
+			weights[nearest - first] = 1.0f;
+		}
+
+		rw.first[i] = first;
+	}
+}
+
+ImageData *ImageData::resize(int dstw, int dsth, ResizeFilter filter) const
+{
+	if (dstw <= 0 || dsth <= 0)
+		throw love::Exception("Invalid ImageData size: %dx%d", dstw, dsth);
+
+	ImageData *dst = new ImageData(dstw, dsth, format);
+
+	ResampleWeights xweights;
+	ResampleWeights yweights;
+	computeResampleWeights(width, dstw, filter, xweights);
+	computeResampleWeights(height, dsth, filter, yweights);
+
+	// Horizontal pass into a float buffer, then a vertical pass into dst.
+	std::vector<float> tmp((size_t) height * dstw * 4);
+
+	size_t srcrowsize = width * getPixelSize();
+	size_t dstrowsize = dstw * dst->getPixelSize();
+	uint8 *dstdata = (uint8 *) dst->getData();
+
+	auto &pool = love::thread::WorkerPool::getInstance();
+
+	{
+		Lock lock(mutex);
+
+		pool.parallelFor(height, getRowGrainSize(width), [&](int start, int end)
+		{
+			std::vector<float> row(width * 4);
+			for (int y = start; y < end; y++)
+			{
+				getRowFloat(data + y * srcrowsize, format, pixelGetFunction, width, row.data());
+
+				float *out = &tmp[(size_t) y * dstw * 4];
+				for (int x = 0; x < dstw; x++)
+				{
+					const float *weights = &xweights.weights[(size_t) x * xweights.taps];
+					const float *in = &row[xweights.first[x] * 4];
+					float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+
+					for (int j = 0; j < xweights.taps; j++)
+					{
+						r += in[j * 4 + 0] * weights[j];
+						g += in[j * 4 + 1] * weights[j];
+						b += in[j * 4 + 2] * weights[j];
+						a += in[j * 4 + 3] * weights[j];
+					}
+
+					out[x * 4 + 0] = r;
+					out[x * 4 + 1] = g;
+					out[x * 4 + 2] = b;
+					out[x * 4 + 3] = a;
+				}
+			}
+		});
+	}
+
+	pool.parallelFor(dsth, getRowGrainSize(dstw), [&](int start, int end)
+	{
+		std::vector<float> row(dstw * 4);
+		for (int y = start; y < end; y++)
+		{
+			const float *weights = &yweights.weights[(size_t) y * yweights.taps];
+			std::fill(row.begin(), row.end(), 0.0f);
+
+			for (int j = 0; j < yweights.taps; j++)
+			{
+				const float *in = &tmp[(size_t) (yweights.first[y] + j) * dstw * 4];
+				float weight = weights[j];
+				for (int i = 0; i < dstw * 4; i++)
+					row[i] += in[i] * weight;
+			}
+
+			setRowFloat(row.data(), format, dst->pixelSetFunction, dstw, dstdata + y * dstrowsize);
+		}
+	});
+
+	return dst;
+}
+
+void ImageData::generateMipmaps(bool gammacorrect, std::vector<StrongRef<ImageData>> &mipmaps) const
+{
+	mipmaps.clear();
+
+	int w = width;
+	int h = height;
+
+	// Levels are downsampled from the previous level, kept as RGBA floats so
+	// precision isn't lost along the chain.
+	std::vector<float> level((size_t) w * h * 4);
+	std::vector<float> next;
+	std::vector<float> tmp;
+
+	auto &pool = love::thread::WorkerPool::getInstance();
+
+	// Color channels are averaged in linear space when gamma-correct, alpha
+	// never is.
+	float tolinear[256];
+	for (int i = 0; i < 256; i++)
+		tolinear[i] = gammacorrect ? math::gammaToLinear(i / 255.0f) : i / 255.0f;
+
+	{
+		Lock lock(mutex);
+
+		size_t rowsize = w * getPixelSize();
+
+		pool.parallelFor(h, getRowGrainSize(w), [&](int start, int end)
+		{
+			for (int y = start; y < end; y++)
+			{
+				float *row = &level[(size_t) y * w * 4];
+				const uint8 *src = data + y * rowsize;
+
+				if (format == PIXELFORMAT_RGBA8)
+				{
+					for (int x = 0; x < w; x++)
+					{
+						row[x * 4 + 0] = tolinear[src[x * 4 + 0]];
+						row[x * 4 + 1] = tolinear[src[x * 4 + 1]];
+						row[x * 4 + 2] = tolinear[src[x * 4 + 2]];
+						row[x * 4 + 3] = src[x * 4 + 3] / 255.0f;
+					}
+					continue;
+				}
+
+				getRowFloat(src, format, pixelGetFunction, w, row);
+
+				if (gammacorrect)
+				{
+					for (int x = 0; x < w; x++)
+					{
+						for (int c = 0; c < 3; c++)
+							row[x * 4 + c] = math::gammaToLinear(row[x * 4 + c]);
+					}
+				}
+			}
+		});
+	}
+
+	while (w > 1 || h > 1)
+	{
+		int nw = std::max(w / 2, 1);
+		int nh = std::max(h / 2, 1);
+
+		// A box filter averages each 2x2 block, and spreads odd rows and
+		// columns evenly across their neighbours.
+		ResampleWeights xweights;
+		ResampleWeights yweights;
+		computeResampleWeights(w, nw, RESIZE_BOX, xweights);
+		computeResampleWeights(h, nh, RESIZE_BOX, yweights);
+
+		tmp.resize((size_t) h * nw * 4);
+		next.resize((size_t) nh * nw * 4);
+
+		pool.parallelFor(h, getRowGrainSize(w), [&](int start, int end)
+		{
+			for (int y = start; y < end; y++)
+			{
+				const float *row = &level[(size_t) y * w * 4];
+				float *out = &tmp[(size_t) y * nw * 4];
+
+				for (int x = 0; x < nw; x++)
+				{
+					const float *weights = &xweights.weights[(size_t) x * xweights.taps];
+					const float *in = &row[xweights.first[x] * 4];
+					float c[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+					for (int j = 0; j < xweights.taps; j++)
+					{
+						for (int i = 0; i < 4; i++)
+							c[i] += in[j * 4 + i] * weights[j];
+					}
+
+					memcpy(&out[x * 4], c, sizeof(c));
+				}
+			}
+		});
+
+		StrongRef<ImageData> mip(new ImageData(nw, nh, format), Acquire::NORETAIN);
+
+		size_t dstrowsize = nw * mip->getPixelSize();
+		uint8 *dstdata = (uint8 *) mip->getData();
+
+		pool.parallelFor(nh, getRowGrainSize(nw), [&](int start, int end)
+		{
+			std::vector<float> encoded(nw * 4);
+
+			for (int y = start; y < end; y++)
+			{
+				const float *weights = &yweights.weights[(size_t) y * yweights.taps];
+				float *row = &next[(size_t) y * nw * 4];
+				std::fill(row, row + nw * 4, 0.0f);
+
+				for (int j = 0; j < yweights.taps; j++)
+				{
+					const float *in = &tmp[(size_t) (yweights.first[y] + j) * nw * 4];
+					float weight = weights[j];
+					for (int i = 0; i < nw * 4; i++)
+						row[i] += in[i] * weight;
+				}
+
+				memcpy(encoded.data(), row, sizeof(float) * nw * 4);
+
+				if (gammacorrect)
+				{
+					for (int x = 0; x < nw; x++)
+					{
+						for (int c = 0; c < 3; c++)
+							encoded[x * 4 + c] = math::linearToGamma(encoded[x * 4 + c]);
+					}
+				}
+
+				setRowFloat(encoded.data(), format, mip->pixelSetFunction, nw, dstdata + y * dstrowsize);
+			}
+		});
+
+		mipmaps.push_back(mip);
+
+		std::swap(level, next);
+		w = nw;
+		h = nh;
+	}
+}
+
+void ImageData::blur(float sigma)
+{
+	if (!(sigma > 0.0f))
+		return;
+
+	int radius = std::max((int) ceilf(sigma * 3.0f), 1);
+
+	std::vector<float> kernel(radius * 2 + 1);
+	float total = 0.0f;
+	for (int i = -radius; i <= radius; i++)
+	{
+		kernel[i + radius] = expf(-(i * i) / (2.0f * sigma * sigma));
+		total += kernel[i + radius];
+	}
+	for (float &k : kernel)
+		k /= total;
+
+	Lock lock(mutex);
+
+	int w = width;
+	int h = height;
+	std::vector<float> tmp((size_t) w * h * 4);
+	size_t rowsize = w * getPixelSize();
+
+	auto &pool = love::thread::WorkerPool::getInstance();
+
+	// Horizontal pass into a float buffer, edges clamped.
+	pool.parallelFor(h, getRowGrainSize(w), [&](int start, int end)
+	{
+		std::vector<float> row(w * 4);
+		for (int y = start; y < end; y++)
+		{
+			getRowFloat(data + y * rowsize, format, pixelGetFunction, w, row.data());
+
+			float *out = &tmp[(size_t) y * w * 4];
+			for (int x = 0; x < w; x++)
+			{
+				float c[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+				for (int k = -radius; k <= radius; k++)
+				{
+					const float *in = &row[std::min(std::max(x + k, 0), w - 1) * 4];
+					float weight = kernel[k + radius];
+					for (int i = 0; i < 4; i++)
+						c[i] += in[i] * weight;
+				}
+				memcpy(&out[x * 4], c, sizeof(c));
+			}
+		}
+	});
+
+	// Vertical pass back into the pixels.
+	pool.parallelFor(h, getRowGrainSize(w), [&](int start, int end)
+	{
+		std::vector<float> row(w * 4);
+		for (int y = start; y < end; y++)
+		{
+			std::fill(row.begin(), row.end(), 0.0f);
+
+			for (int k = -radius; k <= radius; k++)
+			{
+				const float *in = &tmp[(size_t) std::min(std::max(y + k, 0), h - 1) * w * 4];
+				float weight = kernel[k + radius];
+				for (int i = 0; i < w * 4; i++)
+					row[i] += in[i] * weight;
+			}
+
+			setRowFloat(row.data(), format, pixelSetFunction, w, data + y * rowsize);
+		}
+	});
+}
+
+void ImageData::premultiply()
+{
+	Lock lock(mutex);
+
+	if (format == PIXELFORMAT_RGBA8)
+	{
+		size_t count = (size_t) width * height;
+		for (size_t i = 0; i < count; i++)
+		{
+			uint8 *p = data + i * 4;
+			int a = p[3];
+			for (int c = 0; c < 3; c++)
+				p[c] = (uint8) ((p[c] * a + 127) / 255);
+		}
+		return;
+	}
+
+	transformRowsFloat(this, [](float *row, int w)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			float *p = row + x * 4;
+			p[0] *= p[3];
+			p[1] *= p[3];
+			p[2] *= p[3];
+		}
+	});
+}
+
+void ImageData::unpremultiply()
+{
+	Lock lock(mutex);
+
+	if (format == PIXELFORMAT_RGBA8)
+	{
+		size_t count = (size_t) width * height;
+		for (size_t i = 0; i < count; i++)
+		{
+			uint8 *p = data + i * 4;
+			int a = p[3];
+			for (int c = 0; c < 3; c++)
+				p[c] = a > 0 ? (uint8) std::min((p[c] * 255 + a / 2) / a, 255) : 0;
+		}
+		return;
+	}
+
+	transformRowsFloat(this, [](float *row, int w)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			float *p = row + x * 4;
+			float inva = p[3] > 0.0f ? 1.0f / p[3] : 0.0f;
+			p[0] *= inva;
+			p[1] *= inva;
+			p[2] *= inva;
+		}
+	});
+}
+
+ImageData *ImageData::convert(PixelFormat dstformat) const
+{
+	if (!validPixelFormat(dstformat))
+		throw love::Exception("Unsupported pixel format for ImageData");
+
+	ImageData *dst = new ImageData(width, height, dstformat);
+
+	// paste() already converts between every format ImageData supports.
+	dst->paste((ImageData *) this, 0, 0, 0, 0, width, height);
+
+	return dst;
+}
+
+void ImageData::swizzle(const SwizzleSource sources[4])
+{
+	Lock lock(mutex);
+
+	const auto swizzlepixel = [sources](const float *in, float *out)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			if (sources[i] == SWIZZLE_ZERO)
+				out[i] = 0.0f;
+			else if (sources[i] == SWIZZLE_ONE)
+				out[i] = 1.0f;
+			else
+				out[i] = in[sources[i]];
+		}
+	};
+
+	if (format == PIXELFORMAT_RGBA8)
+	{
+		size_t count = (size_t) width * height;
+		for (size_t i = 0; i < count; i++)
+		{
+			uint8 *p = data + i * 4;
+			uint8 in[6] = {p[0], p[1], p[2], p[3], 0, 255};
+			for (int c = 0; c < 4; c++)
+				p[c] = in[sources[c]];
+		}
+		return;
+	}
+
+	transformRowsFloat(this, [&](float *row, int w)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			float in[4];
+			memcpy(in, row + x * 4, sizeof(in));
+			swizzlepixel(in, row + x * 4);
+		}
+	});
+}
+
 love::thread::Mutex *ImageData::getMutex() const
 {
 	return mutex;
@@ -817,15 +1778,8 @@ bool ImageData::canPaste(PixelFormat src, PixelFormat dst)
 	if (src == dst)
 		return true;
 
-	if (!(src == PIXELFORMAT_RGBA8 || src == PIXELFORMAT_RGBA16
-		|| src == PIXELFORMAT_RGBA16F || src == PIXELFORMAT_RGBA32F))
-		return false;
-
-	if (!(dst == PIXELFORMAT_RGBA8 || dst == PIXELFORMAT_RGBA16
-		|| dst == PIXELFORMAT_RGBA16F || dst == PIXELFORMAT_RGBA32F))
-		return false;
-
-	return true;
+	// Anything else goes through the pixel get/set functions if need be.
+	return getPixelGetFunction(src) != nullptr && getPixelSetFunction(dst) != nullptr;
 }
 
 ImageData::PixelSetFunction ImageData::getPixelSetFunction(PixelFormat format)
@@ -897,9 +1851,60 @@ StringMap<FormatHandler::EncodedFormat, FormatHandler::ENCODED_MAX_ENUM>::Entry
 {
 	{"tga", FormatHandler::ENCODED_TGA},
 	{"png", FormatHandler::ENCODED_PNG},
+	{"qoi", FormatHandler::ENCODED_QOI},
+	{"ltex", FormatHandler::ENCODED_LTEX},
 };
 
 StringMap<FormatHandler::EncodedFormat, FormatHandler::ENCODED_MAX_ENUM> ImageData::encodedFormats(ImageData::encodedFormatEntries, sizeof(ImageData::encodedFormatEntries));
 
+bool ImageData::getConstant(const char *in, ResizeFilter &out)
+{
+	return resizeFilters.find(in, out);
+}
+
+bool ImageData::getConstant(ResizeFilter in, const char *&out)
+{
+	return resizeFilters.find(in, out);
+}
+
+std::vector<std::string> ImageData::getConstants(ResizeFilter)
+{
+	return resizeFilters.getNames();
+}
+
+bool ImageData::getConstant(const char *in, BlendMode &out)
+{
+	return blendModes.find(in, out);
+}
+
+bool ImageData::getConstant(BlendMode in, const char *&out)
+{
+	return blendModes.find(in, out);
+}
+
+std::vector<std::string> ImageData::getConstants(BlendMode)
+{
+	return blendModes.getNames();
+}
+
+StringMap<ImageData::ResizeFilter, ImageData::RESIZE_MAX_ENUM>::Entry ImageData::resizeFilterEntries[] =
+{
+	{"box", RESIZE_BOX},
+	{"bilinear", RESIZE_BILINEAR},
+	{"lanczos", RESIZE_LANCZOS},
+};
+
+StringMap<ImageData::ResizeFilter, ImageData::RESIZE_MAX_ENUM> ImageData::resizeFilters(ImageData::resizeFilterEntries, sizeof(ImageData::resizeFilterEntries));
+
+StringMap<ImageData::BlendMode, ImageData::BLEND_MAX_ENUM>::Entry ImageData::blendModeEntries[] =
+{
+	{"replace", BLEND_REPLACE},
+	{"alpha", BLEND_ALPHA},
+	{"add", BLEND_ADD},
+	{"multiply", BLEND_MULTIPLY},
+};
+
+StringMap<ImageData::BlendMode, ImageData::BLEND_MAX_ENUM> ImageData::blendModes(ImageData::blendModeEntries, sizeof(ImageData::blendModeEntries));
+
 } // image
 } // love
@@ -27,6 +27,7 @@
 #include "common/pixelformat.h"
 #include "common/floattypes.h"
 #include "common/Color.h"
+#include "common/math.h"
 #include "filesystem/FileData.h"
 #include "thread/threads.h"
 #include "ImageDataBase.h"
@@ -36,6 +37,11 @@ using love::thread::Mutex;
 
 namespace love
 {
+namespace thread
+{
+class Channel;
+}
+
 namespace image
 {
 
@@ -56,12 +62,48 @@ class ImageData : public ImageDataBase
 		uint32  packed32;
 	};
 
+	enum ResizeFilter
+	{
+		RESIZE_BOX,
+		RESIZE_BILINEAR,
+		RESIZE_LANCZOS,
+		RESIZE_MAX_ENUM
+	};
+
+	// How paste() combines source pixels with the pixels already there. Colors
+	// are treated as non-premultiplied.
+	enum BlendMode
+	{
+		BLEND_REPLACE,  // dst = src.
+		BLEND_ALPHA,    // dst = src * src.a + dst * (1 - src.a).
+		BLEND_ADD,      // dst.rgb += src.rgb * src.a.
+		BLEND_MULTIPLY, // dst.rgb *= mix(1, src.rgb, src.a).
+		BLEND_MAX_ENUM
+	};
+
+	// Where each channel gets its value from, in swizzle().
+	enum SwizzleSource
+	{
+		SWIZZLE_R,
+		SWIZZLE_G,
+		SWIZZLE_B,
+		SWIZZLE_A,
+		SWIZZLE_ZERO,
+		SWIZZLE_ONE,
+	};
+
 	typedef void (*PixelSetFunction)(const Colorf &c, Pixel *p);
 	typedef void (*PixelGetFunction)(const Pixel *p, Colorf &c);
 
 	static love::Type type;
 
 	ImageData(Data *data);
+
+	/**
+	 * Decodes only the given rectangle of an encoded image. For formats which
+	 * support it, the rest of the image is never held in memory.
+	 **/
+	ImageData(Data *data, const Rect &region);
 	ImageData(int width, int height, PixelFormat format = PIXELFORMAT_RGBA8);
 	ImageData(int width, int height, PixelFormat format, void *data, bool own);
 	ImageData(const ImageData &c);
@@ -76,8 +118,52 @@ class ImageData : public ImageDataBase
 	 * @param sy The source y-coordinate.
 	 * @param sw The source width.
 	 * @param sh The source height.
+	 * @param blend How the pasted pixels are combined with the existing ones.
+	 * Any two formats with pixel get/set functions can be pasted between.
+	 **/
+	void paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh, BlendMode blend = BLEND_REPLACE);
+
+	/**
+	 * Creates a resampled copy of this ImageData, in the same format. Large
+	 * images are processed on worker threads.
+	 * @param width The width of the new ImageData.
+	 * @param height The height of the new ImageData.
+	 * @param filter The resampling filter to use.
+	 **/
+	ImageData *resize(int width, int height, ResizeFilter filter) const;
+
+	/**
+	 * Generates every mipmap level below this one, each half the size of the
+	 * previous, down to 1x1. Levels are created on worker threads.
+	 * @param gammacorrect Whether the color channels are sRGB-encoded, and
+	 *        should be averaged in linear space.
+	 * @param mipmaps Receives the levels, starting with the largest.
+	 **/
+	void generateMipmaps(bool gammacorrect, std::vector<StrongRef<ImageData>> &mipmaps) const;
+
+	/**
+	 * Applies a Gaussian blur to the pixels, with edges clamped.
+	 * @param sigma The standard deviation of the blur, in pixels.
+	 **/
+	void blur(float sigma);
+
+	/**
+	 * Multiplies (or divides) the color channels by the alpha channel.
 	 **/
-	void paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh);
+	void premultiply();
+	void unpremultiply();
+
+	/**
+	 * Creates a copy of this ImageData in a different pixel format.
+	 **/
+	ImageData *convert(PixelFormat format) const;
+
+	/**
+	 * Rearranges the channels of each pixel.
+	 * @param sources Where the red, green, blue and alpha channels get their
+	 *        new values from.
+	 **/
+	void swizzle(const SwizzleSource sources[4]);
 
 	/**
 	 * Checks whether a position is inside this ImageData. Useful for checking bounds.
@@ -103,12 +189,44 @@ class ImageData : public ImageDataBase
 	void getPixel(int x, int y, Colorf &c) const;
 	Colorf getPixel(int x, int y) const;
 
+	/**
+	 * Reads or writes a rectangle of pixels as RGBA floats, 4 per pixel and
+	 * row by row. The ImageData is locked once for the whole rectangle.
+	 **/
+	void getPixels(const Rect &rect, float *rgba) const;
+	void setPixels(const Rect &rect, const float *rgba);
+
+	/**
+	 * Reads or writes a rectangle of pixels in the ImageData's own pixel
+	 * format, with tightly packed rows.
+	 **/
+	void getRawPixels(const Rect &rect, void *dst) const;
+	void setRawPixels(const Rect &rect, const void *src);
+
+	/**
+	 * Sets every pixel in a rectangle to the same color.
+	 **/
+	void fill(const Rect &rect, const Colorf &c);
+
+	/**
+	 * Sets every byte of the pixels in a rectangle to 0 (transparent black.)
+	 **/
+	void clear(const Rect &rect);
+
 	/**
 	 * Encodes raw pixel data into a given format.
 	 * @param f The file to save the encoded image data to.
 	 * @param format The format of the encoded data.
+	 * @param compressionlevel From 0 (fastest) to 9 (smallest), or -1 for the
+	 *        format's default.
 	 **/
-	love::filesystem::FileData *encode(FormatHandler::EncodedFormat format, const char *filename, bool writefile) const;
+	love::filesystem::FileData *encode(FormatHandler::EncodedFormat format, const char *filename, bool writefile, int compressionlevel = -1) const;
+
+	/**
+	 * Encodes on a worker thread. When it's done the FileData is pushed to the
+	 * Channel, or an error message string if encoding failed.
+	 **/
+	void encodeAsync(FormatHandler::EncodedFormat format, const char *filename, int compressionlevel, love::thread::Channel *channel);
 
 	love::thread::Mutex *getMutex() const;
 
@@ -133,13 +251,25 @@ class ImageData : public ImageDataBase
 	static bool getConstant(FormatHandler::EncodedFormat in, const char *&out);
 	static std::vector<std::string> getConstants(FormatHandler::EncodedFormat);
 
+	static bool getConstant(const char *in, ResizeFilter &out);
+	static bool getConstant(ResizeFilter in, const char *&out);
+	static std::vector<std::string> getConstants(ResizeFilter);
+
+	static bool getConstant(const char *in, BlendMode &out);
+	static bool getConstant(BlendMode in, const char *&out);
+	static std::vector<std::string> getConstants(BlendMode);
+
 private:
 
 	// Create imagedata. Initialize with data if not null.
 	void create(int width, int height, PixelFormat format, void *data = nullptr);
 
-	// Decode and load an encoded format.
-	void decode(Data *data);
+	// Decode and load an encoded format, or only a region of it.
+	void decode(Data *data, const Rect *region = nullptr);
+
+	// The blending half of paste(), once the rectangle has been clipped and
+	// both images are locked.
+	void pasteBlended(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh, BlendMode blend);
 
 	// The actual data.
 	unsigned char *data = nullptr;
@@ -156,6 +286,12 @@ class ImageData : public ImageDataBase
 	static StringMap<FormatHandler::EncodedFormat, FormatHandler::ENCODED_MAX_ENUM>::Entry encodedFormatEntries[];
 	static StringMap<FormatHandler::EncodedFormat, FormatHandler::ENCODED_MAX_ENUM> encodedFormats;
 
+	static StringMap<ResizeFilter, RESIZE_MAX_ENUM>::Entry resizeFilterEntries[];
+	static StringMap<ResizeFilter, RESIZE_MAX_ENUM> resizeFilters;
+
+	static StringMap<BlendMode, BLEND_MAX_ENUM>::Entry blendModeEntries[];
+	static StringMap<BlendMode, BLEND_MAX_ENUM> blendModes;
+
 }; // ImageData
 
 } // image
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "ImageDecodeBatch.h"
+
+namespace love
+{
+namespace image
+{
+
+love::Type ImageDecodeBatch::type("ImageDecodeBatch", &Object::type);
+
+ImageDecodeBatch::DecodeTask::DecodeTask(Data *data)
+	: data(data)
+{
+}
+
+void ImageDecodeBatch::DecodeTask::run()
+{
+	imageData.set(new ImageData(data), Acquire::NORETAIN);
+
+	// The encoded data isn't needed anymore.
+	data.set(nullptr);
+}
+
+ImageDecodeBatch::ImageDecodeBatch(const std::vector<Data *> &datas)
+{
+	auto &pool = love::thread::WorkerPool::getInstance();
+
+	tasks.reserve(datas.size());
+
+	for (Data *data : datas)
+	{
+		DecodeTask *task = new DecodeTask(data);
+		tasks.emplace_back(task, Acquire::NORETAIN);
+		pool.submit(task);
+	}
+}
+
+ImageDecodeBatch::~ImageDecodeBatch()
+{
+	// Tasks which are still queued are kept alive by the WorkerPool.
+}
+
+int ImageDecodeBatch::getCount() const
+{
+	return (int) tasks.size();
+}
+
+int ImageDecodeBatch::getDecodedCount() const
+{
+	int count = 0;
+	for (const auto &task : tasks)
+	{
+		if (task->isFinished())
+			count++;
+	}
+	return count;
+}
+
+bool ImageDecodeBatch::isComplete() const
+{
+	for (const auto &task : tasks)
+	{
+		if (!task->isFinished())
+			return false;
+	}
+	return true;
+}
+
+void ImageDecodeBatch::wait()
+{
+	for (const auto &task : tasks)
+		task->wait();
+}
+
+ImageData *ImageDecodeBatch::getImageData(int index, std::string &error)
+{
+	if (index < 0 || index >= (int) tasks.size())
+		throw love::Exception("Invalid image index: %d", index + 1);
+
+	DecodeTask *task = tasks[index];
+	task->wait();
+
+	if (task->hasError())
+	{
+		error = task->getError();
+		return nullptr;
+	}
+
+	return task->getImageData();
+}
+
+} // image
+} // love
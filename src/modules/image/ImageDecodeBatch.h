@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_IMAGE_IMAGE_DECODE_BATCH_H
+#define LOVE_IMAGE_IMAGE_DECODE_BATCH_H
+
+// LOVE
+#include "common/Object.h"
+#include "common/Data.h"
+#include "thread/WorkerPool.h"
+#include "ImageData.h"
+
+// C++
+#include <vector>
+#include <string>
+
+namespace love
+{
+namespace image
+{
+
+/**
+ * Decodes a list of encoded images concurrently, on the shared WorkerPool.
+ * Decoding starts as soon as the batch is created, and results can be
+ * retrieved in any order.
+ **/
+class ImageDecodeBatch : public Object
+{
+public:
+
+	static love::Type type;
+
+	ImageDecodeBatch(const std::vector<Data *> &datas);
+	virtual ~ImageDecodeBatch();
+
+	int getCount() const;
+
+	/**
+	 * Gets the number of images which have finished decoding, successfully
+	 * or not.
+	 **/
+	int getDecodedCount() const;
+
+	bool isComplete() const;
+
+	/**
+	 * Blocks until every image has finished decoding.
+	 **/
+	void wait();
+
+	/**
+	 * Waits for the image at the given index to finish decoding and returns
+	 * it, or null if it failed to decode. The reason is put in error.
+	 **/
+	ImageData *getImageData(int index, std::string &error);
+
+private:
+
+	class DecodeTask : public love::thread::Task
+	{
+	public:
+
+		DecodeTask(Data *data);
+		virtual ~DecodeTask() {}
+
+		void run() override;
+
+		ImageData *getImageData() const { return imageData.get(); }
+
+	private:
+
+		StrongRef<Data> data;
+		StrongRef<ImageData> imageData;
+
+	}; // DecodeTask
+
+	std::vector<StrongRef<DecodeTask>> tasks;
+
+}; // ImageDecodeBatch
+
+} // image
+} // love
+
+#endif // LOVE_IMAGE_IMAGE_DECODE_BATCH_H
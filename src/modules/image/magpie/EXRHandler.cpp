@@ -200,7 +200,7 @@ FormatHandler::DecodedImage EXRHandler::decode(Data *data)
 	return img;
 }
 
-FormatHandler::EncodedImage EXRHandler::encode(const DecodedImage & /*img*/, EncodedFormat /*encodedFormat*/)
+FormatHandler::EncodedImage EXRHandler::encode(const DecodedImage & /*img*/, EncodedFormat /*encodedFormat*/, int /*compressionLevel*/)
 {
 	throw love::Exception("Invalid format.");
 }
@@ -42,7 +42,7 @@ class EXRHandler : public FormatHandler
 	virtual bool canEncode(PixelFormat rawFormat, EncodedFormat encodedFormat);
 
 	virtual DecodedImage decode(Data *data);
-	virtual EncodedImage encode(const DecodedImage &img, EncodedFormat format);
+	EncodedImage encode(const DecodedImage &img, EncodedFormat format, int compressionLevel) override;
 
 	virtual void freeRawPixels(unsigned char *mem);
 
@@ -0,0 +1,240 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "LTEXHandler.h"
+#include "common/int.h"
+#include "common/Exception.h"
+
+// C++
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+namespace love
+{
+namespace image
+{
+namespace magpie
+{
+
+namespace
+{
+
+// Little endian to host (and vice versa.)
+inline uint32 swap32little(uint32 x)
+{
+#ifdef LOVE_BIG_ENDIAN
+	return swapuint32(x);
+#else
+	return x;
+#endif
+}
+
+inline uint64 swap64little(uint64 x)
+{
+#ifdef LOVE_BIG_ENDIAN
+	return swapuint64(x);
+#else
+	return x;
+#endif
+}
+
+static const uint8 ltexIdentifier[] = {'L','O','V','E','T','E','X', 0};
+
+static const uint32 LTEX_VERSION = 1;
+static const uint32 LTEX_FLAG_SRGB = 1;
+
+// Level data offsets are aligned to this, so uploads read aligned memory.
+static const uint64 LTEX_ALIGNMENT = 16;
+
+static const uint32 LTEX_MAX_MIPMAPS = 32;
+
+struct LTEXHeader
+{
+	uint8  identifier[8];
+	uint32 version;
+	uint32 flags;
+	char   format[16];
+	uint32 width;
+	uint32 height;
+	uint32 mipmapCount;
+	uint32 reserved;
+};
+
+struct LTEXMipmap
+{
+	uint64 offset;
+	uint64 size;
+};
+
+static_assert(sizeof(LTEXHeader) == 48, "Real size of LTEXHeader must match the file layout!");
+static_assert(sizeof(LTEXMipmap) == 16, "Real size of LTEXMipmap must match the file layout!");
+
+} // Anonymous namespace.
+
+bool LTEXHandler::canEncode(PixelFormat rawFormat, EncodedFormat encodedFormat)
+{
+	const char *name = nullptr;
+	return encodedFormat == ENCODED_LTEX && love::getConstant(rawFormat, name)
+		&& !isPixelFormatCompressed(rawFormat) && getPixelFormatSize(rawFormat) > 0;
+}
+
+FormatHandler::EncodedImage LTEXHandler::encode(const DecodedImage &img, EncodedFormat encodedFormat, int /*compressionLevel*/)
+{
+	if (!canEncode(img.format, encodedFormat))
+		throw love::Exception("LTEX encoder cannot encode to non-LTEX format.");
+
+	const char *name = nullptr;
+	love::getConstant(img.format, name);
+
+	LTEXHeader header = {};
+	memcpy(header.identifier, ltexIdentifier, sizeof(ltexIdentifier));
+	header.version = swap32little(LTEX_VERSION);
+	header.flags = 0;
+	strncpy(header.format, name, sizeof(header.format));
+	header.width = swap32little((uint32) img.width);
+	header.height = swap32little((uint32) img.height);
+	header.mipmapCount = swap32little(1);
+
+	// The header and a single table entry already end on an aligned offset.
+	LTEXMipmap mip = {};
+	mip.offset = swap64little(sizeof(LTEXHeader) + sizeof(LTEXMipmap));
+	mip.size = swap64little(img.size);
+
+	EncodedImage encimg;
+	encimg.size = sizeof(LTEXHeader) + sizeof(LTEXMipmap) + img.size;
+
+	try
+	{
+		encimg.data = new unsigned char[encimg.size];
+	}
+	catch (std::exception &)
+	{
+		throw love::Exception("Out of memory.");
+	}
+
+	memcpy(encimg.data, &header, sizeof(LTEXHeader));
+	memcpy(encimg.data + sizeof(LTEXHeader), &mip, sizeof(LTEXMipmap));
+	memcpy(encimg.data + sizeof(LTEXHeader) + sizeof(LTEXMipmap), img.data, img.size);
+
+	return encimg;
+}
+
+bool LTEXHandler::canParseCompressed(Data *data)
+{
+	if (data->getSize() < sizeof(LTEXHeader))
+		return false;
+
+	return memcmp(data->getData(), ltexIdentifier, sizeof(ltexIdentifier)) == 0;
+}
+
+StrongRef<CompressedMemory> LTEXHandler::parseCompressed(Data *filedata, std::vector<StrongRef<CompressedSlice>> &images, PixelFormat &format, bool &sRGB)
+{
+	if (!canParseCompressed(filedata))
+		throw love::Exception("Could not decode compressed data (not an LTEX file?)");
+
+	const uint8 *bytes = (const uint8 *) filedata->getData();
+	uint64 filesize = filedata->getSize();
+
+	LTEXHeader header;
+	memcpy(&header, bytes, sizeof(LTEXHeader));
+
+	header.version = swap32little(header.version);
+	header.flags = swap32little(header.flags);
+	header.width = swap32little(header.width);
+	header.height = swap32little(header.height);
+	header.mipmapCount = swap32little(header.mipmapCount);
+
+	if (header.version != LTEX_VERSION)
+		throw love::Exception("Could not parse LTEX file: unsupported version %d.", (int) header.version);
+
+	char name[sizeof(header.format) + 1] = {};
+	memcpy(name, header.format, sizeof(header.format));
+
+	PixelFormat cformat = PIXELFORMAT_UNKNOWN;
+	if (!love::getConstant(name, cformat) || isPixelFormatDepthStencil(cformat))
+		throw love::Exception("Could not parse LTEX file: unsupported pixel format '%s'.", name);
+
+	if (header.width == 0 || header.height == 0 || header.width > (uint32) std::numeric_limits<int>::max()
+		|| header.height > (uint32) std::numeric_limits<int>::max())
+		throw love::Exception("Could not parse LTEX file: invalid dimensions.");
+
+	if (header.mipmapCount == 0 || header.mipmapCount > LTEX_MAX_MIPMAPS)
+		throw love::Exception("Could not parse LTEX file: invalid mipmap count.");
+
+	uint64 tableend = sizeof(LTEXHeader) + sizeof(LTEXMipmap) * header.mipmapCount;
+	if (filesize < tableend)
+		throw love::Exception("Could not parse LTEX file: file is too small.");
+
+	std::vector<LTEXMipmap> mipmaps(header.mipmapCount);
+
+	uint64 datastart = std::numeric_limits<uint64>::max();
+	uint64 dataend = 0;
+
+	for (uint32 i = 0; i < header.mipmapCount; i++)
+	{
+		LTEXMipmap &mip = mipmaps[i];
+		memcpy(&mip, bytes + sizeof(LTEXHeader) + sizeof(LTEXMipmap) * i, sizeof(LTEXMipmap));
+
+		mip.offset = swap64little(mip.offset);
+		mip.size = swap64little(mip.size);
+
+		if (mip.offset < tableend || mip.offset % LTEX_ALIGNMENT != 0 || mip.size == 0
+			|| mip.offset > filesize || mip.size > filesize - mip.offset)
+			throw love::Exception("Could not parse LTEX file: invalid data for mipmap level %d.", (int) i + 1);
+
+		// Compressed level sizes depend on the block layout, so those are
+		// only bounds-checked (like the other container formats.)
+		if (!isPixelFormatCompressed(cformat))
+		{
+			uint64 w = std::max(header.width >> i, 1u);
+			uint64 h = std::max(header.height >> i, 1u);
+			if (mip.size != w * h * getPixelFormatSize(cformat))
+				throw love::Exception("Could not parse LTEX file: invalid data size for mipmap level %d.", (int) i + 1);
+		}
+
+		datastart = std::min(datastart, mip.offset);
+		dataend = std::max(dataend, mip.offset + mip.size);
+	}
+
+	// Reference the level data in place rather than copying it out. The
+	// slices keep the file's Data alive through the memory object.
+	StrongRef<CompressedMemory> memory;
+	memory.set(new CompressedMemory(filedata, (size_t) datastart, (size_t) (dataend - datastart)), Acquire::NORETAIN);
+
+	for (uint32 i = 0; i < header.mipmapCount; i++)
+	{
+		int w = (int) std::max(header.width >> i, 1u);
+		int h = (int) std::max(header.height >> i, 1u);
+		size_t offset = (size_t) (mipmaps[i].offset - datastart);
+
+		images.emplace_back(new CompressedSlice(cformat, w, h, memory, offset, (size_t) mipmaps[i].size), Acquire::NORETAIN);
+	}
+
+	format = cformat;
+	sRGB = (header.flags & LTEX_FLAG_SRGB) != 0;
+
+	return memory;
+}
+
+} // magpie
+} // image
+} // love
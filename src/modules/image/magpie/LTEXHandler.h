@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+#include "common/config.h"
+#include "image/FormatHandler.h"
+
+namespace love
+{
+namespace image
+{
+namespace magpie
+{
+
+/**
+ * Handles LTEX files, LOVE's own texture container. They hold a mipmap chain
+ * already laid out the way the GPU expects it, compressed or not, so parsing
+ * one only validates the header and points each mipmap level at the file's
+ * memory. Combined with a memory-mapped file, nothing is copied before upload.
+ *
+ * Layout (all fields little-endian):
+ *   uint8  identifier[8]  "LOVETEX" followed by a zero byte.
+ *   uint32 version        1.
+ *   uint32 flags          Bit 0: sRGB.
+ *   char   format[16]     Pixel format name (e.g. "rgba8", "dxt5"), zero-padded.
+ *   uint32 width, height  Size of the base mipmap level.
+ *   uint32 mipmapCount
+ *   uint32 reserved
+ *   Followed by mipmapCount {uint64 offset, uint64 size} entries. Offsets are
+ *   from the start of the file and must be multiples of 16.
+ **/
+class LTEXHandler : public FormatHandler
+{
+public:
+
+	virtual ~LTEXHandler() {}
+
+	// Implements FormatHandler.
+	bool canEncode(PixelFormat rawFormat, EncodedFormat encodedFormat) override;
+	EncodedImage encode(const DecodedImage &img, EncodedFormat format, int compressionLevel) override;
+
+	bool canParseCompressed(Data *data) override;
+
+	StrongRef<CompressedMemory> parseCompressed(Data *filedata,
+	        std::vector<StrongRef<CompressedSlice>> &images,
+	        PixelFormat &format, bool &sRGB) override;
+
+}; // LTEXHandler
+
+} // magpie
+} // image
+} // love
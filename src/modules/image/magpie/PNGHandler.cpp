@@ -21,8 +21,10 @@
 #include "PNGHandler.h"
 
 // LOVE
+#include "common/config.h"
 #include "common/Exception.h"
 #include "common/math.h"
+#include "thread/WorkerPool.h"
 
 // LodePNG
 #include "lodepng/lodepng.h"
@@ -32,9 +34,16 @@
 
 // C++
 #include <algorithm>
+#include <string>
+#include <vector>
 
 // C
 #include <cstdlib>
+#include <cstring>
+
+#ifdef LOVE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace love
 {
@@ -97,35 +106,916 @@ static unsigned zlibDecompress(unsigned char **out, size_t *outsize, const unsig
 	return 0; // Success.
 }
 
-// Custom PNG compression function for LodePNG, using zlib.
-static unsigned zlibCompress(unsigned char **out, size_t *outsize, const unsigned char *in,
-                             size_t insize, const LodePNGCompressSettings* /*settings*/)
+// Fast path for the common kinds of PNG (non-interlaced, 8 or 16 bits per
+// channel). It inflates straight into a buffer of the exact final size and
+// reconstructs the filters in place, instead of going through LodePNG's
+// generic conversion code. Anything else is left to LodePNG.
+
+static inline uint32 readBigEndian32(const uint8 *p)
 {
-	// Get the maximum compressed size of the data.
-	uLongf outdatasize = compressBound(insize);
+	return ((uint32) p[0] << 24) | ((uint32) p[1] << 16) | ((uint32) p[2] << 8) | (uint32) p[3];
+}
 
-	// LodePNG uses malloc, realloc, and free.
-	unsigned char *outdata = (unsigned char *) malloc(outdatasize);
+static inline uint8 paethPredictor(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = abs(p - a);
+	int pb = abs(p - b);
+	int pc = abs(p - c);
 
-	if (!outdata)
-		return 83; // "Memory allocation failed" error code for LodePNG.
+	if (pa <= pb && pa <= pc)
+		return (uint8) a;
+	else if (pb <= pc)
+		return (uint8) b;
+	else
+		return (uint8) c;
+}
 
-	// Use zlib to compress the PNG data.
-	int status = compress(outdata, &outdatasize, in, insize);
+#ifdef LOVE_SIMD_SSE2
 
-	if (status != Z_OK)
+// Based on the approach of libpng's SSE2 filter code: one pixel (3 or 4
+// bytes) is reconstructed per iteration, since each depends on the last.
+
+template <int BPP>
+static inline __m128i loadPixel(const uint8 *p)
+{
+	int v = 0;
+	memcpy(&v, p, BPP);
+	return _mm_cvtsi32_si128(v);
+}
+
+template <int BPP>
+static inline void storePixel(uint8 *p, __m128i v)
+{
+	int x = _mm_cvtsi128_si32(v);
+	memcpy(p, &x, BPP);
+}
+
+template <int BPP>
+static void unfilterSubSSE2(uint8 *row, size_t rowbytes)
+{
+	__m128i a = _mm_setzero_si128();
+	for (size_t i = 0; i < rowbytes; i += BPP)
 	{
-		free(outdata);
-		return 10000; // "Unknown error code" for LodePNG.
+		a = _mm_add_epi8(a, loadPixel<BPP>(row + i));
+		storePixel<BPP>(row + i, a);
 	}
+}
 
-	if (out != nullptr)
-		*out = outdata;
+template <int BPP>
+static void unfilterAvgSSE2(uint8 *row, const uint8 *prev, size_t rowbytes)
+{
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i a = _mm_setzero_si128();
 
-	if (outsize != nullptr)
-		*outsize = (size_t) outdatasize;
+	for (size_t i = 0; i < rowbytes; i += BPP)
+	{
+		__m128i b = loadPixel<BPP>(prev + i);
 
-	return 0; // Success.
+		// _mm_avg_epu8 rounds up, PNG's average rounds down.
+		__m128i avg = _mm_avg_epu8(a, b);
+		avg = _mm_sub_epi8(avg, _mm_and_si128(_mm_xor_si128(a, b), one));
+
+		a = _mm_add_epi8(loadPixel<BPP>(row + i), avg);
+		storePixel<BPP>(row + i, a);
+	}
+}
+
+static inline __m128i abs16(__m128i x)
+{
+	return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static inline __m128i select128(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+template <int BPP>
+static void unfilterPaethSSE2(uint8 *row, const uint8 *prev, size_t rowbytes)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i a = zero;
+	__m128i c = zero;
+
+	for (size_t i = 0; i < rowbytes; i += BPP)
+	{
+		// Work in 16 bits, so the predictor's intermediates can't overflow.
+		__m128i b = _mm_unpacklo_epi8(loadPixel<BPP>(prev + i), zero);
+		__m128i d = _mm_unpacklo_epi8(loadPixel<BPP>(row + i), zero);
+
+		__m128i pa = _mm_sub_epi16(b, c);
+		__m128i pb = _mm_sub_epi16(a, c);
+		__m128i pc = _mm_add_epi16(pa, pb);
+
+		pa = abs16(pa);
+		pb = abs16(pb);
+		pc = abs16(pc);
+
+		__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+		__m128i nearest = select128(_mm_cmpeq_epi16(smallest, pa), a,
+		                  select128(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+		// Only the low byte of each lane matters, so it can wrap.
+		d = _mm_add_epi8(d, nearest);
+		storePixel<BPP>(row + i, _mm_packus_epi16(d, d));
+
+		c = b;
+		a = _mm_and_si128(d, _mm_set1_epi16(0xFF));
+	}
+}
+
+#endif // LOVE_SIMD_SSE2
+
+// Reverses the filter of a row in place. prev is a row of zeroes for the
+// first row of the image.
+static bool unfilterRow(uint8 filter, uint8 *row, const uint8 *prev, size_t rowbytes, int bpp)
+{
+	switch (filter)
+	{
+	case 0: // None
+		return true;
+	case 1: // Sub
+#ifdef LOVE_SIMD_SSE2
+		if (bpp == 4)
+			unfilterSubSSE2<4>(row, rowbytes);
+		else if (bpp == 3)
+			unfilterSubSSE2<3>(row, rowbytes);
+		else
+#endif
+		{
+			for (size_t i = bpp; i < rowbytes; i++)
+				row[i] += row[i - bpp];
+		}
+		return true;
+	case 2: // Up
+		// Simple enough for the compiler to vectorize.
+		for (size_t i = 0; i < rowbytes; i++)
+			row[i] += prev[i];
+		return true;
+	case 3: // Average
+#ifdef LOVE_SIMD_SSE2
+		if (bpp == 4)
+			unfilterAvgSSE2<4>(row, prev, rowbytes);
+		else if (bpp == 3)
+			unfilterAvgSSE2<3>(row, prev, rowbytes);
+		else
+#endif
+		{
+			for (int i = 0; i < bpp; i++)
+				row[i] += prev[i] >> 1;
+			for (size_t i = bpp; i < rowbytes; i++)
+				row[i] += (uint8) (((int) row[i - bpp] + (int) prev[i]) >> 1);
+		}
+		return true;
+	case 4: // Paeth
+#ifdef LOVE_SIMD_SSE2
+		if (bpp == 4)
+			unfilterPaethSSE2<4>(row, prev, rowbytes);
+		else if (bpp == 3)
+			unfilterPaethSSE2<3>(row, prev, rowbytes);
+		else
+#endif
+		{
+			for (int i = 0; i < bpp; i++)
+				row[i] += prev[i];
+			for (size_t i = bpp; i < rowbytes; i++)
+				row[i] += paethPredictor(row[i - bpp], prev[i], prev[i - bpp]);
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Converts an unfiltered row to RGBA8 or (native-endian) RGBA16.
+static void convertRow(const uint8 *src, uint8 *dst, int width, int colortype, int bitdepth, const uint8 *palette)
+{
+	if (bitdepth == 8)
+	{
+		switch (colortype)
+		{
+		case 6: // RGBA
+			memcpy(dst, src, (size_t) width * 4);
+			break;
+		case 2: // RGB
+			for (int x = 0; x < width; x++, src += 3, dst += 4)
+			{
+				dst[0] = src[0];
+				dst[1] = src[1];
+				dst[2] = src[2];
+				dst[3] = 255;
+			}
+			break;
+		case 0: // Grey
+			for (int x = 0; x < width; x++, src += 1, dst += 4)
+			{
+				dst[0] = dst[1] = dst[2] = src[0];
+				dst[3] = 255;
+			}
+			break;
+		case 4: // Grey + alpha
+			for (int x = 0; x < width; x++, src += 2, dst += 4)
+			{
+				dst[0] = dst[1] = dst[2] = src[0];
+				dst[3] = src[1];
+			}
+			break;
+		case 3: // Palette
+			for (int x = 0; x < width; x++, dst += 4)
+				memcpy(dst, &palette[src[x] * 4], 4);
+			break;
+		}
+		return;
+	}
+
+	uint16 *dst16 = (uint16 *) dst;
+	int channels = colortype == 6 ? 4 : colortype == 2 ? 3 : colortype == 4 ? 2 : 1;
+
+	for (int x = 0; x < width; x++, src += channels * 2, dst16 += 4)
+	{
+		uint16 c[4];
+		for (int i = 0; i < channels; i++)
+			c[i] = (uint16) ((src[i * 2] << 8) | src[i * 2 + 1]);
+
+		switch (colortype)
+		{
+		case 6:
+			memcpy(dst16, c, sizeof(uint16) * 4);
+			break;
+		case 2:
+			dst16[0] = c[0];
+			dst16[1] = c[1];
+			dst16[2] = c[2];
+			dst16[3] = 0xFFFF;
+			break;
+		case 0:
+			dst16[0] = dst16[1] = dst16[2] = c[0];
+			dst16[3] = 0xFFFF;
+			break;
+		case 4:
+			dst16[0] = dst16[1] = dst16[2] = c[0];
+			dst16[3] = c[1];
+			break;
+		}
+	}
+}
+
+struct PNGHeader
+{
+	uint32 width;
+	uint32 height;
+	int bitdepth;
+	int colortype;
+	int bpp;
+	size_t rowbytes;
+};
+
+// Returns false if the image isn't one the fast path handles.
+static bool readHeader(const uint8 *indata, size_t insize, PNGHeader &header)
+{
+	static const uint8 signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+	if (insize < 8 + 25 || memcmp(indata, signature, 8) != 0)
+		return false;
+
+	const uint8 *ihdr = indata + 8;
+	if (readBigEndian32(ihdr) != 13 || memcmp(ihdr + 4, "IHDR", 4) != 0)
+		return false;
+
+	uint32 width = readBigEndian32(ihdr + 8);
+	uint32 height = readBigEndian32(ihdr + 12);
+	int bitdepth = ihdr[16];
+	int colortype = ihdr[17];
+	int interlace = ihdr[20];
+
+	if (width == 0 || height == 0 || width > 0x7FFF || height > 0x7FFF || interlace != 0 || ihdr[18] != 0 || ihdr[19] != 0)
+		return false;
+
+	int channels = 0;
+	switch (colortype)
+	{
+	case 0: channels = 1; break;
+	case 2: channels = 3; break;
+	case 3: channels = 1; break;
+	case 4: channels = 2; break;
+	case 6: channels = 4; break;
+	default: return false;
+	}
+
+	if (!(bitdepth == 8 || (bitdepth == 16 && colortype != 3)))
+		return false;
+
+	header.width = width;
+	header.height = height;
+	header.bitdepth = bitdepth;
+	header.colortype = colortype;
+	header.bpp = channels * bitdepth / 8;
+	header.rowbytes = (size_t) width * header.bpp;
+
+	return true;
+}
+
+/**
+ * Walks the chunks after IHDR, filling in the palette and passing the data of
+ * each IDAT chunk to the given function, which returns false once it doesn't
+ * need any more. Returns false if the file is malformed or uses something the
+ * fast path doesn't handle.
+ **/
+template <typename F>
+static bool readChunks(const uint8 *indata, size_t insize, const PNGHeader &header, uint8 palette[256 * 4], F idat)
+{
+	// Palette entries default to opaque black, like LodePNG.
+	for (int i = 0; i < 256; i++)
+	{
+		palette[i * 4 + 0] = palette[i * 4 + 1] = palette[i * 4 + 2] = 0;
+		palette[i * 4 + 3] = 255;
+	}
+
+	bool haspalette = false;
+	size_t pos = 8 + 25; // After the IHDR chunk.
+
+	while (pos + 12 <= insize)
+	{
+		uint32 length = readBigEndian32(indata + pos);
+		const uint8 *type = indata + pos + 4;
+		const uint8 *chunkdata = indata + pos + 8;
+
+		if (length > insize - pos - 12)
+			return false;
+
+		if (memcmp(type, "IDAT", 4) == 0)
+		{
+			// The palette always comes before the image data.
+			if (header.colortype == 3 && !haspalette)
+				return false;
+
+			if (!idat(chunkdata, length))
+				return true;
+		}
+		else if (memcmp(type, "PLTE", 4) == 0)
+		{
+			if (length % 3 != 0 || length / 3 > 256)
+				return false;
+
+			for (uint32 i = 0; i < length / 3; i++)
+				memcpy(&palette[i * 4], chunkdata + i * 3, 3);
+
+			haspalette = true;
+		}
+		else if (memcmp(type, "tRNS", 4) == 0)
+		{
+			// Color-keyed transparency in non-palette images is rare.
+			if (header.colortype != 3 || length > 256)
+				return false;
+
+			for (uint32 i = 0; i < length; i++)
+				palette[i * 4 + 3] = chunkdata[i];
+		}
+		else if (memcmp(type, "IEND", 4) == 0)
+			break;
+		else if (!(type[0] & 0x20))
+		{
+			// Unknown critical chunk.
+			return false;
+		}
+
+		pos += 12 + length;
+	}
+
+	return true;
+}
+
+// Returns false if the image should be decoded by LodePNG instead.
+static bool decodeFast(const uint8 *indata, size_t insize, FormatHandler::DecodedImage &img)
+{
+	PNGHeader header;
+	if (!readHeader(indata, insize, header))
+		return false;
+
+	uint32 width = header.width;
+	uint32 height = header.height;
+	size_t rowbytes = header.rowbytes;
+	size_t filteredsize = (rowbytes + 1) * height;
+
+	uint8 palette[256 * 4];
+
+	z_stream stream = {};
+	if (inflateInit(&stream) != Z_OK)
+		return false;
+
+	uint8 *filtered = (uint8 *) malloc(filteredsize);
+	if (filtered == nullptr)
+	{
+		inflateEnd(&stream);
+		return false;
+	}
+
+	stream.next_out = filtered;
+	stream.avail_out = (uInt) filteredsize;
+
+	bool ok = true;
+	bool streamended = false;
+
+	// IDAT chunks are fed to zlib directly, without being concatenated first.
+	ok = readChunks(indata, insize, header, palette, [&](const uint8 *chunkdata, uint32 length) -> bool
+	{
+		if (streamended)
+			return true;
+
+		stream.next_in = (Bytef *) chunkdata;
+		stream.avail_in = length;
+
+		int status = inflate(&stream, Z_NO_FLUSH);
+		if (status == Z_STREAM_END)
+			streamended = true;
+		else if (status != Z_OK && !(status == Z_BUF_ERROR && stream.avail_in == 0))
+			ok = false;
+
+		return ok;
+	}) && ok;
+
+	inflateEnd(&stream);
+
+	if (!ok || !streamended || stream.total_out != filteredsize)
+	{
+		free(filtered);
+		return false;
+	}
+
+	size_t outrowbytes = (size_t) width * (header.bitdepth / 8) * 4;
+	uint8 *out = (uint8 *) malloc(outrowbytes * height);
+
+	if (out == nullptr)
+	{
+		free(filtered);
+		throw love::Exception("Out of memory.");
+	}
+
+	std::vector<uint8> zeroes(rowbytes, 0);
+	const uint8 *prev = zeroes.data();
+
+	for (uint32 y = 0; y < height; y++)
+	{
+		uint8 *row = filtered + y * (rowbytes + 1);
+
+		if (!unfilterRow(row[0], row + 1, prev, rowbytes, header.bpp))
+		{
+			free(filtered);
+			free(out);
+			return false;
+		}
+
+		convertRow(row + 1, out + y * outrowbytes, (int) width, header.colortype, header.bitdepth, palette);
+		prev = row + 1;
+	}
+
+	free(filtered);
+
+	img.width = (int) width;
+	img.height = (int) height;
+	img.size = outrowbytes * height;
+	img.format = header.bitdepth == 16 ? PIXELFORMAT_RGBA16 : PIXELFORMAT_RGBA8;
+	img.data = out;
+
+	return true;
+}
+
+/**
+ * Decodes a rectangle of the image while streaming through the compressed
+ * data one row at a time, so only two rows of the full image width are ever
+ * held in memory besides the output. Rows after the rectangle aren't inflated
+ * at all. Returns false if the image should be decoded another way.
+ **/
+static bool decodeRegionFast(const uint8 *indata, size_t insize, int x, int y, int w, int h, FormatHandler::DecodedImage &img)
+{
+	PNGHeader header;
+	if (!readHeader(indata, insize, header))
+		return false;
+
+	if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > (int) header.width || y + h > (int) header.height)
+		throw love::Exception("Invalid region (%d, %d, %d, %d) for a %dx%d PNG image.", x, y, w, h, (int) header.width, (int) header.height);
+
+	size_t rowbytes = header.rowbytes;
+	size_t pixelsize = (header.bitdepth / 8) * 4;
+	size_t outrowbytes = (size_t) w * pixelsize;
+
+	uint8 palette[256 * 4];
+
+	std::vector<uint8> rows[2] = {std::vector<uint8>(rowbytes + 1), std::vector<uint8>(rowbytes + 1)};
+	std::vector<uint8> zeroes(rowbytes, 0);
+	const uint8 *prev = zeroes.data();
+	int current = 0;
+
+	uint8 *out = (uint8 *) malloc(outrowbytes * h);
+	if (out == nullptr)
+		throw love::Exception("Out of memory.");
+
+	z_stream stream = {};
+	if (inflateInit(&stream) != Z_OK)
+	{
+		free(out);
+		return false;
+	}
+
+	stream.next_out = rows[current].data();
+	stream.avail_out = (uInt) (rowbytes + 1);
+
+	int row = 0;
+	int lastrow = y + h;
+	bool ok = true;
+
+	ok = readChunks(indata, insize, header, palette, [&](const uint8 *chunkdata, uint32 length) -> bool
+	{
+		stream.next_in = (Bytef *) chunkdata;
+		stream.avail_in = length;
+
+		while (row < lastrow)
+		{
+			int status = inflate(&stream, Z_NO_FLUSH);
+			if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR)
+			{
+				ok = false;
+				break;
+			}
+
+			if (stream.avail_out == 0)
+			{
+				uint8 *filtered = rows[current].data();
+
+				if (!unfilterRow(filtered[0], filtered + 1, prev, rowbytes, header.bpp))
+				{
+					ok = false;
+					break;
+				}
+
+				if (row >= y)
+				{
+					uint8 *dst = out + (size_t) (row - y) * outrowbytes;
+					convertRow(filtered + 1 + (size_t) x * header.bpp, dst, w, header.colortype, header.bitdepth, palette);
+				}
+
+				prev = filtered + 1;
+				current ^= 1;
+				row++;
+
+				// zlib may still have output pending, so keep going.
+				stream.next_out = rows[current].data();
+				stream.avail_out = (uInt) (rowbytes + 1);
+				continue;
+			}
+
+			// Needs the next chunk (or the data has ended early).
+			if (status == Z_STREAM_END || stream.avail_in == 0)
+				break;
+
+			if (status == Z_BUF_ERROR)
+			{
+				ok = false;
+				break;
+			}
+		}
+
+		return ok && row < lastrow;
+	}) && ok;
+
+	inflateEnd(&stream);
+
+	if (!ok || row < lastrow)
+	{
+		free(out);
+		return false;
+	}
+
+	img.width = w;
+	img.height = h;
+	img.size = outrowbytes * h;
+	img.format = header.bitdepth == 16 ? PIXELFORMAT_RGBA16 : PIXELFORMAT_RGBA8;
+	img.data = out;
+
+	return true;
+}
+
+// Encoding. Rows are filtered independently on worker threads, and the
+// filtered data is then split into chunks which are deflated in parallel.
+// Each chunk is primed with the end of the previous one as its dictionary and
+// ends on a sync flush, so the pieces join into a single zlib stream (the
+// same approach pigz uses).
+
+static inline void writeBigEndian32(uint8 *p, uint32 v)
+{
+	p[0] = (uint8) (v >> 24);
+	p[1] = (uint8) (v >> 16);
+	p[2] = (uint8) (v >> 8);
+	p[3] = (uint8) v;
+}
+
+static size_t writeChunk(uint8 *out, const char *type, const uint8 *data, size_t size)
+{
+	writeBigEndian32(out, (uint32) size);
+	memcpy(out + 4, type, 4);
+	if (size > 0)
+		memcpy(out + 8, data, size);
+
+	uLong crc = crc32(0, out + 4, (uInt) (size + 4));
+	writeBigEndian32(out + 8 + size, (uint32) crc);
+
+	return size + 12;
+}
+
+template <int filter>
+static uint64 applyFilter(const uint8 *row, const uint8 *prev, size_t rowbytes, int bpp, uint8 *out)
+{
+	uint64 sum = 0;
+
+	for (size_t i = 0; i < rowbytes; i++)
+	{
+		int a = i >= (size_t) bpp ? row[i - bpp] : 0;
+		int b = prev[i];
+		int c = i >= (size_t) bpp ? prev[i - bpp] : 0;
+		int x = row[i];
+
+		if (filter == 1)
+			x -= a;
+		else if (filter == 2)
+			x -= b;
+		else if (filter == 3)
+			x -= (a + b) >> 1;
+		else if (filter == 4)
+			x -= paethPredictor(a, b, c);
+
+		out[i] = (uint8) x;
+		sum += (uint64) abs((int) (int8) out[i]);
+	}
+
+	return sum;
+}
+
+// Filters one row with each filter type and keeps the one with the smallest
+// sum of absolute (signed) values, which is the heuristic libpng uses.
+static void filterRow(const uint8 *row, const uint8 *prev, size_t rowbytes, int bpp, uint8 *out, uint8 *scratch, bool tryfilters)
+{
+	out[0] = 0;
+	memcpy(out + 1, row, rowbytes);
+
+	if (!tryfilters)
+		return;
+
+	uint64 bestsum = applyFilter<0>(row, prev, rowbytes, bpp, scratch);
+
+	static uint64 (* const filters[4])(const uint8 *, const uint8 *, size_t, int, uint8 *) =
+	{
+		applyFilter<1>, applyFilter<2>, applyFilter<3>, applyFilter<4>,
+	};
+
+	for (int filter = 1; filter <= 4; filter++)
+	{
+		uint64 sum = filters[filter - 1](row, prev, rowbytes, bpp, scratch);
+
+		if (sum < bestsum)
+		{
+			bestsum = sum;
+			out[0] = (uint8) filter;
+			memcpy(out + 1, scratch, rowbytes);
+		}
+	}
+}
+
+struct DeflatedChunk
+{
+	std::vector<uint8> data;
+	uLong adler;
+	std::string error;
+};
+
+static void deflateChunk(const uint8 *filtered, size_t start, size_t size, bool last, int level, DeflatedChunk &chunk)
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(z_stream));
+
+	if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		chunk.error = "could not initialize zlib";
+		return;
+	}
+
+	size_t dictsize = std::min(start, (size_t) 32768);
+	if (dictsize > 0)
+		deflateSetDictionary(&stream, filtered + start - dictsize, (uInt) dictsize);
+
+	// Room for the sync flush marker on top of the worst case.
+	chunk.data.resize(deflateBound(&stream, (uLong) size) + 16);
+
+	stream.next_in = (Bytef *) (filtered + start);
+	stream.avail_in = (uInt) size;
+	stream.next_out = chunk.data.data();
+	stream.avail_out = (uInt) chunk.data.size();
+
+	int status = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+
+	if ((last && status != Z_STREAM_END) || (!last && (status != Z_OK || stream.avail_in != 0)))
+		chunk.error = "deflate failed";
+
+	chunk.data.resize(stream.total_out);
+	chunk.adler = adler32(1, filtered + start, (uInt) size);
+
+	deflateEnd(&stream);
+}
+
+static FormatHandler::EncodedImage encodeParallel(const FormatHandler::DecodedImage &img, int level)
+{
+	if (level < 0 || level > 9)
+		level = Z_DEFAULT_COMPRESSION;
+
+	int bitdepth = img.format == PIXELFORMAT_RGBA16 ? 16 : 8;
+	int bytespercomponent = bitdepth / 8;
+	size_t srcrowbytes = (size_t) img.width * 4 * bytespercomponent;
+	int height = img.height;
+
+	auto &pool = love::thread::WorkerPool::getInstance();
+
+	// Drop the alpha channel when it's fully opaque, like LodePNG does. It
+	// saves a quarter of the data to filter and compress.
+	bool opaque = true;
+	for (int y = 0; y < height && opaque; y++)
+	{
+		const uint8 *row = img.data + (size_t) y * srcrowbytes;
+		for (int x = 0; x < img.width && opaque; x++)
+		{
+			const uint8 *alpha = row + (x * 4 + 3) * bytespercomponent;
+			opaque = alpha[0] == 0xFF && (bytespercomponent == 1 || alpha[1] == 0xFF);
+		}
+	}
+
+	int channels = opaque ? 3 : 4;
+	int bpp = channels * bytespercomponent;
+	size_t rowbytes = (size_t) img.width * bpp;
+	size_t filteredrow = rowbytes + 1;
+
+	std::vector<uint8> filtered(filteredrow * height);
+
+	// Storing without compression gains nothing from filtering.
+	bool tryfilters = level != 0;
+
+	pool.parallelFor(height, std::max(1, (int) (65536 / filteredrow)), [&](int start, int end)
+	{
+		std::vector<uint8> scratch(rowbytes);
+		std::vector<uint8> rows[2];
+
+		// Converts a row to the PNG's channel layout. 16 bit PNG data is
+		// big-endian.
+		const auto getrow = [&](int y, std::vector<uint8> &buffer) -> const uint8 *
+		{
+			const uint8 *row = img.data + (size_t) y * srcrowbytes;
+
+#ifdef LOVE_BIG_ENDIAN
+			if (!opaque)
+				return row;
+#else
+			if (!opaque && bitdepth == 8)
+				return row;
+#endif
+
+			buffer.resize(rowbytes);
+			uint8 *out = buffer.data();
+
+			for (int x = 0; x < img.width; x++)
+			{
+				const uint8 *in = row + x * 4 * bytespercomponent;
+				for (int c = 0; c < channels; c++)
+				{
+					if (bytespercomponent == 1)
+						*out++ = in[c];
+					else
+					{
+#ifdef LOVE_BIG_ENDIAN
+						*out++ = in[c * 2 + 0];
+						*out++ = in[c * 2 + 1];
+#else
+						*out++ = in[c * 2 + 1];
+						*out++ = in[c * 2 + 0];
+#endif
+					}
+				}
+			}
+
+			return buffer.data();
+		};
+
+		std::vector<uint8> zeros(rowbytes, 0);
+		const uint8 *prev = start > 0 ? getrow(start - 1, rows[1]) : zeros.data();
+
+		for (int y = start; y < end; y++)
+		{
+			const uint8 *row = getrow(y, rows[(y - start) & 1]);
+			filterRow(row, prev, rowbytes, bpp, &filtered[y * filteredrow], scratch.data(), tryfilters);
+			prev = row;
+		}
+	});
+
+	// Chunks should be large enough for deflate to find matches in, but small
+	// enough to spread over every worker.
+	size_t totalsize = filtered.size();
+	size_t chunksize = std::max((size_t) 128 * 1024, totalsize / ((pool.getWorkerCount() + 1) * 4));
+	int chunkcount = (int) ((totalsize + chunksize - 1) / chunksize);
+
+	std::vector<DeflatedChunk> chunks(chunkcount);
+
+	pool.parallelFor(chunkcount, 1, [&](int start, int end)
+	{
+		for (int i = start; i < end; i++)
+		{
+			size_t offset = (size_t) i * chunksize;
+			size_t size = std::min(chunksize, totalsize - offset);
+			deflateChunk(filtered.data(), offset, size, i == chunkcount - 1, level, chunks[i]);
+		}
+	});
+
+	// 2 bytes of zlib header, the deflate data, and the adler32 checksum.
+	size_t zlibsize = 2 + 4;
+	uLong adler = 1;
+
+	for (const DeflatedChunk &chunk : chunks)
+	{
+		if (!chunk.error.empty())
+			throw love::Exception("Could not encode PNG image (%s)", chunk.error.c_str());
+	}
+
+	for (int i = 0; i < chunkcount; i++)
+	{
+		size_t size = std::min(chunksize, totalsize - (size_t) i * chunksize);
+		adler = i == 0 ? chunks[i].adler : adler32_combine(adler, chunks[i].adler, (z_off_t) size);
+		zlibsize += chunks[i].data.size();
+	}
+
+	std::vector<uint8> zlibdata(zlibsize);
+
+	// The header's level hint doesn't affect decoding, but match zlib's.
+	zlibdata[0] = 0x78;
+	if (level == 0 || level == 1)
+		zlibdata[1] = 0x01;
+	else if (level >= 2 && level <= 5)
+		zlibdata[1] = 0x5E;
+	else if (level >= 7)
+		zlibdata[1] = 0xDA;
+	else
+		zlibdata[1] = 0x9C;
+
+	size_t pos = 2;
+	for (const DeflatedChunk &chunk : chunks)
+	{
+		memcpy(&zlibdata[pos], chunk.data.data(), chunk.data.size());
+		pos += chunk.data.size();
+	}
+
+	writeBigEndian32(&zlibdata[pos], (uint32) adler);
+
+	// Keep each IDAT chunk well under the 2^31 byte limit.
+	const size_t maxidat = 1 << 30;
+	size_t idatcount = std::max((zlibsize + maxidat - 1) / maxidat, (size_t) 1);
+
+	FormatHandler::EncodedImage encimg;
+	encimg.size = 8 + (12 + 13) + zlibsize + idatcount * 12 + 12;
+
+	// freeRawPixels uses free().
+	encimg.data = (unsigned char *) malloc(encimg.size);
+	if (encimg.data == nullptr)
+		throw love::Exception("Out of memory.");
+
+	static const uint8 signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	memcpy(encimg.data, signature, 8);
+	pos = 8;
+
+	uint8 ihdr[13];
+	writeBigEndian32(ihdr + 0, (uint32) img.width);
+	writeBigEndian32(ihdr + 4, (uint32) img.height);
+	ihdr[8] = (uint8) bitdepth;
+	ihdr[9] = opaque ? 2 : 6; // RGB or RGBA.
+	ihdr[10] = 0; // Deflate.
+	ihdr[11] = 0; // Adaptive filtering.
+	ihdr[12] = 0; // Not interlaced.
+	pos += writeChunk(encimg.data + pos, "IHDR", ihdr, sizeof(ihdr));
+
+	for (size_t offset = 0; offset < zlibsize; offset += maxidat)
+		pos += writeChunk(encimg.data + pos, "IDAT", &zlibdata[offset], std::min(maxidat, zlibsize - offset));
+
+	pos += writeChunk(encimg.data + pos, "IEND", nullptr, 0);
+
+	encimg.size = pos;
+	return encimg;
+}
+
+std::atomic<bool> PNGHandler::fastDecodeEnabled(true);
+
+void PNGHandler::setFastDecodeEnabled(bool enable)
+{
+	fastDecodeEnabled = enable;
+}
+
+bool PNGHandler::isFastDecodeEnabled()
+{
+	return fastDecodeEnabled;
 }
 
 bool PNGHandler::canDecode(Data *data)
@@ -154,6 +1044,9 @@ PNGHandler::DecodedImage PNGHandler::decode(Data *fdata)
 
 	DecodedImage img;
 
+	if (isFastDecodeEnabled() && decodeFast(indata, insize, img))
+		return img;
+
 	lodepng::State state;
 	unsigned status = lodepng_inspect(&width, &height, &state, indata, insize);
 
@@ -199,62 +1092,44 @@ PNGHandler::DecodedImage PNGHandler::decode(Data *fdata)
 	return img;
 }
 
-FormatHandler::EncodedImage PNGHandler::encode(const DecodedImage &img, EncodedFormat encodedFormat)
+FormatHandler::DecodedImage PNGHandler::decodeRegion(Data *data, int x, int y, int width, int height)
 {
-	if (!canEncode(img.format, encodedFormat))
-		throw love::Exception("PNG encoder cannot encode to non-PNG format.");
-
-	EncodedImage encimg;
-
-	lodepng::State state;
-
-	state.info_raw.colortype = LCT_RGBA;
-	state.info_raw.bitdepth = img.format == PIXELFORMAT_RGBA16 ? 16 : 8;
-
-	state.info_png.color.colortype = LCT_RGBA;
-	state.info_png.color.bitdepth = state.info_raw.bitdepth;
-
-	state.encoder.zlibsettings.custom_zlib = zlibCompress;
+	DecodedImage img;
 
-	const uint8 *data = img.data;
-	uint16 *swappeddata = nullptr;
+	if (decodeRegionFast((const uint8 *) data->getData(), data->getSize(), x, y, width, height, img))
+		return img;
 
-	// LodePNG expects big-endian raw pixel data when encoding a 16 bit image.
-#ifndef LOVE_BIG_ENDIAN
-	if (state.info_raw.bitdepth == 16)
-	{
-		try
-		{
-			swappeddata = new uint16[img.size / sizeof(uint16)];
-		}
-		catch (std::exception &)
-		{
-			throw love::Exception("Out of memory.");
-		}
-
-		const uint16 *rawdata = (const uint16 *) img.data;
-		size_t numpixelcomponents = img.size / sizeof(uint16);
+	return FormatHandler::decodeRegion(data, x, y, width, height);
+}
 
-		for (size_t i = 0; i < numpixelcomponents; i++)
-			swappeddata[i] = swapuint16(rawdata[i]);
+bool PNGHandler::canDecodeRegion(Data *data)
+{
+	// Interlaced images and other layouts the fast path doesn't handle are
+	// decoded whole.
+	PNGHeader header;
+	return readHeader((const uint8 *) data->getData(), data->getSize(), header);
+}
 
-		data = (const uint8 *) swappeddata;
-	}
-#endif
+bool PNGHandler::getDimensions(Data *data, int &width, int &height)
+{
+	unsigned int w = 0, h = 0;
+	lodepng::State state;
+	unsigned status = lodepng_inspect(&w, &h, &state, (const unsigned char *) data->getData(), data->getSize());
 
-	unsigned status = lodepng_encode(&encimg.data, &encimg.size,
-	                                 data, img.width, img.height, &state);
+	if (status != 0)
+		return false;
 
-	if (swappeddata != nullptr)
-		delete[] swappeddata;
+	width = (int) w;
+	height = (int) h;
+	return true;
+}
 
-	if (status != 0)
-	{
-		const char *err = lodepng_error_text(status);
-		throw love::Exception("Could not encode PNG image (%s)", err);
-	}
+FormatHandler::EncodedImage PNGHandler::encode(const DecodedImage &img, EncodedFormat encodedFormat, int compressionLevel)
+{
+	if (!canEncode(img.format, encodedFormat))
+		throw love::Exception("PNG encoder cannot encode to non-PNG format.");
 
-	return encimg;
+	return encodeParallel(img, compressionLevel);
 }
 
 void PNGHandler::freeRawPixels(unsigned char *mem)
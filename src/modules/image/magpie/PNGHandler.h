@@ -23,6 +23,9 @@
 // LOVE
 #include "image/FormatHandler.h"
 
+// C++
+#include <atomic>
+
 namespace love
 {
 namespace image
@@ -43,10 +46,24 @@ class PNGHandler : public FormatHandler
 	virtual bool canEncode(PixelFormat rawFormat, EncodedFormat encodedFormat);
 
 	virtual DecodedImage decode(Data *data);
-	virtual EncodedImage encode(const DecodedImage &img, EncodedFormat format);
+	virtual DecodedImage decodeRegion(Data *data, int x, int y, int width, int height);
+	virtual bool canDecodeRegion(Data *data);
+	virtual bool getDimensions(Data *data, int &width, int &height);
+	virtual EncodedImage encode(const DecodedImage &img, EncodedFormat format, int compressionLevel);
 
 	virtual void freeRawPixels(unsigned char *mem);
 
+	/**
+	 * Whether decode() tries the built-in fast path before LodePNG. On by
+	 * default; turning it off is mostly useful for comparing the two.
+	 **/
+	static void setFastDecodeEnabled(bool enable);
+	static bool isFastDecodeEnabled();
+
+private:
+
+	static std::atomic<bool> fastDecodeEnabled;
+
 }; // PNGHandler
 
 } // magpie
@@ -0,0 +1,357 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "QOIHandler.h"
+#include "common/Exception.h"
+
+// C
+#include <cstdlib>
+#include <cstring>
+
+namespace love
+{
+namespace image
+{
+namespace magpie
+{
+
+enum QOIOp
+{
+	QOI_OP_INDEX = 0x00,
+	QOI_OP_DIFF  = 0x40,
+	QOI_OP_LUMA  = 0x80,
+	QOI_OP_RUN   = 0xC0,
+	QOI_OP_RGB   = 0xFE,
+	QOI_OP_RGBA  = 0xFF,
+};
+
+static const uint8 QOI_MASK_2 = 0xC0;
+static const size_t QOI_HEADER_SIZE = 14;
+static const uint8 qoiPadding[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+// Same limit as the reference implementation, to guard against headers which
+// would need absurd amounts of memory.
+static const uint64 QOI_PIXELS_MAX = 400000000;
+
+struct QOIPixel
+{
+	uint8 r, g, b, a;
+
+	bool operator == (const QOIPixel &o) const
+	{
+		return r == o.r && g == o.g && b == o.b && a == o.a;
+	}
+};
+
+static inline int qoiHash(const QOIPixel &p)
+{
+	return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+}
+
+static inline uint32 readBE32(const uint8 *p)
+{
+	return ((uint32) p[0] << 24) | ((uint32) p[1] << 16) | ((uint32) p[2] << 8) | (uint32) p[3];
+}
+
+static inline void writeBE32(uint8 *p, uint32 v)
+{
+	p[0] = (uint8) (v >> 24);
+	p[1] = (uint8) (v >> 16);
+	p[2] = (uint8) (v >> 8);
+	p[3] = (uint8) v;
+}
+
+bool QOIHandler::canDecode(Data *data)
+{
+	if (data->getSize() < QOI_HEADER_SIZE + sizeof(qoiPadding))
+		return false;
+
+	const uint8 *bytes = (const uint8 *) data->getData();
+
+	uint32 w = readBE32(bytes + 4);
+	uint32 h = readBE32(bytes + 8);
+	uint8 channels = bytes[12];
+
+	return memcmp(bytes, "qoif", 4) == 0 && w > 0 && h > 0
+		&& (channels == 3 || channels == 4);
+}
+
+bool QOIHandler::canEncode(PixelFormat rawFormat, EncodedFormat encodedFormat)
+{
+	return encodedFormat == ENCODED_QOI && rawFormat == PIXELFORMAT_RGBA8;
+}
+
+FormatHandler::DecodedImage QOIHandler::decode(Data *data)
+{
+	int width = 0;
+	int height = 0;
+
+	if (!getDimensions(data, width, height))
+		throw love::Exception("Could not decode QOI image: invalid header.");
+
+	return decodeRegion(data, 0, 0, width, height);
+}
+
+// The stream can only be read from the start, but pixels outside the region
+// are skipped rather than stored, and decoding stops after its last row.
+FormatHandler::DecodedImage QOIHandler::decodeRegion(Data *data, int x, int y, int width, int height)
+{
+	if (!canDecode(data))
+		throw love::Exception("Could not decode QOI image: invalid header.");
+
+	const uint8 *bytes = (const uint8 *) data->getData();
+	size_t size = data->getSize();
+
+	uint32 w = readBE32(bytes + 4);
+	uint32 h = readBE32(bytes + 8);
+
+	if ((uint64) w * h > QOI_PIXELS_MAX)
+		throw love::Exception("Could not decode QOI image: dimensions are too large.");
+
+	if (x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > (int) w || y + height > (int) h)
+		throw love::Exception("Invalid region (%d, %d, %d, %d) for a %dx%d QOI image.", x, y, width, height, (int) w, (int) h);
+
+	DecodedImage img;
+	img.width = width;
+	img.height = height;
+	img.format = PIXELFORMAT_RGBA8;
+	img.size = (size_t) width * height * 4;
+	img.data = (unsigned char *) malloc(img.size);
+
+	if (img.data == nullptr)
+		throw love::Exception("Out of memory.");
+
+	QOIPixel index[64];
+	memset(index, 0, sizeof(index));
+
+	QOIPixel px = {0, 0, 0, 255};
+
+	size_t p = QOI_HEADER_SIZE;
+	size_t end = size - sizeof(qoiPadding);
+	int run = 0;
+
+	size_t pixelcount = (size_t) (y + height) * w;
+	int col = 0;
+	int row = 0;
+
+	for (size_t i = 0; i < pixelcount; i++)
+	{
+		if (run > 0)
+			run--;
+		else if (p < end)
+		{
+			uint8 b1 = bytes[p++];
+
+			if (b1 == QOI_OP_RGB)
+			{
+				if (p + 3 > end)
+				{
+					free(img.data);
+					throw love::Exception("Could not decode QOI image: truncated data.");
+				}
+				px.r = bytes[p++];
+				px.g = bytes[p++];
+				px.b = bytes[p++];
+			}
+			else if (b1 == QOI_OP_RGBA)
+			{
+				if (p + 4 > end)
+				{
+					free(img.data);
+					throw love::Exception("Could not decode QOI image: truncated data.");
+				}
+				px.r = bytes[p++];
+				px.g = bytes[p++];
+				px.b = bytes[p++];
+				px.a = bytes[p++];
+			}
+			else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX)
+				px = index[b1];
+			else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF)
+			{
+				px.r += ((b1 >> 4) & 0x03) - 2;
+				px.g += ((b1 >> 2) & 0x03) - 2;
+				px.b += (b1 & 0x03) - 2;
+			}
+			else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA)
+			{
+				if (p + 1 > end)
+				{
+					free(img.data);
+					throw love::Exception("Could not decode QOI image: truncated data.");
+				}
+				uint8 b2 = bytes[p++];
+				int vg = (b1 & 0x3F) - 32;
+				px.r += vg - 8 + ((b2 >> 4) & 0x0F);
+				px.g += vg;
+				px.b += vg - 8 + (b2 & 0x0F);
+			}
+			else // QOI_OP_RUN
+				run = b1 & 0x3F;
+
+			index[qoiHash(px)] = px;
+		}
+
+		if (row >= y && col >= x && col < x + width)
+			memcpy(img.data + ((size_t) (row - y) * width + (col - x)) * 4, &px, 4);
+
+		if (++col == (int) w)
+		{
+			col = 0;
+			row++;
+		}
+	}
+
+	return img;
+}
+
+bool QOIHandler::canDecodeRegion(Data* /*data*/)
+{
+	return true;
+}
+
+bool QOIHandler::getDimensions(Data *data, int &width, int &height)
+{
+	if (!canDecode(data))
+		return false;
+
+	const uint8 *bytes = (const uint8 *) data->getData();
+	width = (int) readBE32(bytes + 4);
+	height = (int) readBE32(bytes + 8);
+	return true;
+}
+
+FormatHandler::EncodedImage QOIHandler::encode(const DecodedImage &img, EncodedFormat encodedFormat, int /*compressionLevel*/)
+{
+	if (!canEncode(img.format, encodedFormat))
+		throw love::Exception("QOI encoder cannot encode to non-QOI format.");
+
+	size_t pixelcount = (size_t) img.width * img.height;
+
+	// Worst case is an RGBA op for every pixel.
+	size_t maxsize = QOI_HEADER_SIZE + pixelcount * 5 + sizeof(qoiPadding);
+
+	EncodedImage encimg;
+	encimg.data = (unsigned char *) malloc(maxsize);
+
+	if (encimg.data == nullptr)
+		throw love::Exception("Out of memory.");
+
+	uint8 *out = encimg.data;
+	size_t p = 0;
+
+	memcpy(out, "qoif", 4);
+	writeBE32(out + 4, (uint32) img.width);
+	writeBE32(out + 8, (uint32) img.height);
+	out[12] = 4; // RGBA.
+	out[13] = 0; // sRGB with linear alpha.
+	p = QOI_HEADER_SIZE;
+
+	QOIPixel index[64];
+	memset(index, 0, sizeof(index));
+
+	QOIPixel prev = {0, 0, 0, 255};
+	int run = 0;
+
+	const QOIPixel *pixels = (const QOIPixel *) img.data;
+
+	for (size_t i = 0; i < pixelcount; i++)
+	{
+		QOIPixel px = pixels[i];
+
+		if (px == prev)
+		{
+			run++;
+			if (run == 62 || i == pixelcount - 1)
+			{
+				out[p++] = (uint8) (QOI_OP_RUN | (run - 1));
+				run = 0;
+			}
+			continue;
+		}
+
+		if (run > 0)
+		{
+			out[p++] = (uint8) (QOI_OP_RUN | (run - 1));
+			run = 0;
+		}
+
+		int hash = qoiHash(px);
+
+		if (index[hash] == px)
+			out[p++] = (uint8) (QOI_OP_INDEX | hash);
+		else
+		{
+			index[hash] = px;
+
+			if (px.a == prev.a)
+			{
+				int8 vr = (int8) (px.r - prev.r);
+				int8 vg = (int8) (px.g - prev.g);
+				int8 vb = (int8) (px.b - prev.b);
+
+				int8 vgr = (int8) (vr - vg);
+				int8 vgb = (int8) (vb - vg);
+
+				if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+					out[p++] = (uint8) (QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+				else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8)
+				{
+					out[p++] = (uint8) (QOI_OP_LUMA | (vg + 32));
+					out[p++] = (uint8) ((vgr + 8) << 4 | (vgb + 8));
+				}
+				else
+				{
+					out[p++] = QOI_OP_RGB;
+					out[p++] = px.r;
+					out[p++] = px.g;
+					out[p++] = px.b;
+				}
+			}
+			else
+			{
+				out[p++] = QOI_OP_RGBA;
+				out[p++] = px.r;
+				out[p++] = px.g;
+				out[p++] = px.b;
+				out[p++] = px.a;
+			}
+		}
+
+		prev = px;
+	}
+
+	memcpy(out + p, qoiPadding, sizeof(qoiPadding));
+	p += sizeof(qoiPadding);
+
+	encimg.size = p;
+	return encimg;
+}
+
+void QOIHandler::freeRawPixels(unsigned char *mem)
+{
+	if (mem)
+		::free(mem);
+}
+
+} // magpie
+} // image
+} // love
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+#include "image/FormatHandler.h"
+
+namespace love
+{
+namespace image
+{
+namespace magpie
+{
+
+/**
+ * Decodes and encodes QOI, the "Quite OK Image" format. It's a simple
+ * lossless format which encodes and decodes many times faster than PNG, at a
+ * somewhat larger file size. https://qoiformat.org/
+ **/
+class QOIHandler final : public FormatHandler
+{
+public:
+
+	// Implements FormatHandler.
+
+	bool canDecode(Data *data) override;
+	bool canEncode(PixelFormat rawFormat, EncodedFormat encodedFormat) override;
+
+	DecodedImage decode(Data *data) override;
+	DecodedImage decodeRegion(Data *data, int x, int y, int width, int height) override;
+	bool canDecodeRegion(Data *data) override;
+	bool getDimensions(Data *data, int &width, int &height) override;
+	EncodedImage encode(const DecodedImage &img, EncodedFormat format, int compressionLevel) override;
+
+	void freeRawPixels(unsigned char *mem) override;
+
+}; // QOIHandler
+
+} // magpie
+} // image
+} // love
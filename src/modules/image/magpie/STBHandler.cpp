@@ -107,7 +107,13 @@ FormatHandler::DecodedImage STBHandler::decode(Data *data)
 	return img;
 }
 
-FormatHandler::EncodedImage STBHandler::encode(const DecodedImage &img, EncodedFormat encodedFormat)
+bool STBHandler::getDimensions(Data *data, int &width, int &height)
+{
+	int comp = 0;
+	return stbi_info_from_memory((const stbi_uc *) data->getData(), (int) data->getSize(), &width, &height, &comp) == 1;
+}
+
+FormatHandler::EncodedImage STBHandler::encode(const DecodedImage &img, EncodedFormat encodedFormat, int /*compressionLevel*/)
 {
 	if (!canEncode(img.format, encodedFormat))
 		throw love::Exception("Invalid format.");
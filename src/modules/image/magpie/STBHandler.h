@@ -46,7 +46,8 @@ class STBHandler final : public FormatHandler
 	bool canEncode(PixelFormat rawFormat, EncodedFormat encodedFormat) override;
 
 	DecodedImage decode(Data *data) override;
-	EncodedImage encode(const DecodedImage &img, EncodedFormat format) override;
+	bool getDimensions(Data *data, int &width, int &height) override;
+	EncodedImage encode(const DecodedImage &img, EncodedFormat format, int compressionLevel) override;
 
 	void freeRawPixels(unsigned char *mem) override;
 
@@ -24,6 +24,8 @@
 #include "common/StringMap.h"
 
 #include "Image.h"
+#include "wrap_ImageDecodeBatch.h"
+#include "magpie/PNGHandler.h"
 
 #include "filesystem/wrap_Filesystem.h"
 
@@ -103,8 +105,133 @@ int w_newImageData(lua_State *L)
 	}
 }
 
+int w_newImageDataRegion(lua_State *L)
+{
+	Rect region;
+	region.x = (int) luaL_checkinteger(L, 2);
+	region.y = (int) luaL_checkinteger(L, 3);
+	region.w = (int) luaL_checkinteger(L, 4);
+	region.h = (int) luaL_checkinteger(L, 5);
+
+	Data *data = love::filesystem::luax_getdata(L, 1);
+
+	ImageData *t = nullptr;
+	luax_catchexcept(L,
+		[&]() { t = instance()->newImageData(data, region); },
+		[&](bool) { data->release(); }
+	);
+
+	luax_pushtype(L, t);
+	t->release();
+	return 1;
+}
+
+int w_getImageDimensions(lua_State *L)
+{
+	Data *data = love::filesystem::luax_getdata(L, 1);
+
+	int w = 0;
+	int h = 0;
+	luax_catchexcept(L,
+		[&]() { instance()->getDimensions(data, w, h); },
+		[&](bool) { data->release(); }
+	);
+
+	lua_pushinteger(L, w);
+	lua_pushinteger(L, h);
+	return 2;
+}
+
+// The collected Data objects are owned by a table left on top of the stack
+// rather than by the caller, so a Lua error raised partway through the list
+// (e.g. by a missing file) leaves them to the garbage collector.
+static void luax_checkimagesources(lua_State *L, int idx, std::vector<Data *> &datas)
+{
+	luaL_checktype(L, idx, LUA_TTABLE);
+
+	int count = (int) luax_objlen(L, idx);
+	lua_createtable(L, count, 0);
+
+	for (int i = 1; i <= count; i++)
+	{
+		lua_rawgeti(L, idx, i);
+		if (!filesystem::luax_cangetdata(L, -1))
+			luaL_error(L, "Expected filename, File, or Data at index %d of the image list.", i);
+
+		Data *data = filesystem::luax_getdata(L, -1);
+		lua_pop(L, 1);
+
+		luax_pushtype(L, data);
+		data->release();
+		lua_rawseti(L, -2, i);
+
+		datas.push_back(data);
+	}
+}
+
+int w_newImageDataBatch(lua_State *L)
+{
+	std::vector<Data *> datas;
+	luax_checkimagesources(L, 1, datas);
+
+	ImageDecodeBatch *t = nullptr;
+	luax_catchexcept(L, [&]() { t = instance()->newImageDataBatch(datas); });
+
+	luax_pushtype(L, t);
+	t->release();
+	return 1;
+}
+
+int w_newImageDatas(lua_State *L)
+{
+	std::vector<Data *> datas;
+	luax_checkimagesources(L, 1, datas);
+
+	ImageDecodeBatch *batch = nullptr;
+	luax_catchexcept(L, [&]() { batch = instance()->newImageDataBatch(datas); });
+
+	lua_createtable(L, batch->getCount(), 0);
+
+	for (int i = 0; i < batch->getCount(); i++)
+	{
+		std::string err;
+		ImageData *t = batch->getImageData(i, err);
+
+		if (t == nullptr)
+		{
+			batch->release();
+			return luaL_error(L, "%s", err.c_str());
+		}
+
+		luax_pushtype(L, t);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	batch->release();
+	return 1;
+}
+
 int w_newCompressedData(lua_State *L)
 {
+	if (luax_istype(L, 1, ImageData::type))
+	{
+		ImageData *imagedata = luax_checkimagedata(L, 1);
+
+		PixelFormat format = PIXELFORMAT_UNKNOWN;
+		const char *fstr = luaL_checkstring(L, 2);
+		if (!getConstant(fstr, format))
+			return luax_enumerror(L, "pixel format", fstr);
+
+		bool mipmaps = luax_optboolean(L, 3, false);
+
+		CompressedImageData *t = nullptr;
+		luax_catchexcept(L, [&]() { t = instance()->newCompressedData(imagedata, format, mipmaps); });
+
+		luax_pushtype(L, CompressedImageData::type, t);
+		t->release();
+		return 1;
+	}
+
 	Data *data = love::filesystem::luax_getdata(L, 1);
 
 	CompressedImageData *t = nullptr;
@@ -139,12 +266,24 @@ int w_newCubeFaces(lua_State *L)
 }
 
 // List of functions to wrap.
+// Used by testing/benchmarks/png to compare the PNG decoders.
+int w__setFastPNGDecode(lua_State *L)
+{
+	magpie::PNGHandler::setFastDecodeEnabled(luax_checkboolean(L, 1));
+	return 0;
+}
+
 static const luaL_Reg functions[] =
 {
 	{ "newImageData",  w_newImageData },
+	{ "newImageDataRegion", w_newImageDataRegion },
+	{ "getImageDimensions", w_getImageDimensions },
+	{ "newImageDataBatch", w_newImageDataBatch },
+	{ "newImageDatas", w_newImageDatas },
 	{ "newCompressedData", w_newCompressedData },
 	{ "isCompressed", w_isCompressed },
 	{ "newCubeFaces", w_newCubeFaces },
+	{ "_setFastPNGDecode", w__setFastPNGDecode },
 	{ 0, 0 }
 };
 
@@ -152,6 +291,7 @@ static const lua_CFunction types[] =
 {
 	luaopen_imagedata,
 	luaopen_compressedimagedata,
+	luaopen_imagedecodebatch,
 	0
 };
 
@@ -23,6 +23,12 @@
 #include "data/wrap_Data.h"
 #include "filesystem/File.h"
 #include "filesystem/Filesystem.h"
+#include "thread/wrap_Channel.h"
+
+// C++
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 // Shove the wrap_ImageData.lua code directly into a raw string literal.
 static const char imagedata_lua[] =
@@ -144,6 +150,176 @@ int w_ImageData_setPixel(lua_State *L)
 	return 0;
 }
 
+// Reads the x, y, width and height at idx, defaulting to the whole ImageData.
+static Rect luax_optregion(lua_State *L, int idx, ImageData *t)
+{
+	Rect r = {0, 0, t->getWidth(), t->getHeight()};
+
+	if (!lua_isnoneornil(L, idx))
+	{
+		r.x = (int) luaL_checkinteger(L, idx + 0);
+		r.y = (int) luaL_checkinteger(L, idx + 1);
+		r.w = (int) luaL_checkinteger(L, idx + 2);
+		r.h = (int) luaL_checkinteger(L, idx + 3);
+	}
+
+	return r;
+}
+
+// Reads the x, y, width and height at idx. They're checked against the
+// ImageData before anything is sized from them, with 64 bit math so huge
+// values can't wrap around.
+static Rect luax_checkpixelrect(lua_State *L, int idx, ImageData *t)
+{
+	int64 x = (int64) luaL_checkinteger(L, idx + 0);
+	int64 y = (int64) luaL_checkinteger(L, idx + 1);
+	int64 w = (int64) luaL_checkinteger(L, idx + 2);
+	int64 h = (int64) luaL_checkinteger(L, idx + 3);
+
+	if (x < 0 || y < 0 || w < 0 || h < 0 || x + w > t->getWidth() || y + h > t->getHeight())
+	{
+		luaL_error(L, "Invalid rectangle (x=%d, y=%d, w=%d, h=%d) for %dx%d ImageData.",
+			(int) x, (int) y, (int) w, (int) h, t->getWidth(), t->getHeight());
+	}
+
+	Rect r = {(int) x, (int) y, (int) w, (int) h};
+	return r;
+}
+
+// Table conversions go through a bounded buffer a few rows at a time, so a
+// huge rectangle doesn't need a huge temporary copy.
+static int getRowsPerChunk(const Rect &r)
+{
+	return std::max(1, (64 * 1024) / std::max(r.w, 1));
+}
+
+static void checkRawSize(lua_State *L, ImageData *t, const Rect &r, love::Data *data, lua_Integer offset)
+{
+	size_t size = (size_t) r.w * r.h * t->getPixelSize();
+	if (offset < 0 || (size_t) offset + size > data->getSize())
+		luaL_error(L, "The Data is too small for a %dx%d rectangle of pixels at byte offset %d.", r.w, r.h, (int) offset);
+}
+
+int w_ImageData_getPixels(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+
+	Rect r = luax_checkpixelrect(L, 2, t);
+
+	if (luax_istype(L, 6, love::Data::type))
+	{
+		love::Data *data = luax_checktype<love::Data>(L, 6);
+		lua_Integer offset = luaL_optinteger(L, 7, 0);
+
+		checkRawSize(L, t, r, data, offset);
+		luax_catchexcept(L, [&](){ t->getRawPixels(r, (uint8 *) data->getData() + offset); });
+
+		lua_pushvalue(L, 6);
+		return 1;
+	}
+
+	int64 count = (int64) r.w * r.h * 4;
+	if (count > std::numeric_limits<int>::max())
+		return luaL_error(L, "Too many pixels (%dx%d) to fit in a table.", r.w, r.h);
+
+	// An existing table can be reused, to avoid creating garbage.
+	if (lua_istable(L, 6))
+		lua_pushvalue(L, 6);
+	else
+		lua_createtable(L, (int) count, 0);
+
+	int chunkrows = getRowsPerChunk(r);
+	std::vector<float> values((size_t) std::min(chunkrows, std::max(r.h, 1)) * r.w * 4);
+
+	int index = 1;
+
+	for (int y = 0; y < r.h; y += chunkrows)
+	{
+		Rect chunk = {r.x, r.y + y, r.w, std::min(chunkrows, r.h - y)};
+		luax_catchexcept(L, [&](){ t->getPixels(chunk, values.data()); });
+
+		int chunkcount = chunk.w * chunk.h * 4;
+		for (int i = 0; i < chunkcount; i++)
+		{
+			lua_pushnumber(L, values[i]);
+			lua_rawseti(L, -2, index++);
+		}
+	}
+
+	return 1;
+}
+
+int w_ImageData_setPixels(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+
+	Rect r = luax_checkpixelrect(L, 2, t);
+
+	if (luax_istype(L, 6, love::Data::type))
+	{
+		love::Data *data = luax_checktype<love::Data>(L, 6);
+		lua_Integer offset = luaL_optinteger(L, 7, 0);
+
+		checkRawSize(L, t, r, data, offset);
+		luax_catchexcept(L, [&](){ t->setRawPixels(r, (const uint8 *) data->getData() + offset); });
+		return 0;
+	}
+
+	luaL_checktype(L, 6, LUA_TTABLE);
+
+	int64 count = (int64) r.w * r.h * 4;
+	if ((int64) luax_objlen(L, 6) < count)
+		return luaL_error(L, "Expected %d values in the table (4 per pixel), got %d.", (int) std::min<int64>(count, std::numeric_limits<int>::max()), (int) luax_objlen(L, 6));
+
+	int chunkrows = getRowsPerChunk(r);
+	std::vector<float> values((size_t) std::min(chunkrows, std::max(r.h, 1)) * r.w * 4);
+
+	int index = 1;
+
+	for (int y = 0; y < r.h; y += chunkrows)
+	{
+		Rect chunk = {r.x, r.y + y, r.w, std::min(chunkrows, r.h - y)};
+
+		int chunkcount = chunk.w * chunk.h * 4;
+		for (int i = 0; i < chunkcount; i++)
+		{
+			lua_rawgeti(L, 6, index);
+			if (!lua_isnumber(L, -1))
+				return luaL_error(L, "Expected a number at index %d of the pixel table.", index);
+			values[i] = (float) lua_tonumber(L, -1);
+			lua_pop(L, 1);
+			index++;
+		}
+
+		luax_catchexcept(L, [&](){ t->setPixels(chunk, values.data()); });
+	}
+
+	return 0;
+}
+
+int w_ImageData_fill(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+
+	Colorf c;
+	c.r = (float) luaL_checknumber(L, 2);
+	c.g = (float) luaL_optnumber(L, 3, 0.0);
+	c.b = (float) luaL_optnumber(L, 4, 0.0);
+	c.a = (float) luaL_optnumber(L, 5, 1.0);
+
+	Rect r = luax_optregion(L, 6, t);
+	luax_catchexcept(L, [&](){ t->fill(r, c); });
+	return 0;
+}
+
+int w_ImageData_clear(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	Rect r = luax_optregion(L, 2, t);
+	luax_catchexcept(L, [&](){ t->clear(r); });
+	return 0;
+}
+
 // ImageData:mapPixel. Not thread-safe! See wrap_ImageData.lua for the thread-
 // safe wrapper function.
 int w_ImageData__mapPixelUnsafe(lua_State *L)
@@ -219,7 +395,16 @@ int w_ImageData_paste(lua_State *L)
 	int sy = (int) luaL_optinteger(L, 6, 0);
 	int sw = (int) luaL_optinteger(L, 7, src->getWidth());
 	int sh = (int) luaL_optinteger(L, 8, src->getHeight());
-	t->paste((love::image::ImageData *)src, dx, dy, sx, sy, sw, sh);
+
+	ImageData::BlendMode blend = ImageData::BLEND_REPLACE;
+	if (!lua_isnoneornil(L, 9))
+	{
+		const char *str = luaL_checkstring(L, 9);
+		if (!ImageData::getConstant(str, blend))
+			return luax_enumerror(L, "paste blend mode", ImageData::getConstants(blend), str);
+	}
+
+	luax_catchexcept(L, [&](){ t->paste((love::image::ImageData *)src, dx, dy, sx, sy, sw, sh, blend); });
 	return 0;
 }
 
@@ -241,8 +426,10 @@ int w_ImageData_encode(lua_State *L)
 		filename = luax_checkstring(L, 3);
 	}
 
+	int level = (int) luaL_optinteger(L, 4, -1);
+
 	love::filesystem::FileData *filedata = nullptr;
-	luax_catchexcept(L, [&](){ filedata = t->encode(format, filename.c_str(), hasfilename); });
+	luax_catchexcept(L, [&](){ filedata = t->encode(format, filename.c_str(), hasfilename, level); });
 
 	luax_pushtype(L, filedata);
 	filedata->release();
@@ -250,6 +437,141 @@ int w_ImageData_encode(lua_State *L)
 	return 1;
 }
 
+int w_ImageData_encodeAsync(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	love::thread::Channel *channel = love::thread::luax_checkchannel(L, 2);
+
+	FormatHandler::EncodedFormat format;
+	const char *fmt = luaL_checkstring(L, 3);
+	if (!ImageData::getConstant(fmt, format))
+		return luax_enumerror(L, "encoded image format", ImageData::getConstants(format), fmt);
+
+	int level = (int) luaL_optinteger(L, 4, -1);
+	std::string filename = "Image." + std::string(fmt);
+
+	luax_catchexcept(L, [&](){ t->encodeAsync(format, filename.c_str(), level, channel); });
+	return 0;
+}
+
+int w_ImageData_resize(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	int w = (int) luaL_checkinteger(L, 2);
+	int h = (int) luaL_checkinteger(L, 3);
+
+	ImageData::ResizeFilter filter = ImageData::RESIZE_BILINEAR;
+	if (!lua_isnoneornil(L, 4))
+	{
+		const char *str = luaL_checkstring(L, 4);
+		if (!ImageData::getConstant(str, filter))
+			return luax_enumerror(L, "resize filter", ImageData::getConstants(filter), str);
+	}
+
+	ImageData *c = nullptr;
+	luax_catchexcept(L, [&](){ c = t->resize(w, h, filter); });
+	luax_pushtype(L, c);
+	c->release();
+	return 1;
+}
+
+int w_ImageData_generateMipmaps(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+
+	// Only 8 bit color formats are normally sRGB-encoded. 16 bit and float
+	// formats hold linear data, and R8/RG8 usually aren't colors at all.
+	PixelFormat format = t->getFormat();
+	bool srgb = format == PIXELFORMAT_RGBA8 || format == PIXELFORMAT_sRGBA8 || format == PIXELFORMAT_LA8;
+
+	bool gammacorrect = luax_optboolean(L, 2, srgb);
+
+	std::vector<StrongRef<ImageData>> mipmaps;
+	luax_catchexcept(L, [&](){ t->generateMipmaps(gammacorrect, mipmaps); });
+
+	// The base level is included, so the table can be given straight to
+	// love.graphics.newImage.
+	lua_createtable(L, (int) mipmaps.size() + 1, 0);
+
+	luax_pushtype(L, t);
+	lua_rawseti(L, -2, 1);
+
+	for (size_t i = 0; i < mipmaps.size(); i++)
+	{
+		luax_pushtype(L, mipmaps[i].get());
+		lua_rawseti(L, -2, (int) i + 2);
+	}
+
+	return 1;
+}
+
+int w_ImageData_blur(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	float sigma = (float) luaL_checknumber(L, 2);
+	luax_catchexcept(L, [&](){ t->blur(sigma); });
+	return 0;
+}
+
+int w_ImageData_premultiply(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	luax_catchexcept(L, [&](){ t->premultiply(); });
+	return 0;
+}
+
+int w_ImageData_unpremultiply(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	luax_catchexcept(L, [&](){ t->unpremultiply(); });
+	return 0;
+}
+
+int w_ImageData_convert(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+
+	PixelFormat format = PIXELFORMAT_UNKNOWN;
+	const char *fstr = luaL_checkstring(L, 2);
+	if (!getConstant(fstr, format))
+		return luax_enumerror(L, "pixel format", fstr);
+
+	ImageData *c = nullptr;
+	luax_catchexcept(L, [&](){ c = t->convert(format); });
+	luax_pushtype(L, c);
+	c->release();
+	return 1;
+}
+
+int w_ImageData_swizzle(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+
+	size_t len = 0;
+	const char *str = luaL_checklstring(L, 2, &len);
+	if (len != 4)
+		return luaL_error(L, "Invalid swizzle '%s': expected 4 components.", str);
+
+	ImageData::SwizzleSource sources[4];
+	for (int i = 0; i < 4; i++)
+	{
+		switch (str[i])
+		{
+		case 'r': sources[i] = ImageData::SWIZZLE_R; break;
+		case 'g': sources[i] = ImageData::SWIZZLE_G; break;
+		case 'b': sources[i] = ImageData::SWIZZLE_B; break;
+		case 'a': sources[i] = ImageData::SWIZZLE_A; break;
+		case '0': sources[i] = ImageData::SWIZZLE_ZERO; break;
+		case '1': sources[i] = ImageData::SWIZZLE_ONE; break;
+		default:
+			return luaL_error(L, "Invalid swizzle component '%c' (expected one of r, g, b, a, 0, 1).", str[i]);
+		}
+	}
+
+	luax_catchexcept(L, [&](){ t->swizzle(sources); });
+	return 0;
+}
+
 int w_ImageData__performAtomic(lua_State *L)
 {
 	ImageData *t = luax_checkimagedata(L, 1);
@@ -319,8 +641,20 @@ static const luaL_Reg w_ImageData_functions[] =
 	{ "getDimensions", w_ImageData_getDimensions },
 	{ "getPixel", w_ImageData_getPixel },
 	{ "setPixel", w_ImageData_setPixel },
+	{ "getPixels", w_ImageData_getPixels },
+	{ "setPixels", w_ImageData_setPixels },
+	{ "fill", w_ImageData_fill },
+	{ "clear", w_ImageData_clear },
 	{ "paste", w_ImageData_paste },
 	{ "encode", w_ImageData_encode },
+	{ "encodeAsync", w_ImageData_encodeAsync },
+	{ "resize", w_ImageData_resize },
+	{ "generateMipmaps", w_ImageData_generateMipmaps },
+	{ "blur", w_ImageData_blur },
+	{ "premultiply", w_ImageData_premultiply },
+	{ "unpremultiply", w_ImageData_unpremultiply },
+	{ "convert", w_ImageData_convert },
+	{ "swizzle", w_ImageData_swizzle },
 
 	// Used in the Lua wrapper code.
 	{ "_mapPixelUnsafe", w_ImageData__mapPixelUnsafe },
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "wrap_ImageDecodeBatch.h"
+
+namespace love
+{
+namespace image
+{
+
+ImageDecodeBatch *luax_checkimagedecodebatch(lua_State *L, int idx)
+{
+	return luax_checktype<ImageDecodeBatch>(L, idx);
+}
+
+int w_ImageDecodeBatch_getCount(lua_State *L)
+{
+	ImageDecodeBatch *t = luax_checkimagedecodebatch(L, 1);
+	lua_pushinteger(L, t->getCount());
+	return 1;
+}
+
+int w_ImageDecodeBatch_getProgress(lua_State *L)
+{
+	ImageDecodeBatch *t = luax_checkimagedecodebatch(L, 1);
+	lua_pushinteger(L, t->getDecodedCount());
+	lua_pushinteger(L, t->getCount());
+	return 2;
+}
+
+int w_ImageDecodeBatch_isComplete(lua_State *L)
+{
+	ImageDecodeBatch *t = luax_checkimagedecodebatch(L, 1);
+	luax_pushboolean(L, t->isComplete());
+	return 1;
+}
+
+int w_ImageDecodeBatch_wait(lua_State *L)
+{
+	ImageDecodeBatch *t = luax_checkimagedecodebatch(L, 1);
+	t->wait();
+	return 0;
+}
+
+int w_ImageDecodeBatch_getImageData(lua_State *L)
+{
+	ImageDecodeBatch *t = luax_checkimagedecodebatch(L, 1);
+	int index = (int) luaL_checkinteger(L, 2) - 1;
+
+	ImageData *imagedata = nullptr;
+	std::string err;
+	luax_catchexcept(L, [&](){ imagedata = t->getImageData(index, err); });
+
+	if (imagedata == nullptr)
+	{
+		lua_pushnil(L);
+		lua_pushstring(L, err.c_str());
+		return 2;
+	}
+
+	luax_pushtype(L, imagedata);
+	return 1;
+}
+
+static const luaL_Reg w_ImageDecodeBatch_functions[] =
+{
+	{ "getCount", w_ImageDecodeBatch_getCount },
+	{ "getProgress", w_ImageDecodeBatch_getProgress },
+	{ "isComplete", w_ImageDecodeBatch_isComplete },
+	{ "wait", w_ImageDecodeBatch_wait },
+	{ "getImageData", w_ImageDecodeBatch_getImageData },
+	{ 0, 0 }
+};
+
+extern "C" int luaopen_imagedecodebatch(lua_State *L)
+{
+	return luax_register_type(L, &ImageDecodeBatch::type, w_ImageDecodeBatch_functions, nullptr);
+}
+
+} // image
+} // love
@@ -0,0 +1,290 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "WorkerPool.h"
+#include "common/Exception.h"
+
+// C++
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace love
+{
+namespace thread
+{
+
+Task::Task()
+	: pool(nullptr)
+	, state(STATE_IDLE)
+	, errored(false)
+{
+}
+
+Task::~Task()
+{
+}
+
+void Task::execute()
+{
+	try
+	{
+		run();
+	}
+	catch (std::exception &e)
+	{
+		errored = true;
+		error = e.what();
+	}
+}
+
+bool Task::isFinished() const
+{
+	if (pool == nullptr)
+		return state == STATE_FINISHED;
+
+	Lock lock(pool->mutex);
+	return state == STATE_FINISHED;
+}
+
+void Task::wait()
+{
+	if (pool == nullptr)
+	{
+		if (state == STATE_IDLE)
+		{
+			state = STATE_RUNNING;
+			execute();
+			state = STATE_FINISHED;
+		}
+		return;
+	}
+
+	bool runhere = false;
+
+	{
+		Lock lock(pool->mutex);
+
+		if (state == STATE_QUEUED)
+		{
+			auto it = std::find(pool->tasks.begin(), pool->tasks.end(), this);
+			if (it != pool->tasks.end())
+				pool->tasks.erase(it);
+
+			state = STATE_RUNNING;
+			runhere = true;
+		}
+		else
+		{
+			while (state != STATE_FINISHED)
+				pool->finishCond->wait(pool->mutex);
+		}
+	}
+
+	if (runhere)
+	{
+		execute();
+		pool->finish(this);
+	}
+}
+
+WorkerPool::Worker::Worker(WorkerPool *pool)
+	: pool(pool)
+{
+	threadName = "WorkerPool";
+}
+
+void WorkerPool::Worker::threadFunction()
+{
+	pool->runWorker();
+}
+
+WorkerPool::WorkerPool(int workercount)
+	: stopping(false)
+{
+	for (int i = 0; i < std::max(workercount, 1); i++)
+	{
+		Worker *worker = new Worker(this);
+
+		if (!worker->start())
+		{
+			worker->release();
+			break;
+		}
+
+		workers.push_back(worker);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		Lock lock(mutex);
+		stopping = true;
+		taskCond->broadcast();
+	}
+
+	for (Worker *worker : workers)
+	{
+		worker->wait();
+		worker->release();
+	}
+
+	for (Task *task : tasks)
+		task->release();
+}
+
+WorkerPool &WorkerPool::getInstance()
+{
+	// Leave a core free for the main thread.
+	static WorkerPool instance((int) std::thread::hardware_concurrency() - 1);
+	return instance;
+}
+
+void WorkerPool::submit(Task *task)
+{
+	if (task->pool != nullptr || task->state != Task::STATE_IDLE)
+		throw love::Exception("Task has already been started.");
+
+	// Nothing can run it in the background, so just do it now.
+	if (workers.empty())
+	{
+		task->wait();
+		return;
+	}
+
+	task->retain();
+
+	Lock lock(mutex);
+
+	task->pool = this;
+	task->state = Task::STATE_QUEUED;
+	tasks.push_back(task);
+
+	taskCond->signal();
+}
+
+class RangeTask : public Task
+{
+public:
+
+	RangeTask(const std::function<void(int, int)> &func, int start, int end)
+		: func(func)
+		, start(start)
+		, end(end)
+	{}
+
+	void run() override
+	{
+		func(start, end);
+	}
+
+private:
+
+	const std::function<void(int, int)> &func;
+	int start;
+	int end;
+
+}; // RangeTask
+
+void WorkerPool::parallelFor(int count, int grainsize, const std::function<void(int, int)> &func)
+{
+	if (count <= 0)
+		return;
+
+	grainsize = std::max(grainsize, 1);
+
+	// A few ranges per thread, so uneven ranges still balance out.
+	int maxranges = ((int) workers.size() + 1) * 4;
+	int ranges = std::min((count + grainsize - 1) / grainsize, maxranges);
+
+	if (ranges <= 1 || workers.empty())
+	{
+		func(0, count);
+		return;
+	}
+
+	std::vector<StrongRef<Task>> tasks;
+	tasks.reserve(ranges);
+
+	for (int i = 0; i < ranges; i++)
+	{
+		int start = (int) ((int64) count * i / ranges);
+		int end = (int) ((int64) count * (i + 1) / ranges);
+
+		Task *task = new RangeTask(func, start, end);
+		tasks.emplace_back(task, Acquire::NORETAIN);
+		submit(task);
+	}
+
+	std::string error;
+
+	// Waiting on a task which hasn't started yet runs it on this thread.
+	for (const StrongRef<Task> &task : tasks)
+	{
+		task->wait();
+		if (task->hasError() && error.empty())
+			error = task->getError();
+	}
+
+	if (!error.empty())
+		throw love::Exception("%s", error.c_str());
+}
+
+void WorkerPool::runWorker()
+{
+	while (true)
+	{
+		Task *task = nullptr;
+
+		{
+			Lock lock(mutex);
+
+			while (!stopping && tasks.empty())
+				taskCond->wait(mutex);
+
+			if (stopping)
+				return;
+
+			task = tasks.front();
+			tasks.pop_front();
+
+			task->state = Task::STATE_RUNNING;
+		}
+
+		task->execute();
+		finish(task);
+	}
+}
+
+void WorkerPool::finish(Task *task)
+{
+	{
+		Lock lock(mutex);
+		task->state = Task::STATE_FINISHED;
+		finishCond->broadcast();
+	}
+
+	// Retained in submit().
+	task->release();
+}
+
+} // thread
+} // love
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2006-2023 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_THREAD_WORKER_POOL_H
+#define LOVE_THREAD_WORKER_POOL_H
+
+// LOVE
+#include "common/Object.h"
+#include "threads.h"
+
+// C++
+#include <string>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace love
+{
+namespace thread
+{
+
+class WorkerPool;
+
+/**
+ * A unit of work which can be handed to a WorkerPool. Exceptions thrown by
+ * run() are caught and can be queried with getError() once it has finished.
+ **/
+class Task : public love::Object
+{
+public:
+
+	Task();
+	virtual ~Task();
+
+	virtual void run() = 0;
+
+	bool isFinished() const;
+
+	/**
+	 * Blocks until the task has finished. If no worker has started it yet, it
+	 * is run on the calling thread instead of waiting for one to free up.
+	 **/
+	void wait();
+
+	bool hasError() const { return errored; }
+	const std::string &getError() const { return error; }
+
+private:
+
+	friend class WorkerPool;
+
+	enum State
+	{
+		STATE_IDLE,
+		STATE_QUEUED,
+		STATE_RUNNING,
+		STATE_FINISHED,
+	};
+
+	void execute();
+
+	WorkerPool *pool;
+
+	// Guarded by the pool's mutex once the task has been submitted.
+	State state;
+
+	bool errored;
+	std::string error;
+
+}; // Task
+
+/**
+ * A fixed set of background threads which run Tasks in submission order.
+ * Internal engine code should use the shared instance rather than spawning
+ * its own threads for short-lived work.
+ **/
+class WorkerPool
+{
+public:
+
+	WorkerPool(int workercount);
+	~WorkerPool();
+
+	static WorkerPool &getInstance();
+
+	void submit(Task *task);
+
+	/**
+	 * Splits [0, count) into ranges of at least grainsize items and calls
+	 * func(start, end) for each of them, spread across the workers and the
+	 * calling thread. Blocks until all ranges are done. An exception thrown
+	 * by func is rethrown (as a love::Exception) once they have finished.
+	 **/
+	void parallelFor(int count, int grainsize, const std::function<void(int, int)> &func);
+
+	int getWorkerCount() const { return (int) workers.size(); }
+
+private:
+
+	friend class Task;
+
+	class Worker : public Threadable
+	{
+	public:
+
+		Worker(WorkerPool *pool);
+		virtual ~Worker() {}
+
+		// Implements Threadable.
+		void threadFunction() override;
+
+	private:
+
+		WorkerPool *pool;
+
+	}; // Worker
+
+	void runWorker();
+	void finish(Task *task);
+
+	std::vector<Worker *> workers;
+	std::deque<Task *> tasks;
+
+	MutexRef mutex;
+	ConditionalRef taskCond;
+	ConditionalRef finishCond;
+
+	bool stopping;
+
+}; // WorkerPool
+
+} // thread
+} // love
+
+#endif // LOVE_THREAD_WORKER_POOL_H
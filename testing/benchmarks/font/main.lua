@@ -0,0 +1,121 @@
+--[[
+Micro-benchmark for Font text measurement and printing on long strings.
+
+Run with: love testing/benchmarks/font [iterations]
+
+Times Font:getWidth, Font:getWrap and love.graphics.print for ASCII text,
+Latin-1 text (the directly indexed glyph and kerning range) and text with
+codepoints outside it, using the default font (Vera, which has kerning) at
+two sizes. Results are printed as milliseconds per call.
+
+print gets a different string on every call: Font caches print layouts, so
+repeating one string would only time the cache lookup, not the glyph and
+kerning lookups.
+]]
+
+local utf8 = require("utf8")
+
+local function makeText(chars, length, start)
+	local parts = {}
+	local n = start or 0
+	local count = 0
+	while count < length do
+		n = n % #chars + 1
+		parts[#parts + 1] = chars[n]
+		count = count + 1
+		if count % 9 == 0 then
+			parts[#parts + 1] = " "
+			count = count + 1
+		end
+	end
+	return table.concat(parts)
+end
+
+local function split(str)
+	local chars = {}
+	for _, c in utf8.codes(str) do
+		chars[#chars + 1] = utf8.char(c)
+	end
+	return chars
+end
+
+local charsets = {
+	ascii = split("The quick brown fox jumps over the lazy dog AVAWToTaYo"),
+	latin1 = split("Déjà vu, señor! Über façade. ÀÉÎÕÜ àéîõü ßÿ"),
+	mixed = split("Ελληνικά кириллица ĀāĒē ŁłŃń ▲►▼◄"),
+}
+
+local texts = {}
+for name, chars in pairs(charsets) do
+	texts[name] = makeText(chars, 20000)
+end
+
+-- Strings with the same characters starting at different offsets, so no two
+-- of them are equal.
+local function makeVariants(chars, count)
+	local variants = {}
+	for i = 1, count do
+		variants[i] = makeText(chars, 20000, i)
+	end
+	return variants
+end
+
+local textnames = {"ascii", "latin1", "mixed"}
+
+local function bench(name, iterations, func)
+	-- Warm up glyph caches and JIT traces first.
+	func()
+
+	local start = love.timer.getTime()
+	for i = 1, iterations do
+		func()
+	end
+	local elapsed = love.timer.getTime() - start
+
+	print(string.format("  %-24s %9.3f ms", name, elapsed * 1000 / iterations))
+end
+
+local function run(fontname, font, iterations)
+	print(fontname)
+
+	for _, textname in ipairs(textnames) do
+		local text = texts[textname]
+
+		-- One extra for the warm-up call.
+		local variants = makeVariants(charsets[textname], iterations + 1)
+		local variant = 0
+
+		bench(textname .. " getWidth", iterations, function()
+			font:getWidth(text)
+		end)
+
+		bench(textname .. " getWrap", iterations, function()
+			font:getWrap(text, 400)
+		end)
+
+		bench(textname .. " print", iterations, function()
+			variant = variant + 1
+			love.graphics.print(variants[variant], 0, 0)
+			love.graphics.flushBatch()
+		end)
+	end
+end
+
+function love.load(args)
+	local iterations = tonumber(args[1]) or 50
+
+	local fonts = {
+		{"default (Vera 12)", love.graphics.newFont(12)},
+		{"default (Vera 32)", love.graphics.newFont(32)},
+	}
+
+	love.graphics.setCanvas(love.graphics.newCanvas(256, 256))
+
+	for _, f in ipairs(fonts) do
+		love.graphics.setFont(f[2])
+		run(f[1], f[2], iterations)
+	end
+
+	love.graphics.setCanvas()
+	love.event.quit()
+end
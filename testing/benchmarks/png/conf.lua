@@ -0,0 +1,6 @@
+function love.conf(t)
+	t.window = false
+	t.modules.graphics = false
+	t.modules.audio = false
+	t.modules.sound = false
+end